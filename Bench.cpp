@@ -0,0 +1,1165 @@
+// Headless microbenchmarks for the CPU-side water and gameplay kernels.
+// Build with `make bench`; run `./cs1750_bench [section ...]` (default: all).
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Boat.hpp"
+#include "Events.hpp"
+#include "Fish.hpp"
+#include "Fleet.hpp"
+#include "MeshCache.hpp"
+#include "MeshOptimize.hpp"
+#include "MeshSimplify.hpp"
+#include "ObjLoader.hpp"
+#include "Ocean.hpp"
+#include "Parallel.hpp"
+#include "ShallowWater.hpp"
+#include "Simd.hpp"
+#include "Stone.hpp"
+#include "WaterField.hpp"
+#include "Waves.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Runs fn repeatedly for at least minSeconds; returns seconds per call.
+double timeIt(const std::function<void()> &fn, double minSeconds = 0.25) {
+    fn(); // warm-up
+    int iters = 0;
+    const auto start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        fn();
+        ++iters;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return elapsed / iters;
+}
+
+void benchWavesOnce(const std::vector<float> &x, const std::vector<float> &z, float t) {
+    const int n = static_cast<int>(x.size());
+    std::vector<float> refX(n), refY(n), refZ(n);
+    evalGerstnerBatchPath(SimdPath::Scalar, x.data(), z.data(), n, t, refX.data(), refY.data(), refZ.data());
+
+    std::printf("[waves] evalGerstnerBatch, %d points, %d waves\n", n, g_waveSpectrum.count);
+    for (int p = 0; p < kNumSimdPaths; ++p) {
+        const SimdPath path = static_cast<SimdPath>(p);
+        if (!simdPathAvailable(path)) continue;
+        std::vector<float> ox(n), oy(n), oz(n);
+        const double sec = timeIt([&] {
+            evalGerstnerBatchPath(path, x.data(), z.data(), n, t, ox.data(), oy.data(), oz.data());
+        });
+        float maxErr = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            maxErr = std::fmax(maxErr, std::fabs(ox[i] - refX[i]));
+            maxErr = std::fmax(maxErr, std::fabs(oy[i] - refY[i]));
+            maxErr = std::fmax(maxErr, std::fabs(oz[i] - refZ[i]));
+        }
+        std::printf("  %-7s %9.2f Mpts/s   max|err| vs scalar %.2e\n",
+                    simdPathName(path), n / sec * 1e-6, maxErr);
+    }
+}
+
+void benchWaves() {
+    const int n = 4096;
+    std::vector<float> x(n), z(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = -50.0f + 100.0f * static_cast<float>(i % 64) / 64.0f;
+        z[i] = -50.0f + 100.0f * static_cast<float>(i / 64) / 64.0f;
+    }
+    for (int waves : {kNumWaves, 16, kMaxWaves}) {
+        buildWaveSpectrum(waves);
+        benchWavesOnce(x, z, 123.4f);
+    }
+    buildWaveSpectrum(kNumWaves);
+}
+
+// Round trip: displace rest points forward, then ask for the height above the
+// displaced XZ. The exact query should return the forward Y; the naive
+// undisplaced lookup shows how far off the old behaviour was.
+void benchWaveHeightOnce(const std::vector<float> &x, const std::vector<float> &z, float t) {
+    const int n = static_cast<int>(x.size());
+    std::vector<float> px(n), py(n), pz(n), naive(n);
+    evalGerstnerBatchPath(SimdPath::Scalar, x.data(), z.data(), n, t, px.data(), py.data(), pz.data());
+    evalGerstnerBatch(px.data(), pz.data(), n, t, nullptr, naive.data(), nullptr);
+    float naiveErr = 0.0f;
+    for (int i = 0; i < n; ++i) naiveErr = std::fmax(naiveErr, std::fabs(naive[i] - py[i]));
+
+    std::printf("[height] evalGerstnerHeight, %d points, %d waves (naive max|err| %.2e)\n",
+                n, g_waveSpectrum.count, naiveErr);
+    for (int p = 0; p < kNumSimdPaths; ++p) {
+        const SimdPath path = static_cast<SimdPath>(p);
+        if (!simdPathAvailable(path)) continue;
+        std::vector<float> oy(n);
+        int iters = 0;
+        const double sec = timeIt([&] {
+            iters = evalGerstnerHeightPath(path, px.data(), pz.data(), n, t, oy.data());
+        });
+        float maxErr = 0.0f;
+        for (int i = 0; i < n; ++i) maxErr = std::fmax(maxErr, std::fabs(oy[i] - py[i]));
+        std::printf("  %-7s %9.2f Mpts/s   %d iters   max|err| %.2e\n",
+                    simdPathName(path), n / sec * 1e-6, iters, maxErr);
+    }
+}
+
+void benchWaveHeight() {
+    const int n = 4096;
+    std::vector<float> x(n), z(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = -50.0f + 100.0f * static_cast<float>(i % 64) / 64.0f;
+        z[i] = -50.0f + 100.0f * static_cast<float>(i / 64) / 64.0f;
+    }
+    for (int waves : {kNumWaves, 16, kMaxWaves}) {
+        buildWaveSpectrum(waves);
+        benchWaveHeightOnce(x, z, 123.4f);
+    }
+    buildWaveSpectrum(kNumWaves);
+}
+
+// Angle between the normals (-sx, 1, -sz) of two slope pairs, in degrees.
+float normalAngleDeg(float sx0, float sz0, float sx1, float sz1) {
+    const float d = sx0 * sx1 + 1.0f + sz0 * sz1;
+    const float l0 = std::sqrt(sx0 * sx0 + 1.0f + sz0 * sz0);
+    const float l1 = std::sqrt(sx1 * sx1 + 1.0f + sz1 * sz1);
+    return std::acos(std::fmin(1.0f, d / (l0 * l1))) * 57.2957795f;
+}
+
+// Analytic slopes against central differences of the same height function
+// (tight solver tolerance so the differences aren't solver noise), plus the
+// cost of getting slopes in the height pass versus three extra height solves.
+void benchDerivs() {
+    const int n = 4096;
+    const float t = 123.4f;
+    const float eps = 1e-2f;
+    std::vector<float> x(n), z(n), xm(n), xp(n), zm(n), zp(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = -50.0f + 100.0f * static_cast<float>(i % 64) / 64.0f;
+        z[i] = -50.0f + 100.0f * static_cast<float>(i / 64) / 64.0f;
+        xm[i] = x[i] - eps;
+        xp[i] = x[i] + eps;
+        zm[i] = z[i] - eps;
+        zp[i] = z[i] + eps;
+    }
+    const SimdPath path = bestSimdPath();
+    for (int waves : {kNumWaves, kMaxWaves}) {
+        buildWaveSpectrum(waves);
+        std::vector<float> y(n), sx(n), sz(n), hxm(n), hxp(n), hzm(n), hzp(n);
+        const int iters = 32;
+        const float tol = 1e-6f;
+        evalGerstnerHeightPath(path, x.data(), z.data(), n, t, y.data(), sx.data(), sz.data(), iters, tol);
+        evalGerstnerHeightPath(path, xm.data(), z.data(), n, t, hxm.data(), nullptr, nullptr, iters, tol);
+        evalGerstnerHeightPath(path, xp.data(), z.data(), n, t, hxp.data(), nullptr, nullptr, iters, tol);
+        evalGerstnerHeightPath(path, x.data(), zm.data(), n, t, hzm.data(), nullptr, nullptr, iters, tol);
+        evalGerstnerHeightPath(path, x.data(), zp.data(), n, t, hzp.data(), nullptr, nullptr, iters, tol);
+        float maxDeg = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            const float fx = (hxp[i] - hxm[i]) / (2.0f * eps);
+            const float fz = (hzp[i] - hzm[i]) / (2.0f * eps);
+            maxDeg = std::fmax(maxDeg, normalAngleDeg(sx[i], sz[i], fx, fz));
+        }
+        const double heightOnly = timeIt([&] {
+            evalGerstnerHeightPath(path, x.data(), z.data(), n, t, y.data());
+        });
+        const double analytic = timeIt([&] {
+            evalGerstnerHeightPath(path, x.data(), z.data(), n, t, y.data(), sx.data(), sz.data());
+        });
+        const double finiteDiff = timeIt([&] {
+            evalGerstnerHeightPath(path, x.data(), z.data(), n, t, y.data());
+            evalGerstnerHeightPath(path, xp.data(), z.data(), n, t, hxp.data());
+            evalGerstnerHeightPath(path, x.data(), zp.data(), n, t, hzp.data());
+        });
+        std::printf("[derivs] gerstner %2d waves (%s): max normal err vs central diff %.3f deg; "
+                    "height %.1f, +analytic %.1f, forward diff %.1f Mpts/s\n",
+                    waves, simdPathName(path), maxDeg, n / heightOnly * 1e-6,
+                    n / analytic * 1e-6, n / finiteDiff * 1e-6);
+    }
+    buildWaveSpectrum(kNumWaves);
+
+    const int rippleCount = 32;
+    clearRipples();
+    for (int i = 0; i < rippleCount; ++i) {
+        addRipple(Vec3(static_cast<float>(i % 8) - 4.0f, 0.0f, static_cast<float>(i / 8) - 2.0f),
+                  t - 0.07f * i);
+    }
+    float maxDeg = 0.0f;
+    const int rn = 64 * 64;
+    for (int i = 0; i < rn; ++i) {
+        const Vec3 p(-8.0f + 16.0f * (i % 64) / 64.0f + 0.013f, 0.0f, -8.0f + 16.0f * (i / 64) / 64.0f);
+        const Vec3 g = rippleFieldGrad(p, t);
+        const float fx = (rippleFieldHeight(Vec3(p.x + eps, 0.0f, p.z), t) -
+                          rippleFieldHeight(Vec3(p.x - eps, 0.0f, p.z), t)) / (2.0f * eps);
+        const float fz = (rippleFieldHeight(Vec3(p.x, 0.0f, p.z + eps), t) -
+                          rippleFieldHeight(Vec3(p.x, 0.0f, p.z - eps), t)) / (2.0f * eps);
+        maxDeg = std::fmax(maxDeg, normalAngleDeg(g.x, g.z, fx, fz));
+    }
+    Vec3 sink;
+    const double analytic = timeIt([&] {
+        for (int i = 0; i < 256; ++i) sink = sink + rippleFieldGrad(Vec3(0.01f * i, 0.0f, 0.5f), t);
+    });
+    const double finiteDiff = timeIt([&] {
+        const float e = 0.1f;
+        for (int i = 0; i < 256; ++i) {
+            const Vec3 p(0.01f * i, 0.0f, 0.5f);
+            const float h0 = rippleFieldHeight(p, t);
+            sink.x += (rippleFieldHeight(Vec3(p.x + e, 0.0f, p.z), t) - h0) / e;
+            sink.z += (rippleFieldHeight(Vec3(p.x, 0.0f, p.z + e), t) - h0) / e;
+        }
+    });
+    std::printf("[derivs] ripples %d: max normal err vs central diff %.3f deg; "
+                "analytic %.0f ns, forward diff %.0f ns per gradient (%g)\n",
+                rippleCount, maxDeg, analytic / 256 * 1e9, finiteDiff / 256 * 1e9, sink.x);
+    clearRipples();
+}
+
+void benchWaterField() {
+    const Vec3 center(3.0f, 0.0f, -2.0f);
+    const float t = 42.0f;
+    const int queries = 100000;
+    std::vector<float> qx(queries), qz(queries), qy(queries);
+    for (int i = 0; i < queries; ++i) {
+        qx[i] = center.x - 15.0f + 30.0f * static_cast<float>((i * 7919LL) % queries) / queries;
+        qz[i] = center.z - 15.0f + 30.0f * static_cast<float>((i * 104729LL) % queries) / queries;
+    }
+
+    std::printf("[waterfield] %dx%d grid, %d worker threads\n",
+                kWaterFieldRes, kWaterFieldRes, workerThreadCount());
+    // 32 stone-sized ripples, then a rain shower of small ones
+    struct Case { int count; float radius; };
+    for (const Case &c : {Case{0, kRippleRadius}, Case{32, kRippleRadius}, Case{1024, 1.5f}}) {
+        clearRipples();
+        for (int i = 0; i < c.count; ++i) {
+            const float u = static_cast<float>((i * 7919) % 1024) / 1024.0f;
+            const float v = static_cast<float>((i * 104729) % 1021) / 1021.0f;
+            addRipple(Vec3(center.x - 15.0f + 30.0f * u, 0.0f, center.z - 15.0f + 30.0f * v),
+                      t - kRippleLife * static_cast<float>(i) / std::max(c.count, 1), c.radius);
+        }
+        const double serial = timeIt([&] { buildWaterField(center, t, false); });
+        const double par = timeIt([&] { buildWaterField(center, t, true); });
+        const double query = timeIt([&] { surfaceHeightBatch(qx.data(), qz.data(), queries, qy.data()); });
+        std::printf("  %4d ripples (r %.1f m): build %.3f ms serial, %.3f ms parallel (%d solver iters); %.1f ns/query\n",
+                    c.count, c.radius, serial * 1e3, par * 1e3, waterFieldStats().solverIters,
+                    query / queries * 1e9);
+    }
+    clearRipples();
+}
+
+// Direct ripple queries through the spatial grid against a scan of every
+// live ripple (the old store), at growing ripple counts over a 60 m pond.
+void benchRipples() {
+    const float t = 20.0f;
+    const int queries = 4096;
+    std::vector<Vec3> pts(queries);
+    for (int i = 0; i < queries; ++i) {
+        pts[i] = Vec3(-30.0f + 60.0f * static_cast<float>((i * 7919) % queries) / queries, 0.0f,
+                      -30.0f + 60.0f * static_cast<float>((i * 104729) % queries) / queries);
+    }
+    auto scanHeight = [t](const Vec3 &p) {
+        float h = 0.0f;
+        for (int i = 0; i < kMaxRipples; ++i) {
+            const RippleEvent &r = g_ripples[i];
+            if (!r.active) continue;
+            const float dx = p.x - r.pos.x;
+            const float dz = p.z - r.pos.z;
+            const float d2 = dx * dx + dz * dz;
+            if (d2 <= r.radius * r.radius) h += singleRippleHeight(std::sqrt(d2), t - r.startTime, r.radius);
+        }
+        return h;
+    };
+
+    std::printf("[ripples] rippleFieldHeight, %d queries, %.0f m grid cells\n", queries, kRippleCellSize);
+    for (int count : {32, 256, 1024, kMaxRipples}) {
+        clearRipples();
+        for (int i = 0; i < count; ++i) {
+            const float u = static_cast<float>((i * 7919) % 4093) / 4093.0f;
+            const float v = static_cast<float>((i * 104729) % 4091) / 4091.0f;
+            addRipple(Vec3(-30.0f + 60.0f * u, 0.0f, -30.0f + 60.0f * v),
+                      t - kRippleLife * static_cast<float>(i) / count, i % 16 == 0 ? kRippleRadius : 1.5f);
+        }
+        float maxErr = 0.0f;
+        for (const Vec3 &p : pts) maxErr = std::fmax(maxErr, std::fabs(rippleFieldHeight(p, t) - scanHeight(p)));
+        // Ripples whose disk covers each query: what a query has to sum at minimum
+        double reached = 0.0;
+        for (int i = 0; i < count; ++i) {
+            const RippleEvent &r = g_ripples[i];
+            reached += 3.14159265 * r.radius * r.radius / (60.0 * 60.0);
+        }
+        float sink = 0.0f;
+        const double grid = timeIt([&] { for (const Vec3 &p : pts) sink += rippleFieldHeight(p, t); });
+        const double scan = timeIt([&] { for (const Vec3 &p : pts) sink += scanHeight(p); });
+        std::printf("  %4d ripples (~%4.1f reach a point): grid %7.1f ns/query, full scan %8.1f ns/query"
+                    "   max|diff| %.1e (%g)\n",
+                    count, reached, grid / queries * 1e9, scan / queries * 1e9, maxErr, sink);
+    }
+    clearRipples();
+}
+
+void benchOcean() {
+    std::printf("[ocean] FFT ocean update, %d worker threads\n", workerThreadCount());
+    for (int res = kOceanMinRes; res <= kOceanMaxRes; res *= 2) {
+        OceanParams params;
+        params.resolution = res;
+        initOcean(params);
+        float t = 10.0f;
+        float fftSerial = 0.0f, fftParallel = 0.0f;
+        const double serial = timeIt([&] {
+            updateOcean(t += 0.016f, false);
+            fftSerial = oceanStats().fftMs;
+        });
+        const double par = timeIt([&] {
+            updateOcean(t += 0.016f, true);
+            fftParallel = oceanStats().fftMs;
+        });
+        std::printf("  %3d^2: update %7.3f ms serial (FFT %7.3f), %7.3f ms parallel (FFT %7.3f)\n",
+                    res, serial * 1e3, fftSerial, par * 1e3, fftParallel);
+    }
+    initOcean(OceanParams());
+}
+
+// Fixed-step shallow-water grid: per-step cost serial vs pool, with a moving
+// boat-sized obstacle and a stone impact every few steps. Also checks the
+// scheme stays bounded over a few simulated seconds.
+void benchShallowWater() {
+    std::printf("[swe] shallow-water step, %d worker threads\n", workerThreadCount());
+    for (int res : {256, 512}) {
+        ShallowWaterParams params;
+        params.resolution = res;
+        for (int parallel = 0; parallel < 2; ++parallel) {
+            initShallowWater(params);
+            const float stepDt = 1.0f / shallowWaterParams().stepHz;
+            const Vec3 center(0.0f, 0.0f, 0.0f);
+            int frame = 0;
+            float stepMs = 0.0f;
+            int steps = 0;
+            const double sec = timeIt([&] {
+                const float t = frame * stepDt;
+                SweBody boat;
+                boat.pos = Vec3(3.0f * std::cos(0.3f * t), 0.0f, 3.0f * std::sin(0.3f * t));
+                boat.vel = Vec3(-0.9f * std::sin(0.3f * t), 0.0f, 0.9f * std::cos(0.3f * t));
+                boat.radius = 0.7f;
+                if (frame % 30 == 0) shallowWaterImpulse(std::fmod(0.37f * frame, 6.0f) - 3.0f, 1.0f, 0.3f, -0.05f);
+                updateShallowWater(center, stepDt, &boat, 1, parallel != 0);
+                stepMs += shallowWaterStats().stepMs;
+                steps += shallowWaterStats().steps;
+                ++frame;
+            });
+            float maxH = 0.0f;
+            const float *map = shallowWaterMap();
+            for (int i = 0; i < res * res; ++i) maxH = std::fmax(maxH, std::fabs(map[i * 4]));
+            std::printf("  %3d^2 %-8s: %7.3f ms/step, %7.3f ms/update (%d steps simulated, max|h| %.3f m)\n",
+                        res, parallel ? "parallel" : "serial", steps ? stepMs / frame : 0.0f,
+                        sec * 1e3, steps, maxH);
+        }
+    }
+    initShallowWater(ShallowWaterParams());
+}
+
+// Stone pool at stress-test sizes: skipping stones over the cached water
+// field with two cubes and a boat to hit, refilled between frames. Then the
+// swept tests: stones fast enough to cross a cube or the water in one step.
+void benchStones() {
+    const float t = 30.0f;
+    const float dt = 1.0f / 60.0f;
+    const float waterY = -0.5f;
+    buildWaterField(Vec3(), t);
+    StoneCollider targets[3];
+    targets[0].pos = Vec3(2.0f, waterY + 0.3f, 0.0f);
+    targets[0].radius = 0.6f;
+    targets[0].box = true;
+    targets[1] = targets[0];
+    targets[1].pos = Vec3(-4.0f, waterY + 0.3f, 3.0f);
+    targets[2].pos = Vec3(0.0f, waterY, -5.0f);
+    targets[2].radius = 1.5f;
+    targets[2].hitEvent = GameEventType::BoatHit;
+
+    unsigned seed = 12345;
+    auto rnd = [&seed] {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    auto refill = [&](int target) {
+        while (g_stones.count < target) {
+            const float a = 6.2831853f * rnd();
+            const float speed = 5.0f + 3.0f * rnd(); // stays inside the cached field
+            spawnStoneAt(Vec3(-10.0f + 20.0f * rnd(), waterY + 0.5f + 2.0f * rnd(), -10.0f + 20.0f * rnd()),
+                         Vec3(speed * std::cos(a), -1.0f - 2.0f * rnd(), speed * std::sin(a)));
+        }
+    };
+
+    std::printf("[stones] SoA stone pool, %d worker threads\n", workerThreadCount());
+    for (int count : {8, 1024, 10000, kMaxStones}) {
+        for (int parallel = 0; parallel < 2; ++parallel) {
+            clearStones();
+            clearRipples();
+            double ms = 0.0;
+            int impacts = 0;
+            const int frames = 120;
+            for (int f = 0; f < frames; ++f) {
+                refill(count);
+                updateStones(dt, t + f * dt, waterY, targets, 3, parallel != 0);
+                drainGameEvents([](const GameEvent &) {});
+                ms += stoneStats().updateMs;
+                impacts += stoneStats().impacts;
+            }
+            std::printf("  %5d stones %-8s: %7.3f ms/update, %8.0f stones/ms, %4.1f contacts/frame\n",
+                        count, parallel ? "parallel" : "serial", ms / frames, count * frames / ms,
+                        static_cast<double>(impacts) / frames);
+        }
+    }
+
+    // One 300 m/s stone per case, 5 m per step: the cube (1.2 m) and the
+    // water must still register.
+    clearStones();
+    spawnStoneAt(Vec3(targets[0].pos.x - 3.0f, targets[0].pos.y, 0.0f), Vec3(300.0f, 0.0f, 0.0f));
+    updateStones(dt, t, waterY, targets, 3, false);
+    const int cubeHits = targets[0].hits;
+    clearStones();
+    spawnStoneAt(Vec3(6.0f, waterY + 2.0f, 6.0f), Vec3(0.0f, -300.0f, 0.0f));
+    updateStones(dt, t, waterY, targets, 3, false);
+    const int sank = g_stones.count == 0 ? 1 : 0;
+    int sinks = 0;
+    drainGameEvents([&](const GameEvent &e) { sinks += e.type == GameEventType::TinySplash; });
+    std::printf("  tunnelling at 300 m/s: cube hits %d/1, water contacts %d/1 (%d sink event)\n",
+                cubeHits, sank, sinks);
+    clearStones();
+    clearRipples();
+}
+
+// Smallest gap between the listed fish and any other swimming fish, found
+// through a grid of cells `reach` wide (gaps beyond it are not reported).
+float closestFishGap(const FishSchool &fish, const std::vector<int> &which, float reach) {
+    std::unordered_map<long long, std::vector<int>> cells;
+    auto key = [reach](float x, float z) {
+        return (static_cast<long long>(std::floor(x / reach)) << 32) ^
+               static_cast<long long>(static_cast<uint32_t>(std::floor(z / reach)));
+    };
+    for (int j = 0; j < fish.count; ++j) {
+        if (fish.state[j] == FishState::Swimming) cells[key(fish.posX[j], fish.posZ[j])].push_back(j);
+    }
+    float best = reach;
+    for (int i : which) {
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                auto it = cells.find(key(fish.posX[i] + dx * reach, fish.posZ[i] + dz * reach));
+                if (it == cells.end()) continue;
+                for (int j : it->second) {
+                    if (j == i) continue;
+                    best = std::min(best, std::hypot(fish.posX[j] - fish.posX[i], fish.posZ[j] - fish.posZ[i]));
+                }
+            }
+        }
+    }
+    return best;
+}
+
+// Fish school at growing sizes, bounds scaled to keep ~0.5 fish/m^2 (the
+// in-game pond holds 20 in 28 m), all steering every frame. First checks the
+// grid finds every neighbour a brute-force O(n^2) scan does; last compares
+// the AI LOD tiers at several budgets. Spawning is timed up to 100k fish and
+// its spacing checked, for respawns too.
+void benchFish() {
+    const float waterY = -0.5f;
+    const float dt = 1.0f / 60.0f;
+    Rod rod;
+    int caught = 0;
+    const FishObstacle obstacles[3] = {{Vec3(0.0f, 0.0f, 0.0f), 2.0f}, {Vec3(4.0f, 0.0f, 4.0f), 1.2f},
+                                       {Vec3(-4.0f, 0.0f, 2.0f), 1.2f}};
+
+    FishSchool fish;
+    FishParams check;
+    check.bounds = 20.0f;
+    check.maxNeighbours = 1 << 20;
+    check.lod = false;
+    initFish(fish, 2000, waterY, check);
+    long long pairs = 0;
+    const float r2 = check.neighbourRadius * check.neighbourRadius;
+    for (int i = 0; i < fish.count; ++i) {
+        for (int j = 0; j < fish.count; ++j) {
+            const float dx = fish.posX[j] - fish.posX[i];
+            const float dz = fish.posZ[j] - fish.posZ[i];
+            pairs += (i != j && dx * dx + dz * dz <= r2);
+        }
+    }
+    updateFish(fish, dt, 0.0f, waterY, Vec3(), obstacles, 3, rod, caught);
+    std::printf("[fish] boids over a uniform grid; 2000 fish: %.3f neighbours/fish via grid, %.3f brute force\n",
+                fishStats().avgNeighbours, static_cast<double>(pairs) / fish.count);
+
+    std::printf("  Poisson-disk spawn (1 m requested):\n");
+    for (int count : {20, 1000, 10000, 100000}) {
+        FishParams params;
+        params.bounds = std::max(14.0f, 0.5f * std::sqrt(count / 0.5f));
+        const auto start = Clock::now();
+        initFish(fish, count, waterY, params);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::vector<int> all(count);
+        for (int i = 0; i < count; ++i) all[i] = i;
+        std::printf("    %6d fish (%3.0f m pond): %8.3f ms, spacing %.3f m, closest pair %.3f m\n", count,
+                    2.0f * params.bounds, ms, fish.spacing, closestFishGap(fish, all, 4.0f));
+    }
+    {
+        // A crowded pond: half the fish respawn at once into the other half
+        FishParams params;
+        params.bounds = 30.0f;
+        initFish(fish, 2000, waterY, params);
+        std::vector<int> respawned;
+        for (int i = 0; i < fish.count; i += 2) {
+            fish.state[i] = FishState::Respawning;
+            fish.timer[i] = 10.0f;
+        }
+        updateFish(fish, dt, 0.0f, waterY, Vec3(), obstacles, 3, rod, caught);
+        for (int i = 0; i < fish.count; ++i) {
+            if (fish.state[i] == FishState::Swimming && fish.timer[i] == 0.0f) respawned.push_back(i);
+        }
+        std::printf("    respawn of 1000 into 1000 swimming: %zu placed this update, closest %.3f m "
+                    "(spacing %.3f m)\n",
+                    respawned.size(), closestFishGap(fish, respawned, 4.0f), fish.spacing);
+    }
+
+    for (int count : {20, 1000, 10000, 50000}) {
+        FishParams params;
+        params.bounds = std::max(14.0f, 0.5f * std::sqrt(count / 0.5f));
+        params.lod = false;
+        initFish(fish, count, waterY, params);
+        float ms = 0.0f, gridMs = 0.0f, neighbours = 0.0f;
+        const int frames = count >= 10000 ? 60 : 240;
+        for (int f = 0; f < frames; ++f) {
+            updateFish(fish, dt, f * dt, waterY, Vec3(), obstacles, 3, rod, caught);
+            ms += fishStats().updateMs;
+            gridMs += fishStats().gridMs;
+            neighbours += fishStats().avgNeighbours;
+        }
+        std::printf("  %5d fish (%3.0f m pond): %8.3f ms/update (grid %6.3f ms), %6.1f ns/fish, %4.1f neighbours\n",
+                    count, 2.0f * params.bounds, ms / frames, gridMs / frames, ms / frames / count * 1e6,
+                    neighbours / frames);
+    }
+
+    // Thread scaling at 50k, with a lure in the pond and the LOD tiers on a
+    // fixed schedule. Every run must end in the same state bit for bit.
+    const int hardware = workerThreadCount();
+    auto fingerprint = [&fish] {
+        uint64_t h = 1469598103934665603ull;
+        auto mix = [&h](const void *data, size_t bytes) {
+            const unsigned char *b = static_cast<const unsigned char *>(data);
+            for (size_t k = 0; k < bytes; ++k) h = (h ^ b[k]) * 1099511628211ull;
+        };
+        for (const std::vector<float> *v : {&fish.posX, &fish.posY, &fish.posZ, &fish.velX, &fish.velZ,
+                                            &fish.yawDeg, &fish.timer}) {
+            mix(v->data(), v->size() * sizeof(float));
+        }
+        mix(fish.state.data(), fish.state.size());
+        mix(fish.id.data(), fish.id.size() * sizeof(uint32_t));
+        return h;
+    };
+    FishParams params;
+    params.bounds = 158.0f;
+    params.lodBudgetUs = 0.0f;
+    double baseMs = 0.0;
+    uint64_t baseHash = 0;
+    // Powers of two up to the pool size, and at least 4 so the determinism
+    // check sees real interleaving even on small machines.
+    std::vector<int> threadCounts;
+    for (int n = 1; n < std::max(hardware, 4); n *= 2) threadCounts.push_back(n);
+    threadCounts.push_back(std::max(hardware, 4));
+    for (int threads : threadCounts) {
+        setWorkerThreadCount(threads);
+        initFish(fish, 50000, waterY, params);
+        rod = Rod();
+        rod.active = true;
+        caught = 0;
+        double ms = 0.0;
+        const int frames = 120;
+        for (int f = 0; f < frames; ++f) {
+            rod.pos = Vec3(40.0f * std::cos(0.05f * f), waterY, 40.0f * std::sin(0.05f * f));
+            updateFish(fish, dt, f * dt, waterY, Vec3(), obstacles, 3, rod, caught);
+            ms += fishStats().updateMs;
+        }
+        const uint64_t hash = fingerprint();
+        if (threads == 1) {
+            baseMs = ms;
+            baseHash = hash;
+        }
+        std::printf("  50000 fish, %2d threads: %8.3f ms/update, speedup %4.2fx, efficiency %3.0f%%, "
+                    "state %016llx (%s, %d caught)\n",
+                    threads, ms / frames, baseMs / ms, 100.0 * baseMs / ms / threads,
+                    static_cast<unsigned long long>(hash), hash == baseHash ? "identical" : "DIFFERS", caught);
+    }
+    setWorkerThreadCount(hardware);
+
+    // AI LOD at 50k with the camera crossing the pond: everything full, the
+    // fixed schedule, then shrinking budgets
+    std::printf("  AI LOD, 50000 fish, camera moving:\n");
+    rod = Rod();
+    for (float budgetUs : {-1.0f, 0.0f, 8000.0f, 4000.0f, 2000.0f}) {
+        params.lod = budgetUs >= 0.0f;
+        params.lodBudgetUs = std::max(budgetUs, 0.0f);
+        initFish(fish, 50000, waterY, params);
+        double ms = 0.0;
+        long long tiers[4] = {};
+        int slice = 0;
+        float scale = 0.0f;
+        const int frames = 120;
+        for (int f = 0; f < frames; ++f) {
+            const Vec3 view(-100.0f + 200.0f * f / frames, 2.0f, 10.0f);
+            updateFish(fish, dt, f * dt, waterY, view, obstacles, 3, rod, caught);
+            const FishStats &s = fishStats();
+            ms += s.updateMs;
+            tiers[0] += s.lodNear;
+            tiers[1] += s.lodMidSteered;
+            tiers[2] += s.lodMid;
+            tiers[3] += s.lodFar;
+            slice = s.lodSlice;
+            scale = s.lodScale;
+        }
+        char label[32];
+        if (budgetUs < 0.0f) std::snprintf(label, sizeof(label), "off");
+        else if (budgetUs == 0.0f) std::snprintf(label, sizeof(label), "no budget");
+        else std::snprintf(label, sizeof(label), "%5.0f us", budgetUs);
+        std::printf("    %-9s: %8.3f ms/update, per update %5lld near, %5lld/%5lld mid, %5lld far "
+                    "(slice %d, radius x%.2f)\n",
+                    label, ms / frames, tiers[0] / frames, tiers[1] / frames, tiers[2] / frames,
+                    tiers[3] / frames, slice, scale);
+    }
+}
+
+// Gameplay event ring: a producer thread pushing while the caller drains,
+// checking every event arrives once and in order, then a burst of a full
+// frame's worth pushed and drained on one thread.
+void benchEvents() {
+    std::printf("[events] SPSC game event queue, capacity %d\n", kGameEventCapacity);
+    const int total = 1 << 20;
+    SpscRing<GameEvent, kGameEventCapacity> ring;
+    const auto start = Clock::now();
+    std::thread producer([&] {
+        GameEvent e;
+        for (int i = 0; i < total; ++i) {
+            e.time = static_cast<float>(i & 0xffff);
+            e.intensity = static_cast<float>(i >> 16);
+            while (!ring.push(e)) std::this_thread::yield();
+        }
+    });
+    int received = 0, outOfOrder = 0;
+    GameEvent e;
+    while (received < total) {
+        if (!ring.pop(e)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const int id = (static_cast<int>(e.intensity) << 16) | static_cast<int>(e.time);
+        if (id != received) ++outOfOrder;
+        ++received;
+    }
+    producer.join();
+    const double sec = std::chrono::duration<double>(Clock::now() - start).count();
+    std::printf("  2 threads: %d events in %.1f ms (%.1f M/s), %d out of order or lost\n",
+                received, sec * 1e3, received / sec * 1e-6, outOfOrder);
+
+    const int burst = kGameEventCapacity;
+    int drained = 0;
+    const double burstSec = timeIt([&] {
+        for (int i = 0; i < burst; ++i) pushGameEvent(GameEventType::WaterSplash, Vec3(), 1.0f, 0.0f);
+        drained = drainGameEvents([](const GameEvent &) {});
+    });
+    std::printf("  1 thread: push+drain %d events in %.1f us (%.1f ns/event, %d drained, %llu dropped)\n",
+                burst, burstSec * 1e6, burstSec / burst * 1e9, drained,
+                static_cast<unsigned long long>(gameEventStats().dropped));
+}
+
+// Boat hull buoyancy: the same 12 s drive (throttle, a turn, then coasting)
+// at several frame rates, rebuilding the water field every frame as the game
+// does. The input edges at 4, 6 and 7 s lie on every rate's frame and step
+// grid, so the fixed steps should make the runs agree. X/Z follow the
+// inputs almost kinematically, so the check is the rendered heave, pitch and
+// roll against the 240 fps run at the same times.
+void benchBoat() {
+    const float waterY = -0.5f;
+    const int refFps = 240;
+    std::printf("[boat] %d hull points, fixed %.0f Hz steps\n", kBoatHullPoints, kBoatStepHz);
+    Boat ref;
+    std::vector<BoatPose> refPoses;
+    for (int fps : {refFps, 144, 60, 30}) {
+        Boat b;
+        b.pos = Vec3(-4.0f, waterY, 1.0f);
+        const float dt = 1.0f / fps;
+        const int frames = 12 * fps;
+        float maxPitch = 0.0f, maxRoll = 0.0f;
+        float devY = 0.0f, devPitch = 0.0f, devRoll = 0.0f;
+        double updateSec = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            const float t = f * dt;
+            buildWaterField(b.pos, t, false);
+            const auto start = Clock::now();
+            // A frame simulates (t - dt, t], so inputs go by that span's end
+            updateBoat(b, dt, f <= 6 * fps, false, f > 4 * fps && f <= 7 * fps, false, waterY, t);
+            updateSec += std::chrono::duration<double>(Clock::now() - start).count();
+            maxPitch = std::max(maxPitch, std::fabs(b.pitch));
+            maxRoll = std::max(maxRoll, std::fabs(b.roll));
+            if (fps == refFps) {
+                refPoses.push_back(b.pose);
+                continue;
+            }
+            // Reference pose at this frame's time, between its two nearest frames
+            const float at = t * refFps;
+            const int i = std::min(static_cast<int>(at), static_cast<int>(refPoses.size()) - 2);
+            const float w = at - static_cast<float>(i);
+            const BoatPose &p0 = refPoses[i], &p1 = refPoses[i + 1];
+            devY = std::max(devY, std::fabs(b.pose.pos.y - (p0.pos.y + (p1.pos.y - p0.pos.y) * w)));
+            devPitch = std::max(devPitch, std::fabs(b.pose.pitch - (p0.pitch + (p1.pitch - p0.pitch) * w)));
+            devRoll = std::max(devRoll, std::fabs(b.pose.roll - (p0.roll + (p1.roll - p0.roll) * w)));
+        }
+        if (fps == refFps) ref = b;
+        std::printf("  %3d fps: %6.2f us/frame, end (%7.3f, %6.3f, %7.3f) yaw %6.1f, max pitch %4.1f deg, "
+                    "max roll %4.1f deg\n",
+                    fps, updateSec / frames * 1e6, b.pos.x, b.pos.y, b.pos.z, b.yawDeg,
+                    maxPitch * 180.0f / kPi, maxRoll * 180.0f / kPi);
+        if (fps != refFps) {
+            std::printf("           off %d fps: end by %.4f m, worst frame heave %.2f cm, pitch %.3f deg, "
+                        "roll %.3f deg\n",
+                        refFps, length(b.pos - ref.pos), devY * 100.0f, devPitch * 180.0f / kPi,
+                        devRoll * 180.0f / kPi);
+        }
+    }
+}
+
+// AI fleet traffic for sizing harbour scenes: boats spread over rings and
+// patrol lanes at roughly constant density, the water field rebuilt around
+// the middle every frame as in the game (its cost is not included).
+void benchFleet() {
+    const float waterY = -0.5f;
+    const float dt = 1.0f / 60.0f;
+    std::printf("[fleet] AI boats on waypoint routes, %d hull points each, %.0f Hz steps\n", kBoatHullPoints,
+                kBoatStepHz);
+    Fleet fleet;
+    for (int count : {100, 500, 1000, 4000}) {
+        const float outer = std::max(60.0f, std::sqrt(count * 400.0f / kPi));
+        for (bool parallel : {false, true}) {
+            initFleet(fleet, count, 20.0f, outer, waterY);
+            clearRipples();
+            double ms = 0.0;
+            long long contacts = 0, wakes = 0;
+            const int frames = 120;
+            for (int f = 0; f < frames; ++f) {
+                buildWaterField(Vec3(), f * dt);
+                updateFleet(fleet, dt, waterY, f * dt, Vec3(), nullptr, 0, parallel);
+                ms += fleetStats().updateMs;
+                contacts += fleetStats().contacts;
+                wakes += fleetStats().wakes;
+                pruneRipples(f * dt);
+            }
+            std::printf("  %5d boats (%4.0f m harbour, %3zu routes) %-8s: %7.3f ms/update, %5.2f us/boat, "
+                        "%5.1f contacts/frame, %4.1f wakes/frame\n",
+                        count, 2.0f * outer, fleet.routes.size(), parallel ? "parallel" : "serial", ms / frames,
+                        ms / frames / count * 1e3, static_cast<double>(contacts) / frames,
+                        static_cast<double>(wakes) / frames);
+        }
+    }
+    clearRipples();
+}
+
+// The istringstream OBJ parser loadObjMesh used before ObjLoader, kept as
+// the reference for timing and output checks. Faces beyond quads are dropped.
+std::vector<float> loadObjStream(const std::string &path) {
+    std::ifstream in(path);
+    std::vector<Vec3> positions;
+    std::vector<Vec3> normals;
+    std::vector<Vec2> uvs;
+    std::vector<float> verts;
+
+    auto pushVertex = [&](int vIdx, int nIdx, int tIdx) {
+        Vec3 p = positions.at(vIdx - 1);
+        Vec3 n = nIdx > 0 ? normals.at(nIdx - 1) : Vec3(0.0f, 1.0f, 0.0f);
+        Vec2 uv(0.0f, 0.0f);
+        if (tIdx > 0 && tIdx - 1 < static_cast<int>(uvs.size())) {
+            uv = uvs[tIdx - 1];
+        }
+        verts.push_back(p.x); verts.push_back(p.y); verts.push_back(p.z);
+        verts.push_back(n.x); verts.push_back(n.y); verts.push_back(n.z);
+        verts.push_back(uv.x); verts.push_back(uv.y);
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::string tag;
+        iss >> tag;
+        if (tag == "v") {
+            Vec3 p;
+            iss >> p.x >> p.y >> p.z;
+            positions.push_back(p);
+        } else if (tag == "vn") {
+            Vec3 n;
+            iss >> n.x >> n.y >> n.z;
+            normals.push_back(normalize(n));
+        } else if (tag == "vt") {
+            Vec2 t;
+            iss >> t.x >> t.y;
+            uvs.push_back(t);
+        } else if (tag == "f") {
+            std::vector<std::string> f;
+            std::string token;
+            while (iss >> token) f.push_back(token);
+            auto parseTriplet = [&](const std::string &s, int &vIdx, int &tIdx, int &nIdx) {
+                vIdx = nIdx = tIdx = 0;
+                size_t firstSlash = s.find('/');
+                size_t secondSlash = s.find('/', firstSlash + 1);
+                vIdx = std::stoi(s.substr(0, firstSlash));
+                if (secondSlash != std::string::npos && secondSlash > firstSlash) {
+                    std::string tstr = s.substr(firstSlash + 1, secondSlash - firstSlash - 1);
+                    if (!tstr.empty()) tIdx = std::stoi(tstr);
+                    std::string nstr = s.substr(secondSlash + 1);
+                    if (!nstr.empty()) nIdx = std::stoi(nstr);
+                }
+            };
+            auto emitTri = [&](int a, int b, int c, int ta, int tb, int tc, int na, int nb, int nc) {
+                pushVertex(a, na, ta);
+                pushVertex(b, nb, tb);
+                pushVertex(c, nc, tc);
+            };
+            if (f.size() == 3) {
+                int v[3], t[3], n[3];
+                for (int i = 0; i < 3; ++i) parseTriplet(f[i], v[i], t[i], n[i]);
+                emitTri(v[0], v[1], v[2], t[0], t[1], t[2], n[0], n[1], n[2]);
+            } else if (f.size() == 4) {
+                int v[4], t[4], n[4];
+                for (int i = 0; i < 4; ++i) parseTriplet(f[i], v[i], t[i], n[i]);
+                emitTri(v[0], v[1], v[2], t[0], t[1], t[2], n[0], n[1], n[2]);
+                emitTri(v[0], v[2], v[3], t[0], t[2], t[3], n[0], n[2], n[3]);
+            }
+        }
+    }
+    return verts;
+}
+
+const char *const kBenchModels[] = {
+    "assets/models/SpeedBoat/10634_SpeedBoat_v01_LOD3.obj",
+    "assets/models/Fish/12265_Fish_v1_L2.obj",
+    "assets/models/chest.obj",
+};
+
+// Triangle soup of an indexed mesh, as the old loader produced it.
+std::vector<float> expandIndexed(const MeshData &mesh) {
+    std::vector<float> soup(mesh.indices.size() * kObjVertexFloats);
+    for (size_t i = 0; i < mesh.indices.size(); ++i) {
+        std::copy_n(&mesh.vertices[static_cast<size_t>(mesh.indices[i]) * kObjVertexFloats], kObjVertexFloats,
+                    &soup[i * kObjVertexFloats]);
+    }
+    return soup;
+}
+
+// OBJ loading, the old stream parser against the mapped from_chars one.
+// Output must match wherever the old parser handled every face; polygons of
+// five or more corners, which it dropped, now come through as fans. Then
+// what indexing and reordering save: vertex memory against the soup, and
+// vertex shader runs per triangle (ACMR) through a 16-entry FIFO cache in
+// file order, after Tipsify, and after the overdraw sort. Run from the repo
+// root.
+void benchObj() {
+    std::printf("[obj] model load, istringstream parser vs mapped from_chars parser\n");
+    std::vector<MeshData> loaded;
+    std::vector<const char *> names;
+    for (const char *path : kBenchModels) {
+        std::ifstream probe(path, std::ios::binary | std::ios::ate);
+        const char *name = std::strrchr(path, '/') + 1;
+        if (!probe) {
+            std::printf("  %s: not found, skipped\n", path);
+            continue;
+        }
+        const double mb = static_cast<double>(probe.tellg()) / (1024.0 * 1024.0);
+        std::vector<float> before;
+        MeshData after;
+        const double streamSec = timeIt([&] { before = loadObjStream(path); }, 1.0);
+        const double mappedSec = timeIt([&] { after = loadObj(path); }, 1.0);
+        const std::vector<float> soup = expandIndexed(after);
+        const size_t beforeTris = before.size() / (3 * kObjVertexFloats);
+        const size_t afterTris = after.indices.size() / 3;
+        const char *check = "identical";
+        if (beforeTris != afterTris) {
+            check = "differs (n-gons)";
+        } else if (std::memcmp(before.data(), soup.data(), before.size() * sizeof(float)) != 0) {
+            check = "MISMATCH";
+        }
+        std::printf("  %-34s %5.2f MB: stream %8.2f ms (%6.1f MB/s), mapped %7.2f ms (%6.1f MB/s), %5.1fx; "
+                    "%zu -> %zu tris, %s\n",
+                    name, mb, streamSec * 1e3, mb / streamSec, mappedSec * 1e3, mb / mappedSec,
+                    streamSec / mappedSec, beforeTris, afterTris, check);
+        loaded.push_back(std::move(after));
+        names.push_back(name);
+    }
+
+    std::printf("[obj] indexed vertices and vertex cache order (ACMR, %d-entry FIFO)\n", kVertexCacheSize);
+    for (size_t m = 0; m < loaded.size(); ++m) {
+        const MeshData &mesh = loaded[m];
+        const size_t tris = mesh.indices.size() / 3;
+        const size_t vertexCount = mesh.vertices.size() / kObjVertexFloats;
+        const double soupKb = tris * 3.0 * kObjVertexFloats * sizeof(float) / 1024.0;
+        const double indexedKb =
+            (mesh.vertices.size() * sizeof(float) + mesh.indices.size() * sizeof(uint32_t)) / 1024.0;
+
+        std::vector<uint32_t> tipsified = mesh.indices;
+        std::vector<uint32_t> clusters;
+        optimizeVertexCache(tipsified, vertexCount, kVertexCacheSize, &clusters);
+        std::vector<uint32_t> sorted = tipsified;
+        optimizeOverdraw(sorted, mesh.vertices, kObjVertexFloats, clusters);
+        MeshData optimized;
+        const double optimizeSec = timeIt([&] {
+            optimized = mesh;
+            optimizeMesh(optimized);
+        });
+        const bool same = expandIndexed(optimized).size() == tris * 3 * kObjVertexFloats &&
+                          optimized.vertices.size() == mesh.vertices.size();
+        std::printf("  %-34s %6zu tris: %6zu -> %6zu vertices, %7.0f -> %6.0f KB (%4.1f%%); ACMR %.3f file, "
+                    "%.3f tipsify, %.3f +overdraw (%zu clusters); optimize %.2f ms%s\n",
+                    names[m], tris, tris * 3, vertexCount, soupKb, indexedKb, 100.0 * indexedKb / soupKb,
+                    vertexCacheMissRatio(mesh.indices, vertexCount),
+                    vertexCacheMissRatio(tipsified, vertexCount), vertexCacheMissRatio(sorted, vertexCount),
+                    clusters.size(), optimizeSec * 1e3, same ? "" : ", VERTEX COUNT CHANGED");
+    }
+
+    // Cold start with and without a current .wmesh (written to the temp
+    // directory here, not next to the models). Both include hashing the OBJ.
+    std::printf("[obj] float .wmesh cache: first load (parse, optimize, simplify, write) vs later loads (map, hash, "
+                "validate)\n");
+    size_t m = 0;
+    for (const char *path : kBenchModels) {
+        if (!std::ifstream(path)) continue;
+        const std::string cachePath =
+            (std::filesystem::temp_directory_path() / (std::string(names[m]) + ".bench.wmesh")).string();
+        double buildSec = 0.0;
+        int builds = 0;
+        MeshCacheFile cache;
+        const auto start = Clock::now();
+        do {
+            std::remove(cachePath.c_str());
+            loadMeshCache(path, cachePath, VertexFormat::Float, cache);
+            ++builds;
+            buildSec = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (buildSec < 0.5);
+        const bool built = !cache.fromCache;
+        const double cachedSec = timeIt([&] { loadMeshCache(path, cachePath, VertexFormat::Float, cache); });
+        MeshData optimized = loaded[m];
+        optimizeMesh(optimized);
+        buildMeshLods(optimized);
+        const bool same = cache.fromCache && cache.view.vertexCount * kObjVertexFloats == optimized.vertices.size() &&
+                          cache.view.indexCount == optimized.indices.size() &&
+                          std::memcmp(cache.view.vertices, optimized.vertices.data(),
+                                      optimized.vertices.size() * sizeof(float)) == 0 &&
+                          std::memcmp(cache.view.indices, optimized.indices.data(),
+                                      optimized.indices.size() * sizeof(uint32_t)) == 0;
+        std::printf("  %-34s %7.0f KB cache: first %7.2f ms, cached %6.3f ms (%5.1fx), bounds (%.2f %.2f %.2f)..(%.2f "
+                    "%.2f %.2f), %s\n",
+                    names[m], std::filesystem::file_size(cachePath) / 1024.0, buildSec / builds * 1e3,
+                    cachedSec * 1e3, buildSec / builds / cachedSec, cache.view.boundsMin.x, cache.view.boundsMin.y,
+                    cache.view.boundsMin.z, cache.view.boundsMax.x, cache.view.boundsMax.y, cache.view.boundsMax.z,
+                    built && same ? "matches the optimized OBJ" : "MISMATCH");
+        std::remove(cachePath.c_str());
+        ++m;
+    }
+
+    // Quantized vertices against the floats they came from, decoded as the
+    // shaders do. VRAM is the vertex plus index buffer.
+    std::printf("[obj] vertex formats: bytes per vertex, VRAM per mesh, and quantization error\n");
+    for (m = 0; m < loaded.size(); ++m) {
+        MeshData mesh = loaded[m];
+        optimizeMesh(mesh);
+        const std::vector<uint8_t> bytes = serializeMeshCache(mesh, VertexFormat::Quantized, 0, 0);
+        MeshCacheView view;
+        parseMeshCache(bytes.data(), bytes.size(), VertexFormat::Quantized, 0, 0, view);
+        const VertexLayout floatLayout = vertexLayout(VertexFormat::Float);
+        const double indexKb = view.indexCount * sizeof(uint32_t) / 1024.0;
+        const double floatKb = view.vertexCount * floatLayout.stride / 1024.0 + indexKb;
+        const double quantKb = view.vertexCount * view.layout.stride / 1024.0 + indexKb;
+        if (view.format != VertexFormat::Quantized) {
+            std::printf("  %-34s texcoords outside [0, 1], kept as floats\n", names[m]);
+            continue;
+        }
+        const Vec3 extent = view.boundsMax - view.boundsMin;
+        const float diagonal = length(extent);
+        float posErr = 0.0f, normalErrDeg = 0.0f, uvErr = 0.0f;
+        const uint8_t *base = static_cast<const uint8_t *>(view.vertices);
+        for (uint32_t i = 0; i < view.vertexCount; ++i) {
+            const uint8_t *q = base + static_cast<size_t>(i) * view.layout.stride;
+            const float *f = &mesh.vertices[static_cast<size_t>(i) * kObjVertexFloats];
+            uint16_t pos[3], uv[2];
+            uint32_t packed;
+            std::memcpy(pos, q + view.layout.attribs[0].offset, sizeof(pos));
+            std::memcpy(&packed, q + view.layout.attribs[1].offset, sizeof(packed));
+            std::memcpy(uv, q + view.layout.attribs[2].offset, sizeof(uv));
+            const Vec3 p(view.boundsMin.x + pos[0] / 65535.0f * extent.x,
+                         view.boundsMin.y + pos[1] / 65535.0f * extent.y,
+                         view.boundsMin.z + pos[2] / 65535.0f * extent.z);
+            posErr = std::max(posErr, length(p - Vec3(f[0], f[1], f[2])));
+            // Sign-extend the 10-bit x and y, then fold back as octDecode does
+            const float ex = std::max(static_cast<float>(static_cast<int32_t>(packed << 22) >> 22) / 511.0f, -1.0f);
+            const float ey =
+                std::max(static_cast<float>(static_cast<int32_t>(packed << 12) >> 22) / 511.0f, -1.0f);
+            Vec3 n(ex, ey, 1.0f - std::fabs(ex) - std::fabs(ey));
+            const float fold = std::max(-n.z, 0.0f);
+            n.x += n.x >= 0.0f ? -fold : fold;
+            n.y += n.y >= 0.0f ? -fold : fold;
+            const float cosAngle = std::min(1.0f, dot(normalize(n), Vec3(f[3], f[4], f[5])));
+            normalErrDeg = std::max(normalErrDeg, std::acos(cosAngle) * 180.0f / kPi);
+            uvErr = std::max(uvErr, std::max(std::fabs(uv[0] / 65535.0f - f[6]), std::fabs(uv[1] / 65535.0f - f[7])));
+        }
+        std::printf("  %-34s %6u vertices: float %2u B/vertex, %6.0f KB; quantized %2u B/vertex, %6.0f KB "
+                    "(%4.1f%%); max error position %.1e of the diagonal, normal %.2f deg, texcoord %.1e\n",
+                    names[m], view.vertexCount, floatLayout.stride, floatKb, view.layout.stride, quantKb,
+                    100.0 * quantKb / floatKb, posErr / diagonal, normalErrDeg, uvErr);
+    }
+
+    // LOD chain as the cache stores it. Error is the simplifier's RMS plane
+    // distance, relative to the bounding diagonal; "pixels at 10 m" is what
+    // that comes to on a 1080p, 60-degree view with the model scaled to 1 m.
+    std::printf("[obj] quadric simplification: LOD chain per model\n");
+    for (m = 0; m < loaded.size(); ++m) {
+        MeshData mesh = loaded[m];
+        optimizeMesh(mesh);
+        MeshData lodded;
+        const double buildSec = timeIt([&] {
+            lodded = mesh;
+            buildMeshLods(lodded);
+        });
+        const size_t vertexCount = lodded.vertices.size() / kObjVertexFloats;
+        Vec3 lo(lodded.vertices[0], lodded.vertices[1], lodded.vertices[2]), hi = lo;
+        for (size_t v = 0; v < lodded.vertices.size(); v += kObjVertexFloats) {
+            lo = Vec3(std::min(lo.x, lodded.vertices[v]), std::min(lo.y, lodded.vertices[v + 1]),
+                      std::min(lo.z, lodded.vertices[v + 2]));
+            hi = Vec3(std::max(hi.x, lodded.vertices[v]), std::max(hi.y, lodded.vertices[v + 1]),
+                      std::max(hi.z, lodded.vertices[v + 2]));
+        }
+        const float diagonal = length(hi - lo);
+        const float pixelsPerDiagonalAt10m = 1080.0f / (2.0f * std::tan(kPi / 6.0f) * 10.0f);
+        std::printf("  %-34s build %7.2f ms, indices %zu -> %zu (%4.1f%%)\n", names[m], buildSec * 1e3,
+                    mesh.indices.size(), lodded.indices.size(), 100.0 * lodded.indices.size() / mesh.indices.size());
+        for (size_t l = 0; l < lodded.lods.size(); ++l) {
+            const MeshLod &lod = lodded.lods[l];
+            const std::vector<uint32_t> range(lodded.indices.begin() + lod.indexOffset,
+                                              lodded.indices.begin() + lod.indexOffset + lod.indexCount);
+            std::printf("    LOD %zu %6u tris (%5.1f%%), error %.1e of the diagonal (%5.2f px at 10 m), ACMR %.3f\n",
+                        l, lod.indexCount / 3, 100.0 * lod.indexCount / lodded.lods[0].indexCount,
+                        lod.error / diagonal, lod.error / diagonal * pixelsPerDiagonalAt10m,
+                        vertexCacheMissRatio(range, vertexCount));
+        }
+    }
+}
+
+bool sameMesh(const MeshData &a, const MeshData &b) {
+    return a.vertices.size() == b.vertices.size() && a.indices.size() == b.indices.size() &&
+           std::memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(float)) == 0 &&
+           std::memcmp(a.indices.data(), b.indices.data(), a.indices.size() * sizeof(uint32_t)) == 0;
+}
+
+// Writes a gridSize^2-vertex heightfield OBJ of v/vt/vn records and quads,
+// the second half of the faces with negative indices. Returns its size.
+size_t writeGridObj(const std::string &path, int gridSize) {
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f) return 0;
+    std::vector<char> buffer(1 << 20);
+    std::setvbuf(f, buffer.data(), _IOFBF, buffer.size());
+    for (int z = 0; z < gridSize; ++z) {
+        for (int x = 0; x < gridSize; ++x) {
+            const float h = 0.5f * std::sin(x * 0.05f) * std::cos(z * 0.07f);
+            std::fprintf(f, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n", x * 0.1f, h, z * 0.1f,
+                         x / float(gridSize - 1), z / float(gridSize - 1), -0.0175f * std::cos(x * 0.05f), 1.0f,
+                         0.0245f * std::sin(z * 0.07f));
+        }
+    }
+    const long count = static_cast<long>(gridSize) * gridSize;
+    for (int z = 0; z + 1 < gridSize; ++z) {
+        for (int x = 0; x + 1 < gridSize; ++x) {
+            long c[4] = {z * gridSize + x + 1, z * gridSize + x + 2, (z + 1) * gridSize + x + 2,
+                         (z + 1) * gridSize + x + 1};
+            if (z >= gridSize / 2) {
+                for (long &i : c) i -= count + 1;
+            }
+            std::fprintf(f, "f %ld/%ld/%ld %ld/%ld/%ld %ld/%ld/%ld %ld/%ld/%ld\n", c[0], c[0], c[0], c[1], c[1], c[1],
+                         c[2], c[2], c[2], c[3], c[3], c[3]);
+        }
+    }
+    const long size = std::ftell(f);
+    std::fclose(f);
+    return size > 0 ? static_cast<size_t>(size) : 0;
+}
+
+// Chunked OBJ parsing across the worker pool against one serial pass, on
+// the models and on a ~200 MB generated grid (written to the temp
+// directory). Output must be identical at every thread count.
+void benchObjParallel() {
+    const int hardware = workerThreadCount();
+    std::vector<int> threadCounts;
+    for (int n = 1; n < std::max(hardware, 8); n *= 2) threadCounts.push_back(n);
+    threadCounts.push_back(std::max(hardware, 8));
+
+    std::printf("[objpar] chunked parallel OBJ parse, %d hardware threads\n", hardware);
+    std::vector<std::string> paths(std::begin(kBenchModels), std::end(kBenchModels));
+    const std::string gridPath = (std::filesystem::temp_directory_path() / "cs1750_bench_grid.obj").string();
+    const size_t gridBytes = writeGridObj(gridPath, 1040);
+    if (gridBytes > 0) paths.push_back(gridPath);
+    for (const std::string &path : paths) {
+        if (!std::ifstream(path)) continue;
+        const double mb = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+        const double minSeconds = mb > 50.0 ? 0.0 : 0.5;
+        MeshData serial;
+        const double serialSec = timeIt([&] { serial = loadObj(path, false); }, minSeconds);
+        std::printf("  %-34s %7.2f MB, %zu tris, %zu vertices: serial %8.2f ms (%6.1f MB/s)\n",
+                    path.substr(path.find_last_of('/') + 1).c_str(), mb, serial.indices.size() / 3,
+                    serial.vertices.size() / kObjVertexFloats, serialSec * 1e3, mb / serialSec);
+        for (int threads : threadCounts) {
+            setWorkerThreadCount(threads);
+            MeshData chunked;
+            const double sec = timeIt([&] { chunked = loadObj(path, true); }, minSeconds);
+            std::printf("    %2d threads: %8.2f ms (%6.1f MB/s), speedup %5.2fx, efficiency %3.0f%%, %s\n", threads,
+                        sec * 1e3, mb / sec, serialSec / sec, 100.0 * serialSec / sec / threads,
+                        sameMesh(serial, chunked) ? "identical" : "MISMATCH");
+        }
+        setWorkerThreadCount(hardware);
+    }
+    std::remove(gridPath.c_str());
+}
+
+struct BenchSection {
+    const char *name;
+    void (*run)();
+};
+
+const BenchSection kSections[] = {
+    {"waves", benchWaves},
+    {"height", benchWaveHeight},
+    {"derivs", benchDerivs},
+    {"waterfield", benchWaterField},
+    {"ripples", benchRipples},
+    {"ocean", benchOcean},
+    {"swe", benchShallowWater},
+    {"events", benchEvents},
+    {"stones", benchStones},
+    {"fish", benchFish},
+    {"boat", benchBoat},
+    {"fleet", benchFleet},
+    {"obj", benchObj},
+    {"objpar", benchObjParallel},
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::printf("best SIMD path: %s\n", simdPathName(bestSimdPath()));
+    for (const BenchSection &s : kSections) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], s.name) == 0) selected = true;
+        }
+        if (selected) s.run();
+    }
+    return 0;
+}
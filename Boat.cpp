@@ -1,5 +1,8 @@
 #include "Boat.hpp"
+#include "WaterField.hpp"
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 Vec3 boatForward(const Boat &b) {
     // Adjusted so forward aligns with the visual bow (model is rotated relative to yaw)
@@ -13,10 +16,42 @@ Vec3 boatForwardVisual(const Boat &b) {
     return normalize(Vec3(std::cos(rad), 0.0f, std::sin(rad)));
 }
 
-void updateBoat(Boat &b, float dt, bool forward, bool back, bool turnL, bool turnR,
-                float waterHeight, float timef) {
-    if (!b.active) return;
+namespace {
+
+// Slack on the step boundary: dt and step rarely sum exactly in float, and a
+// step that comes up an ulp short would run a frame late on the next inputs.
+constexpr float kStepSlack = 1e-6f;
+
+// Hull sample grid on the bottom: 4 stations along the keel by 3 across
+constexpr float kHullLength = 3.0f;
+constexpr float kHullWidth = 1.2f;
+constexpr float kHullBottom = -0.2f; // below the boat origin
+constexpr float kDraft = 0.15f;      // bottom depth at rest, so the origin rides 0.05 above the water
+constexpr float kMaxSubmerge = 0.6f; // buoyancy stops growing past this depth
+constexpr float kGravity = 9.81f;
+// Per point and unit mass: the stiffness that holds the hull at kDraft, and
+// drag on the point's vertical velocity (about 0.4 of critical in heave)
+constexpr float kPointStiffness = kGravity / (kDraft * kBoatHullPoints);
+constexpr float kPointDrag = 0.55f;
+constexpr float kPitchInertia = kHullLength * kHullLength / 12.0f; // per unit mass
+constexpr float kRollInertia = kHullWidth * kHullWidth / 12.0f;
+constexpr float kAngularDrag = 1.5f;  // 1/s, on top of the point drag
+constexpr float kBowLift = 0.6f;      // pitch acceleration per m/s of forward speed
+constexpr float kMaxTilt = 0.6f;      // radians
+
+float hullFwd(int i) { return (static_cast<float>(i / 3) - 1.5f) * (kHullLength / 4.0f); }
+float hullRight(int i) { return static_cast<float>(i % 3 - 1) * (kHullWidth * 0.5f); }
+
+BoatPose boatState(const Boat &b) {
+    BoatPose s;
+    s.pos = b.pos;
+    s.yawDeg = b.yawDeg;
+    s.pitch = b.pitch;
+    s.roll = b.roll;
+    return s;
+}
 
+void stepBoat(Boat &b, float dt, bool forward, bool back, bool turnL, bool turnR, float waterHeight, float time) {
     const float accel = 4.0f;
     const float maxSpeed = 8.0f;
     const float turnSpeed = 60.0f;
@@ -43,11 +78,115 @@ void updateBoat(Boat &b, float dt, bool forward, bool back, bool turnL, bool tur
     // Damping
     b.speed *= std::exp(-1.2f * dt);
 
-    // Bob with waves + ripples
-    Vec3 sample(b.pos.x, 0.0f, b.pos.z);
-    Vec3 surf = evalGerstnerXZ(sample, timef);
-    float yTarget = waterHeight + surf.y + rippleFieldHeight(sample, timef) + 0.05f;
-    b.pos.y = b.pos.y * 0.8f + yTarget * 0.2f;
+    const HullArrays hull = {&b.pos.x, &b.pos.y, &b.pos.z, &b.yawDeg, &b.speed,
+                             &b.velY, &b.pitch, &b.pitchVel, &b.roll, &b.rollVel};
+    stepHulls(hull, 0, 1, dt, waterHeight, time);
+}
+
+} // namespace
+
+void updateBoat(Boat &b, float dt, bool forward, bool back, bool turnL, bool turnR,
+                float waterHeight, float timef) {
+    if (!b.active) return;
+
+    const float step = 1.0f / kBoatStepHz;
+    if (!b.started) { // the simulation starts at timef
+        b.prev = boatState(b);
+        b.pose = b.prev;
+        b.stepTime = 0.0f;
+        b.started = true;
+        return;
+    }
+    const int steps = takeFixedSteps(b.stepTime, dt);
+    for (int k = 0; k < steps; ++k) {
+        b.prev = boatState(b);
+        stepBoat(b, step, forward, back, turnL, turnR, waterHeight,
+                 timef - b.stepTime - static_cast<float>(steps - 1 - k) * step);
+    }
+
+    // Render between the last two steps
+    const float t = b.stepTime / step;
+    const BoatPose cur = boatState(b);
+    float yawDiff = cur.yawDeg - b.prev.yawDeg;
+    while (yawDiff > 180.0f) yawDiff -= 360.0f;
+    while (yawDiff < -180.0f) yawDiff += 360.0f;
+    b.pose.pos = b.prev.pos + (cur.pos - b.prev.pos) * t;
+    b.pose.yawDeg = b.prev.yawDeg + yawDiff * t;
+    b.pose.pitch = b.prev.pitch + (cur.pitch - b.prev.pitch) * t;
+    b.pose.roll = b.prev.roll + (cur.roll - b.prev.roll) * t;
+}
+
+int takeFixedSteps(float &stepTime, float dt) {
+    const float step = 1.0f / kBoatStepHz;
+    stepTime += dt;
+    int steps = 0;
+    while (stepTime >= step - kStepSlack && steps < kBoatMaxSteps) {
+        stepTime = std::max(0.0f, stepTime - step);
+        ++steps;
+    }
+    stepTime = std::min(stepTime, step);
+    return steps;
+}
+
+void shoveBoat(Boat &b, const Vec3 &offset) {
+    b.pos += offset;
+    b.prev.pos += offset;
+    b.pose.pos += offset;
+}
+
+void stepHulls(const HullArrays &h, int begin, int end, float dt, float waterHeight, float time) {
+    // Hull points in world space (waves + ripples; the tilt's small XZ
+    // shift is ignored), all boats in one query
+    const int n = end - begin;
+    thread_local std::vector<float> xs, zs, ys;
+    xs.resize(static_cast<size_t>(n) * kBoatHullPoints);
+    zs.resize(xs.size());
+    ys.resize(xs.size());
+    for (int b = begin; b < end; ++b) {
+        const float rad = (h.yawDeg[b] + 90.0f) * (kPi / 180.0f); // see boatForward
+        const float fwdX = std::cos(rad), fwdZ = std::sin(rad);
+        float *px = &xs[static_cast<size_t>(b - begin) * kBoatHullPoints];
+        float *pz = &zs[static_cast<size_t>(b - begin) * kBoatHullPoints];
+        for (int i = 0; i < kBoatHullPoints; ++i) {
+            px[i] = h.x[b] + fwdX * hullFwd(i) - fwdZ * hullRight(i);
+            pz[i] = h.z[b] + fwdZ * hullFwd(i) + fwdX * hullRight(i);
+        }
+    }
+    surfaceHeightBatchAt(xs.data(), zs.data(), static_cast<int>(xs.size()), time, ys.data());
+
+    for (int b = begin; b < end; ++b) {
+        // Buoyancy and drag at each submerged point
+        const float *py = &ys[static_cast<size_t>(b - begin) * kBoatHullPoints];
+        const float sp = std::sin(h.pitch[b]), cp = std::cos(h.pitch[b]);
+        const float sr = std::sin(h.roll[b]), cr = std::cos(h.roll[b]);
+        float lift = 0.0f, pitchTorque = 0.0f, rollTorque = 0.0f;
+        for (int i = 0; i < kBoatHullPoints; ++i) {
+            const float f = hullFwd(i);
+            const float r = hullRight(i);
+            const float depth = waterHeight + py[i] - (h.y[b] + kHullBottom + f * sp + r * sr);
+            if (depth <= 0.0f) continue;
+            const float pointVelY = h.velY[b] + f * cp * h.pitchVel[b] + r * cr * h.rollVel[b];
+            const float force = kPointStiffness * std::min(depth, kMaxSubmerge) - kPointDrag * pointVelY;
+            lift += force;
+            pitchTorque += force * f * cp;
+            rollTorque += force * r * cr;
+        }
+
+        // Semi-implicit Euler
+        h.velY[b] += (lift - kGravity) * dt;
+        h.pitchVel[b] += (pitchTorque / kPitchInertia + kBowLift * std::max(h.speed[b], 0.0f) -
+                          kAngularDrag * h.pitchVel[b]) * dt;
+        h.rollVel[b] += (rollTorque / kRollInertia - kAngularDrag * h.rollVel[b]) * dt;
+        h.y[b] += h.velY[b] * dt;
+        h.pitch[b] = std::clamp(h.pitch[b] + h.pitchVel[b] * dt, -kMaxTilt, kMaxTilt);
+        h.roll[b] = std::clamp(h.roll[b] + h.rollVel[b] * dt, -kMaxTilt, kMaxTilt);
+    }
+}
+
+Mat4 boatTilt(const BoatPose &pose) {
+    // In a frame where forward is +x and starboard +z: pitch about z, roll about x
+    const float a = (pose.yawDeg + 90.0f) * (kPi / 180.0f); // see boatForward
+    return Mat4::rotateY(-a) * Mat4::rotateZ(pose.pitch) * Mat4::rotateX(-pose.roll) * Mat4::rotateY(a);
 }
 
 static void pushSingleCube(const Boat &b, Vec3 &cubePos) {
@@ -4,17 +4,73 @@
 #include "Waves.hpp"
 #include "Stone.hpp"
 
+// The boat floats as a rigid body in heave, pitch and roll: buoyancy and
+// drag act at a grid of hull points, sampled with one batched surface query
+// per step, and their sum gives the lift and the pitch/roll torques. Yaw and
+// horizontal motion stay under direct driving control. Physics runs at a fixed
+// kBoatStepHz whatever the frame rate; render from the interpolated pose.
+
+constexpr float kBoatStepHz = 120.0f;
+constexpr int kBoatMaxSteps = 8; // per update; longer frames drop time
+constexpr int kBoatHullPoints = 12;
+
+// Where the boat is drawn: the physics state blended between the last two
+// steps. Pitch is bow up, roll is starboard (right) side up; radians.
+struct BoatPose {
+    Vec3 pos;
+    float yawDeg = 0.0f;
+    float pitch = 0.0f;
+    float roll = 0.0f;
+};
+
 struct Boat {
     Vec3 pos;
     float yawDeg;
     float speed;
     bool active;
+    // Rigid-body state beyond the driven XZ and yaw
+    float velY;
+    float pitch, pitchVel;
+    float roll, rollVel;
+    float stepTime; // time not yet simulated, at most one step
+    bool started;   // set by the first update, which only records the pose
+    BoatPose prev;  // state at the start of the last step
+    BoatPose pose;  // interpolated for rendering and the camera
 
-    Boat() : pos(), yawDeg(0.0f), speed(0.0f), active(true) {}
+    Boat()
+        : pos(), yawDeg(0.0f), speed(0.0f), active(true), velY(0.0f), pitch(0.0f), pitchVel(0.0f),
+          roll(0.0f), rollVel(0.0f), stepTime(0.0f), started(false) {}
 };
 
 Vec3 boatForward(const Boat &b);
 Vec3 boatForwardVisual(const Boat &b); // use if the model nose is rotated in local space
+// Advances by dt in fixed steps; the inputs apply to each step. timef is the
+// frame time the water field was built at; each step samples the water at
+// its own time within the frame.
 void updateBoat(Boat &b, float dt, bool forward, bool back, bool turnL, bool turnR,
                 float waterHeight, float timef);
+// Moves the boat by an outside push (e.g. a fleet contact) between updates,
+// shifting the last step and the rendered pose with it so the
+// interpolation stays continuous.
+void shoveBoat(Boat &b, const Vec3 &offset);
+// Pitch and roll of a pose as a world-space rotation about its position;
+// apply before the yaw and the model's own transform.
+Mat4 boatTilt(const BoatPose &pose);
+
+// Hull buoyancy for boats [begin, end) over one fixed step: every hull's
+// points go into one batched surface query, then heave, pitch and roll are
+// integrated from the lift and torques. Arrays are indexed by boat; x, z,
+// yawDeg and speed are read, the rest updated in place. A single Boat uses
+// pointers to its own fields.
+struct HullArrays {
+    float *x, *y, *z;
+    const float *yawDeg, *speed;
+    float *velY, *pitch, *pitchVel, *roll, *rollVel;
+};
+// time is when the step ends, for the water query.
+void stepHulls(const HullArrays &h, int begin, int end, float dt, float waterHeight, float time);
+// Adds dt to a fixed-step clock and returns how many whole steps are now due
+// (at most kBoatMaxSteps), leaving the remainder in stepTime. Step k of n
+// ends stepTime + (n - 1 - k) steps before the frame.
+int takeFixedSteps(float &stepTime, float dt);
 void pushCubesWithBoat(const Boat &b, Vec3 &cubePos, Vec3 &cube2Pos);
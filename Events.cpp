@@ -0,0 +1,44 @@
+#include "Events.hpp"
+
+static SpscRing<GameEvent, kGameEventCapacity> g_gameEvents;
+// Written by the producer, read by whoever shows stats.
+static std::atomic<uint64_t> g_eventsPushed[kNumGameEventTypes];
+static std::atomic<uint64_t> g_eventsDropped{0};
+
+const char *gameEventName(GameEventType type) {
+    switch (type) {
+    case GameEventType::WaterSplash: return "water splash";
+    case GameEventType::TinySplash: return "tiny splash";
+    case GameEventType::LureSplash: return "lure splash";
+    case GameEventType::CubeHit: return "cube hit";
+    case GameEventType::BoatHit: return "boat hit";
+    }
+    return "?";
+}
+
+bool pushGameEvent(GameEventType type, const Vec3 &pos, float intensity, float time) {
+    GameEvent e;
+    e.type = type;
+    e.pos = pos;
+    e.intensity = intensity < 0.0f ? 0.0f : (intensity > 1.0f ? 1.0f : intensity);
+    e.time = time;
+    if (!g_gameEvents.push(e)) {
+        g_eventsDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    g_eventsPushed[static_cast<int>(type)].fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+GameEventStats gameEventStats() {
+    GameEventStats stats;
+    for (int i = 0; i < kNumGameEventTypes; ++i) {
+        stats.pushed[i] = g_eventsPushed[i].load(std::memory_order_relaxed);
+    }
+    stats.dropped = g_eventsDropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+SpscRing<GameEvent, kGameEventCapacity> &gameEventQueue() {
+    return g_gameEvents;
+}
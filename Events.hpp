@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Math.hpp"
+
+// Gameplay events (splashes, hits) raised by the simulation and consumed by
+// audio, VFX and stats. Every event is queued individually, so several in one
+// frame stay distinct, and the queue is a lock-free single-producer /
+// single-consumer ring so the producer and consumer may live on different
+// threads.
+
+enum class GameEventType : uint8_t {
+    WaterSplash, // stone skipped off the surface
+    TinySplash,  // stone sank
+    LureSplash,  // fishing lure landed
+    CubeHit,     // stone struck a floating cube
+    BoatHit,     // stone struck the boat
+};
+constexpr int kNumGameEventTypes = 5;
+
+const char *gameEventName(GameEventType type);
+
+struct GameEvent {
+    GameEventType type = GameEventType::WaterSplash;
+    Vec3 pos;
+    float intensity = 1.0f; // 0..1, e.g. from impact speed
+    float time = 0.0f;      // simulation time (seconds)
+};
+
+// Fixed-capacity ring. push() only from one thread, pop() only from one
+// (possibly different) thread. Capacity must be a power of two; head and tail
+// count monotonically, so all Capacity slots are usable.
+template <class T, int Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // False when full; the item is not queued.
+    bool push(const T &item) {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ == static_cast<uint32_t>(Capacity)) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ == static_cast<uint32_t>(Capacity)) return false;
+        }
+        items_[tail & kMask] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // False when empty.
+    bool pop(T &out) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) return false;
+        }
+        out = items_[head & kMask];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is active.
+    int size() const {
+        return static_cast<int>(tail_.load(std::memory_order_acquire) -
+                                head_.load(std::memory_order_acquire));
+    }
+    static constexpr int capacity() { return Capacity; }
+
+private:
+    static constexpr uint32_t kMask = static_cast<uint32_t>(Capacity) - 1;
+    // Producer and consumer indices on separate cache lines; each side keeps
+    // a cached copy of the other's index to avoid touching its line per item.
+    alignas(64) std::atomic<uint32_t> tail_{0};
+    uint32_t headCache_ = 0; // producer only
+    alignas(64) std::atomic<uint32_t> head_{0};
+    uint32_t tailCache_ = 0; // consumer only
+    alignas(64) T items_[Capacity];
+};
+
+constexpr int kGameEventCapacity = 1024;
+
+struct GameEventStats {
+    uint64_t pushed[kNumGameEventTypes] = {};
+    uint64_t dropped = 0; // queue was full
+};
+
+// Producer side (simulation thread). Returns false when the queue is full;
+// the drop is counted in the stats.
+bool pushGameEvent(GameEventType type, const Vec3 &pos, float intensity, float time);
+// Consumer side: hands every queued event to fn in order, returns the count.
+template <class Fn>
+int drainGameEvents(Fn &&fn);
+GameEventStats gameEventStats();
+
+// Implementation detail for drainGameEvents.
+SpscRing<GameEvent, kGameEventCapacity> &gameEventQueue();
+
+template <class Fn>
+int drainGameEvents(Fn &&fn) {
+    SpscRing<GameEvent, kGameEventCapacity> &queue = gameEventQueue();
+    GameEvent e;
+    int count = 0;
+    while (queue.pop(e)) {
+        fn(e);
+        ++count;
+    }
+    return count;
+}
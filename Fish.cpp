@@ -1,193 +1,621 @@
 #include "Fish.hpp"
+#include "Parallel.hpp"
+#include "Random.hpp"
 #include "Stone.hpp"
 #include "Rod.hpp"
-#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <functional>
+#include <limits>
 
-static float frand(float a, float b) {
-    float t = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
-    return a + (b - a) * t;
+namespace {
+
+constexpr float kRespawnDelay = 2.0f;
+constexpr float kLandedTime = 1.0f;
+constexpr float kCatchRadius = 0.6f;
+constexpr float kSpawnMargin = 2.0f; // spawns keep this far inside the bounds
+constexpr int kSpawnTries = 30;      // candidates per respawn
+constexpr int kDiskRing = 12;        // candidates per Poisson-disk step
+// Cost of a coasting (mid-range, off-slice) and a cruising (far) fish
+// relative to a full steer, for the LOD budget's predictions.
+constexpr float kCoastCost = 0.05f;
+constexpr float kCruiseCost = 0.1f;
+
+// Uniform grid over the pond (cells of neighbourRadius), rebuilt every
+// update by a counting sort that also reorders the fish arrays by cell, so a
+// cell's fish are contiguous and a row of three neighbouring cells is one
+// index range. Fish move a fraction of a cell per frame, so the reorder is
+// close to the identity after the first update and stays cache-friendly.
+// Non-swimming fish sort after every cell and are never visited.
+struct FishGrid {
+    int dim = 0;            // cells per side
+    float invCell = 1.0f;
+    float origin = 0.0f;    // world coordinate of cell 0's edge
+    std::vector<int> start; // dim * dim + 2 entries
+    std::vector<int> cellOf;
+    std::vector<int> order; // new position -> old index
+    // Snapshot the steering reads, so updates within a frame don't see each
+    // other.
+    std::vector<float> x, z, vx, vz;
+};
+
+FishGrid g_fishGrid;
+FishStats g_fishStats;
+float g_fishNsPerSteer = 0.0f; // measured, smoothed; 0 until the first update
+
+int gridCoord(const FishGrid &g, float v) {
+    return std::clamp(static_cast<int>((v - g.origin) * g.invCell), 0, g.dim - 1);
 }
 
-void initFish(std::vector<Fish> &fish, int count, float waterHeight) {
-    fish.clear();
-    fish.resize(count);
-    for (size_t i = 0; i < fish.size(); ++i) {
-        bool placed = false;
-        int tries = 0;
-        while (!placed && tries < 16) {
-            ++tries;
-            Fish &f = fish[i];
-            f.pos = Vec3(frand(-12.0f, 12.0f), waterHeight - frand(0.2f, 0.8f), frand(-12.0f, 12.0f));
-            f.vel = Vec3(frand(-1.0f, 1.0f), 0.0f, frand(-1.0f, 1.0f));
-            f.active = true;
-            f.respawnTimer = 0.0f;
-            f.yawDeg = std::atan2(f.vel.z, f.vel.x) * 180.0f / kPi;
-            // Separation check against already placed fish
-            bool collide = false;
-            for (size_t j = 0; j < i; ++j) {
-                Vec3 d = f.pos - fish[j].pos;
-                float dist2 = d.x * d.x + d.z * d.z;
-                if (dist2 < 1.0f) { collide = true; break; }
-            }
-            if (!collide) placed = true;
-        }
+template <class T>
+void permute(std::vector<T> &values, const std::vector<int> &order) {
+    static thread_local std::vector<T> scratch;
+    scratch.resize(values.size());
+    for (size_t k = 0; k < order.size(); ++k) scratch[k] = values[order[k]];
+    values.swap(scratch);
+}
+
+void buildFishGrid(FishSchool &fish) {
+    FishGrid &g = g_fishGrid;
+    const FishParams &p = fish.params;
+    g.invCell = 1.0f / p.neighbourRadius;
+    g.origin = -p.bounds;
+    g.dim = std::max(1, static_cast<int>(std::ceil(2.0f * p.bounds * g.invCell)));
+    const int cells = g.dim * g.dim;
+    g.start.assign(cells + 2, 0);
+    g.cellOf.resize(fish.count);
+
+    for (int i = 0; i < fish.count; ++i) {
+        const int c = fish.state[i] == FishState::Swimming
+            ? gridCoord(g, fish.posZ[i]) * g.dim + gridCoord(g, fish.posX[i])
+            : cells;
+        g.cellOf[i] = c;
+        g.start[c + 1]++;
+    }
+    for (int c = 0; c <= cells; ++c) g.start[c + 1] += g.start[c];
+    g_fishStats.swimming = g.start[cells];
+
+    g.order.resize(fish.count);
+    std::vector<int> fill(g.start.begin(), g.start.end() - 1);
+    for (int i = 0; i < fish.count; ++i) g.order[fill[g.cellOf[i]]++] = i;
+
+    for (std::vector<float> *v : {&fish.posX, &fish.posY, &fish.posZ, &fish.velX, &fish.velZ, &fish.yawDeg,
+                                  &fish.prevYawDeg, &fish.yawVel, &fish.timer, &fish.fightDuration,
+                                  &fish.lodDt}) {
+        permute(*v, g.order);
     }
+    permute(fish.state, g.order);
+    permute(fish.id, g.order);
+
+    g.x = fish.posX;
+    g.z = fish.posZ;
+    g.vx = fish.velX;
+    g.vz = fish.velZ;
+}
+
+float wrapDeg(float d) {
+    while (d > 180.0f) d -= 360.0f;
+    while (d < -180.0f) d += 360.0f;
+    return d;
+}
+
+void placeFish(FishSchool &fish, int i, float x, float z, float waterHeight, CounterRng &rng) {
+    fish.posX[i] = x;
+    fish.posY[i] = waterHeight - rng.uniform(0.2f, 0.8f);
+    fish.posZ[i] = z;
+    fish.velX[i] = rng.uniform(-1.0f, 1.0f);
+    fish.velZ[i] = rng.uniform(-1.0f, 1.0f);
+    fish.yawDeg[i] = std::atan2(-fish.velZ[i], fish.velX[i]) * 180.0f / kPi;
+    fish.prevYawDeg[i] = fish.yawDeg[i];
+    fish.yawVel[i] = 0.0f;
+    fish.timer[i] = 0.0f;
+    fish.fightDuration[i] = 0.0f;
+    fish.lodDt[i] = 0.0f;
+    fish.state[i] = FishState::Swimming;
 }
 
-void updateFish(std::vector<Fish> &fish, float dt, float timef, float waterHeight,
-                const Boat &boat, Rod &rod, const Vec3 &cubePos, const Vec3 &cube2Pos,
-                const Vec3 &playerPos, bool playerUnderwater, int &fishCaught) {
-    const float swimSpeed = 1.2f;
-    const float wanderYaw = 25.0f; // deg/sec
-    const float avoidRadius = 2.0f;
-    const float avoidCubeRadius = 1.2f;
-    Vec3 boatXZ(boat.pos.x, 0.0f, boat.pos.z);
-
-    for (auto &f : fish) {
-        if (!f.active) {
-            f.respawnTimer += dt;
-            if (f.respawnTimer > 2.0f) {
-                f.pos = Vec3(frand(-12.0f, 12.0f), waterHeight - frand(0.2f, 0.8f), frand(-12.0f, 12.0f));
-                f.vel = Vec3(frand(-1.0f, 1.0f), 0.0f, frand(-1.0f, 1.0f));
-                f.active = true;
-                f.respawnTimer = 0.0f;
-                f.yawDeg = std::atan2(f.vel.z, f.vel.x) * 180.0f / kPi;
-                f.prevYawDeg = f.yawDeg;
-                f.yawVel = 0.0f;
-                f.caught = false;
-                f.caughtTimer = 0.0f;
-                f.state = 0;
-                f.fightTimer = 0.0f;
-                f.fightDuration = 0.0f;
-                f.catchCounted = false;
+// Boids steering for one swimming fish against last update's snapshot in
+// the grid, covering dt over `frames` frames; returns the number of
+// neighbours it saw.
+int steerFish(FishSchool &fish, int i, float dt, int frames, const FishObstacle *obstacles,
+              int obstacleCount, CounterRng &rng) {
+    const FishParams &p = fish.params;
+    const FishGrid &g = g_fishGrid;
+    const float x = fish.posX[i];
+    const float z = fish.posZ[i];
+
+    // Wander: small random turn occasionally, otherwise a gentle jitter
+    if (rng.uniform() < 0.03f * static_cast<float>(frames)) { // ~3% chance per frame
+        fish.yawDeg[i] += rng.uniform(-15.0f, 15.0f);
+    } else {
+        fish.yawDeg[i] += rng.uniform(-25.0f, 25.0f) * dt;
+    }
+    const float yawRad = fish.yawDeg[i] * (kPi / 180.0f);
+    float steerX = std::cos(yawRad);
+    float steerZ = -std::sin(yawRad);
+
+    // Neighbours in the 3x3 cells around the fish: three contiguous rows
+    const float r2 = p.neighbourRadius * p.neighbourRadius;
+    const float sep2 = p.separationRadius * p.separationRadius;
+    float sepX = 0.0f, sepZ = 0.0f, aliX = 0.0f, aliZ = 0.0f, cohX = 0.0f, cohZ = 0.0f;
+    int neighbours = 0;
+    const int cx = gridCoord(g, x);
+    const int cz = gridCoord(g, z);
+    const int x0 = std::max(cx - 1, 0);
+    const int x1 = std::min(cx + 1, g.dim - 1);
+    for (int row = std::max(cz - 1, 0); row <= std::min(cz + 1, g.dim - 1); ++row) {
+        const int end = g.start[row * g.dim + x1 + 1];
+        for (int j = g.start[row * g.dim + x0]; j < end && neighbours < p.maxNeighbours; ++j) {
+            if (j == i) continue;
+            const float ox = g.x[j] - x;
+            const float oz = g.z[j] - z;
+            const float d2 = ox * ox + oz * oz;
+            if (d2 > r2) continue;
+            aliX += g.vx[j];
+            aliZ += g.vz[j];
+            cohX += ox;
+            cohZ += oz;
+            if (d2 < sep2 && d2 > 1e-8f) {
+                sepX -= ox / d2;
+                sepZ -= oz / d2;
             }
-            continue;
+            ++neighbours;
+        }
+    }
+    if (neighbours > 0) {
+        const float inv = 1.0f / static_cast<float>(neighbours);
+        const float aliLen = std::sqrt(aliX * aliX + aliZ * aliZ);
+        if (aliLen > 1e-4f) {
+            steerX += aliX / aliLen * p.alignmentWeight;
+            steerZ += aliZ / aliLen * p.alignmentWeight;
         }
+        steerX += cohX * inv / p.neighbourRadius * p.cohesionWeight;
+        steerZ += cohZ * inv / p.neighbourRadius * p.cohesionWeight;
+        steerX += sepX * p.separationRadius * p.separationWeight;
+        steerZ += sepZ * p.separationRadius * p.separationWeight;
+    }
 
-        if (f.caught) {
-            f.caughtTimer += dt;
-            if (f.caughtTimer > 1.0f) {
-                f.caught = false;
-                f.active = false;
-                f.respawnTimer = 0.0f;
-            }
-            continue;
+    // Obstacles push harder the closer the fish is
+    for (int o = 0; o < obstacleCount; ++o) {
+        const float ox = x - obstacles[o].pos.x;
+        const float oz = z - obstacles[o].pos.z;
+        const float dist = std::sqrt(ox * ox + oz * oz);
+        if (dist < obstacles[o].radius && dist > 0.0001f) {
+            const float push = 1.0f - dist / obstacles[o].radius;
+            steerX += ox / dist * push * p.avoidWeight;
+            steerZ += oz / dist * push * p.avoidWeight;
         }
+    }
+    // Turn back before reaching the bounds
+    const float margin = 2.0f;
+    const float edge = p.bounds - margin;
+    if (x > edge) steerX -= (x - edge) / margin * p.avoidWeight;
+    if (x < -edge) steerX += (-edge - x) / margin * p.avoidWeight;
+    if (z > edge) steerZ -= (z - edge) / margin * p.avoidWeight;
+    if (z < -edge) steerZ += (-edge - z) / margin * p.avoidWeight;
+
+    // Turn toward the steering direction at a limited rate
+    const float desiredYaw = std::atan2(-steerZ, steerX) * 180.0f / kPi;
+    const float maxTurn = p.turnRate * dt;
+    fish.yawDeg[i] = wrapDeg(fish.yawDeg[i] + std::clamp(wrapDeg(desiredYaw - fish.yawDeg[i]), -maxTurn, maxTurn));
+    return neighbours;
+}
+
+// Bridson's Poisson-disk sampling over [-half, half]^2: every point lies at
+// least r from every other. Points grow outward from a seed: a random active
+// point tries kDiskRing candidates on a ring just beyond r, at evenly spaced
+// angles from a random start, keeps every one that is clear and retires.
+// Compared with random candidates in [r, 2r) until one fails, each point is
+// visited once, packs tighter and needs no trig per candidate. The
+// background grid has cells of r / sqrt(2), so a cell holds at most one
+// point; it stores the coordinates (empty cells far away) and has a two-cell
+// border, so a candidate checks the 5x5 cells around it without branches.
+void poissonDisk(float half, float r, CounterRng &rng, std::vector<float> &xs, std::vector<float> &zs) {
+    const float cell = r / std::sqrt(2.0f);
+    const int inner = std::max(1, static_cast<int>(std::ceil(2.0f * half / cell)));
+    const int dim = inner + 4;
+    const float empty = 1e30f;
+    std::vector<float> gridX(static_cast<size_t>(dim) * dim, empty);
+    std::vector<float> gridZ(static_cast<size_t>(dim) * dim, empty);
+    std::vector<int> active;
+    const float invCell = 1.0f / cell;
+    auto coord = [&](float v) { return 2 + std::clamp(static_cast<int>((v + half) * invCell), 0, inner - 1); };
+    auto add = [&](float x, float z) {
+        const size_t c = static_cast<size_t>(coord(z)) * dim + coord(x);
+        gridX[c] = x;
+        gridZ[c] = z;
+        active.push_back(static_cast<int>(xs.size()));
+        xs.push_back(x);
+        zs.push_back(z);
+    };
+    xs.clear();
+    zs.clear();
+    add(rng.uniform(-half, half), rng.uniform(-half, half));
 
-        // Fighting state: attached to rod, wiggle until landed
-        if (f.state == 1) {
-            f.fightTimer += dt;
-
-            // Attach head to lure position
-            Vec3 dir = rod.vel;
-            dir.y = 0.0f;
-            if (length(dir) < 0.001f) dir = Vec3(1.0f, 0.0f, 0.0f);
-            dir = normalize(dir);
-            Vec3 right = Vec3(-dir.z, 0.0f, dir.x);
-
-            float wiggleAmp = 0.5f;
-            float wiggle = std::sin(f.fightTimer * 6.0f) * wiggleAmp;
-
-            // Anchor mouth at lure; keep position fixed at mouth
-            f.pos = rod.pos + dir * 0.35f + Vec3(0.0f, -0.1f, 0.0f);
-
-            // Yaw-only sweep about the mouth so the tail swings left/right (~20 deg total)
-            float baseYaw = std::atan2(dir.z, dir.x) * 180.0f / kPi;
-            f.yawDeg = baseYaw + wiggle * 20.0f;
-            f.prevYawDeg = f.yawDeg;
-            f.yawVel = 0.0f;
-            f.vel = Vec3(0.0f, 0.0f, 0.0f);
-            f.pos.y = waterHeight - 0.2f;
-
-            if (f.fightTimer > f.fightDuration) {
-                f.caught = true;
-                f.caughtTimer = 0.0f;
-                f.state = 0;
-                if (!f.catchCounted) {
-                    fishCaught++;
-                    f.catchCounted = true;
+    const float r2 = r * r;
+    const float ringDist = r * 1.0001f;
+    const float stepCos = std::cos(2.0f * kPi / kDiskRing);
+    const float stepSin = std::sin(2.0f * kPi / kDiskRing);
+    while (!active.empty()) {
+        const size_t a = rng.nextU32() % active.size();
+        const int from = active[a];
+        active[a] = active.back();
+        active.pop_back();
+        const float angle = rng.uniform(0.0f, 2.0f * kPi);
+        float ox = ringDist * std::cos(angle);
+        float oz = ringDist * std::sin(angle);
+        for (int t = 0; t < kDiskRing; ++t) {
+            const float x = xs[from] + ox;
+            const float z = zs[from] + oz;
+            const float next = ox * stepCos - oz * stepSin;
+            oz = ox * stepSin + oz * stepCos;
+            ox = next;
+            if (std::abs(x) > half || std::abs(z) > half) continue;
+            const size_t c = static_cast<size_t>(coord(z)) * dim + coord(x);
+            bool clear = true;
+            for (int j = -2; j <= 2; ++j) {
+                const float *rowX = &gridX[c + static_cast<ptrdiff_t>(j) * dim - 2];
+                const float *rowZ = &gridZ[c + static_cast<ptrdiff_t>(j) * dim - 2];
+                for (int k = 0; k < 5; ++k) {
+                    const float dx = x - rowX[k];
+                    const float dz = z - rowZ[k];
+                    clear &= dx * dx + dz * dz >= r2;
                 }
             }
-            continue;
+            if (clear) add(x, z);
         }
+    }
+}
 
-        // Simple wander in yaw (steering)
-        // Small random turn occasionally
-        float wanderChance = frand(0.0f, 1.0f);
-        if (wanderChance < 0.03f) { // ~3% chance per frame
-            f.yawDeg += frand(-15.0f, 15.0f);
-        } else {
-            f.yawDeg += frand(-wanderYaw, wanderYaw) * dt;
+// Puts a respawning fish back at least fish.spacing from every swimming fish
+// (through the grid) and from the fish respawned before it this update.
+// False when no candidate was clear; the fish waits for the next update.
+bool respawnFish(FishSchool &fish, int i, float waterHeight, const std::vector<int> &respawned) {
+    const FishParams &p = fish.params;
+    const FishGrid &g = g_fishGrid;
+    const float spawn = std::max(p.bounds - kSpawnMargin, 0.5f);
+    const float r2 = fish.spacing * fish.spacing;
+    const int reach = static_cast<int>(std::ceil(fish.spacing * g.invCell));
+    const int swimming = g.start[g.dim * g.dim];
+    CounterRng rng(p.seed, fish.id[i], fish.frame);
+    for (int t = 0; t < kSpawnTries; ++t) {
+        const float x = rng.uniform(-spawn, spawn);
+        const float z = rng.uniform(-spawn, spawn);
+        auto tooClose = [&](int j) {
+            const float dx = x - fish.posX[j];
+            const float dz = z - fish.posZ[j];
+            return dx * dx + dz * dz < r2;
+        };
+        bool clear = std::none_of(respawned.begin(), respawned.end(), tooClose);
+        const int cx = gridCoord(g, x);
+        const int cz = gridCoord(g, z);
+        const int x0 = std::max(cx - reach, 0);
+        const int x1 = std::min(cx + reach, g.dim - 1);
+        for (int row = std::max(cz - reach, 0); row <= std::min(cz + reach, g.dim - 1) && clear; ++row) {
+            const int end = std::min(g.start[row * g.dim + x1 + 1], swimming);
+            for (int j = g.start[row * g.dim + x0]; j < end; ++j) {
+                if (tooClose(j)) { clear = false; break; }
+            }
+        }
+        if (clear) {
+            placeFish(fish, i, x, z, waterHeight, rng);
+            return true;
         }
+    }
+    return false;
+}
+
+// Far tier: a constant-rate turn picked by the id, reflected off the bounds.
+// No neighbours, obstacles or random draws, and no trig: the velocity is
+// rotated by the small per-frame angle and renormalized.
+void cruiseFish(FishSchool &fish, int i, float dt) {
+    const FishParams &p = fish.params;
+    const float turn = (static_cast<float>((fish.id[i] * 2654435761u) >> 22) / 1024.0f - 0.5f) * 20.0f; // deg/s
+    const float angle = turn * dt * (kPi / 180.0f);
+    const float vx = fish.velX[i], vz = fish.velZ[i];
+    // Yaw turns +x toward -z, i.e. the (x, z) direction rotates clockwise
+    float dirX = vx + vz * angle;
+    float dirZ = vz - vx * angle;
+    const float len2 = dirX * dirX + dirZ * dirZ;
+    float yaw = fish.yawDeg[i] + turn * dt;
+    if (len2 > 1e-8f) {
+        const float inv = 1.0f / std::sqrt(len2);
+        dirX *= inv;
+        dirZ *= inv;
+    } else {
+        dirX = std::cos(yaw * (kPi / 180.0f));
+        dirZ = -std::sin(yaw * (kPi / 180.0f));
+    }
+    const float edge = p.bounds - 2.0f;
+    if ((fish.posX[i] > edge && dirX > 0.0f) || (fish.posX[i] < -edge && dirX < 0.0f)) {
+        yaw = 180.0f - yaw;
+        dirX = -dirX;
+    }
+    if ((fish.posZ[i] > edge && dirZ > 0.0f) || (fish.posZ[i] < -edge && dirZ < 0.0f)) {
+        yaw = -yaw;
+        dirZ = -dirZ;
+    }
+    yaw = wrapDeg(yaw);
+    fish.yawDeg[i] = yaw;
+    fish.prevYawDeg[i] = yaw;
+    fish.yawVel[i] = turn;
+    fish.velX[i] = dirX * p.swimSpeed;
+    fish.velZ[i] = dirZ * p.swimSpeed;
+    fish.lodDt[i] = 0.0f;
+}
+
+// Picks this update's mid-range slice and radius scale from the budget,
+// using the previous update's tier counts and the measured steer cost.
+void scheduleFishLod(const FishParams &p, float gridUs) {
+    FishStats &s = g_fishStats;
+    if (!p.lod) {
+        s.lodSlice = 1;
+        s.lodScale = 1.0f;
+        return;
+    }
+    const int maxSlice = std::max(2, p.lodMaxSlice);
+    if (p.lodBudgetUs <= 0.0f || g_fishNsPerSteer <= 0.0f) {
+        s.lodSlice = 2;
+        if (p.lodBudgetUs <= 0.0f) s.lodScale = 1.0f;
+        return;
+    }
+    auto predictUs = [&](int slice) {
+        const float steered = 1.0f / static_cast<float>(slice);
+        const float units = static_cast<float>(s.lodNear) +
+                            static_cast<float>(s.lodMid) * (steered + kCoastCost * (1.0f - steered)) +
+                            static_cast<float>(s.lodFar) * kCruiseCost;
+        return gridUs + units * g_fishNsPerSteer * 1e-3f;
+    };
+    s.lodSlice = maxSlice;
+    for (int slice = 2; slice <= maxSlice; ++slice) {
+        if (predictUs(slice) <= p.lodBudgetUs) { s.lodSlice = slice; break; }
+    }
+    // Still over at the longest slice: pull the tiers in; give room back slowly
+    if (predictUs(maxSlice) > p.lodBudgetUs) s.lodScale = std::max(0.1f, s.lodScale * 0.9f);
+    else if (predictUs(2) < 0.75f * p.lodBudgetUs) s.lodScale = std::min(1.0f, s.lodScale * 1.02f);
+}
+
+} // namespace
+
+void initFish(FishSchool &fish, int count, float waterHeight, const FishParams &params) {
+    fish.params = params;
+    fish.count = count;
+    for (std::vector<float> *v : {&fish.posX, &fish.posY, &fish.posZ, &fish.velX, &fish.velZ, &fish.yawDeg,
+                                  &fish.prevYawDeg, &fish.yawVel, &fish.timer, &fish.fightDuration,
+                                  &fish.lodDt}) {
+        v->assign(count, 0.0f);
+    }
+    fish.state.assign(count, FishState::Swimming);
+    fish.id.resize(count);
+    fish.frame = 0;
+
+    // Start at the requested spacing, or wider when few fish share a big
+    // pond (Bridson fills about 0.6 / r^2, and the surplus is thinned at
+    // random); tighten until the count fits.
+    const float spawn = std::max(params.bounds - kSpawnMargin, 0.5f);
+    const float area = 4.0f * spawn * spawn;
+    float r = std::max(params.spawnSpacing, std::sqrt(0.45f * area / std::max(count, 1)));
+    CounterRng rng(params.seed + 2u, 0); // apart from the per-fish streams
+    std::vector<float> xs, zs;
+    for (;;) {
+        poissonDisk(spawn, r, rng, xs, zs);
+        if (static_cast<int>(xs.size()) >= count) break;
+        r *= 0.9f;
+    }
+    fish.spacing = std::min(r, params.spawnSpacing);
+
+    // Random subset of the samples, so a surplus never leaves a corner empty
+    for (int i = 0; i < count; ++i) {
+        const int pick = i + static_cast<int>(rng.nextU32() % static_cast<uint32_t>(xs.size() - i));
+        std::swap(xs[i], xs[pick]);
+        std::swap(zs[i], zs[pick]);
+        fish.id[i] = static_cast<uint32_t>(i);
+        CounterRng fishRng(params.seed, fish.id[i]);
+        placeFish(fish, i, xs[i], zs[i], waterHeight, fishRng);
+    }
+}
+
+void updateFish(FishSchool &fish, float dt, float timef, float waterHeight, const Vec3 &viewPos,
+                const FishObstacle *obstacles, int obstacleCount, Rod &rod, int &fishCaught,
+                bool parallel) {
+    const auto start = std::chrono::steady_clock::now();
+    const FishParams &p = fish.params;
+    buildFishGrid(fish);
+    const auto gridEnd = std::chrono::steady_clock::now();
+    ++fish.frame;
+    scheduleFishLod(p, std::chrono::duration<float, std::micro>(gridEnd - start).count());
 
-        // Avoid boat and cubes
-        auto steerAway = [&](const Vec3 &fromPos, float radius, float turnStrengthNear, float turnStrengthFar) {
-            Vec3 to = f.pos - fromPos;
-            float dist = std::sqrt(to.x * to.x + to.z * to.z);
-            if (dist < radius && dist > 0.0001f) {
-                Vec3 away = to * (1.0f / dist);
-                float awayYaw = std::atan2(away.z, away.x) * 180.0f / kPi;
-                float delta = awayYaw - f.yawDeg;
-                while (delta > 180.0f) delta -= 360.0f;
-                while (delta < -180.0f) delta += 360.0f;
-                float strength = (dist < radius * 0.6f) ? turnStrengthNear : turnStrengthFar;
-                f.yawDeg += delta * strength;
+    const float accel = 4.0f;
+    const float blend = 1.0f - std::exp(-accel * dt);
+    const bool lureOpen = rod.active && !rod.hasCaught;
+    // LOD tiers by horizontal distance to the camera, or the lure while cast
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nearR = p.lod ? p.lodNearRadius * g_fishStats.lodScale : inf;
+    const float midR = p.lod ? p.lodMidRadius * g_fishStats.lodScale : inf;
+    const float near2 = nearR * nearR;
+    const float mid2 = midR * midR;
+    const uint64_t slice = static_cast<uint64_t>(g_fishStats.lodSlice);
+    // Shared results, all order-independent: integer sums, and the lure
+    // goes to the lowest-id fish in reach (packed id << 32 | index).
+    std::atomic<long long> neighbourSum{0};
+    std::atomic<int> landed{0};
+    std::atomic<uint64_t> hooked{~0ull};
+    std::atomic<int> tierNear{0}, tierMid{0}, tierMidSteered{0}, tierFar{0};
+
+    auto updateRange = [&](int begin, int end) {
+        long long neighbours = 0;
+        int landedHere = 0;
+        uint64_t hookedHere = ~0ull;
+        int nearHere = 0, midHere = 0, midSteeredHere = 0, farHere = 0;
+        for (int i = begin; i < end; ++i) {
+            fish.timer[i] += dt;
+
+            if (fish.state[i] == FishState::Respawning) continue; // placed after the pass
+
+            if (fish.state[i] == FishState::Landed) {
+                if (fish.timer[i] > kLandedTime) {
+                    fish.state[i] = FishState::Respawning;
+                    fish.timer[i] = 0.0f;
+                }
+                continue;
             }
-        };
 
-        steerAway(boatXZ, avoidRadius, 1.0f, 0.5f);
-        steerAway(Vec3(cubePos.x, 0.0f, cubePos.z), avoidCubeRadius, 0.9f, 0.45f);
-        steerAway(Vec3(cube2Pos.x, 0.0f, cube2Pos.z), avoidCubeRadius, 0.9f, 0.45f);
-        // Player scare when underwater and nearby
-        if (playerUnderwater) {
-            steerAway(Vec3(playerPos.x, 0.0f, playerPos.z), 2.5f, 1.2f, 0.7f);
-        }
+            // Fighting state: attached to rod, wiggle until landed
+            if (fish.state[i] == FishState::Fighting) {
+                // Attach head to lure position
+                Vec3 dir = rod.vel;
+                dir.y = 0.0f;
+                if (length(dir) < 0.001f) dir = Vec3(1.0f, 0.0f, 0.0f);
+                dir = normalize(dir);
+
+                float wiggleAmp = 0.5f;
+                float wiggle = std::sin(fish.timer[i] * 6.0f) * wiggleAmp;
+
+                // Anchor mouth at lure; keep position fixed at mouth
+                const Vec3 mouth = rod.pos + dir * 0.35f;
+                fish.posX[i] = mouth.x;
+                fish.posY[i] = waterHeight - 0.2f;
+                fish.posZ[i] = mouth.z;
 
-        // Wrap yaw
-        if (f.yawDeg > 180.0f) f.yawDeg -= 360.0f;
-        if (f.yawDeg < -180.0f) f.yawDeg += 360.0f;
-        float yawDelta = f.yawDeg - f.prevYawDeg;
-        if (yawDelta > 180.0f) yawDelta -= 360.0f;
-        if (yawDelta < -180.0f) yawDelta += 360.0f;
-        f.yawVel = yawDelta / dt;
-        f.prevYawDeg = f.yawDeg;
-
-        // Move forward along heading
-        float yawRad = f.yawDeg * (kPi / 180.0f);
-        Vec3 desiredVel(std::cos(yawRad), 0.0f, -std::sin(yawRad));
-        desiredVel = desiredVel * swimSpeed;
-
-        // Smooth velocity toward desired to reduce twitchiness
-        const float accel = 4.0f;
-        f.vel = f.vel + (desiredVel - f.vel) * (1.0f - std::exp(-accel * dt));
-
-        f.pos += f.vel * dt;
-        f.pos.y = waterHeight - 0.3f + 0.15f * std::sin(timef + f.pos.x * 0.5f);
-
-        // Keep within bounds
-        const float bounds = 14.0f;
-        f.pos.x = std::clamp(f.pos.x, -bounds, bounds);
-        f.pos.z = std::clamp(f.pos.z, -bounds, bounds);
-
-        // Heading already defines velocity
-
-        // Catch by launched red cube (rod) — only one fish per lure
-        if (rod.active && !rod.hasCaught) {
-            Vec3 d = f.pos - rod.pos;
-            float dist = std::sqrt(d.x * d.x + d.z * d.z);
-            const float catchRadiusLure = 0.6f;
-            if (dist < catchRadiusLure) {
-                // Start fighting state
-                f.state = 1;
-                f.fightTimer = 0.0f;
-                f.fightDuration = frand(0.9f, 1.4f);
-                f.catchCounted = false;
-                rod.hasCaught = true;
-                // Do not add a strong ripple; fighting shouldn't disturb the water
+                // Yaw-only sweep about the mouth so the tail swings left/right (~20 deg total)
+                float baseYaw = std::atan2(dir.z, dir.x) * 180.0f / kPi;
+                fish.yawDeg[i] = baseYaw + wiggle * 20.0f;
+                fish.prevYawDeg[i] = fish.yawDeg[i];
+                fish.yawVel[i] = 0.0f;
+                fish.velX[i] = 0.0f;
+                fish.velZ[i] = 0.0f;
+
+                if (fish.timer[i] > fish.fightDuration[i]) {
+                    fish.state[i] = FishState::Landed;
+                    fish.timer[i] = 0.0f;
+                    ++landedHere;
+                }
                 continue;
             }
+
+            float d2 = (fish.posX[i] - viewPos.x) * (fish.posX[i] - viewPos.x) +
+                       (fish.posZ[i] - viewPos.z) * (fish.posZ[i] - viewPos.z);
+            if (rod.active) {
+                d2 = std::min(d2, (fish.posX[i] - rod.pos.x) * (fish.posX[i] - rod.pos.x) +
+                                      (fish.posZ[i] - rod.pos.z) * (fish.posZ[i] - rod.pos.z));
+            }
+            fish.lodDt[i] += dt;
+            if (d2 >= mid2) {
+                ++farHere;
+                cruiseFish(fish, i, dt);
+            } else if (d2 >= near2 && (fish.id[i] + fish.frame) % slice != 0) {
+                // Mid-range between slices: coast on the current velocity
+                ++midHere;
+            } else {
+                if (d2 >= near2) {
+                    ++midHere;
+                    ++midSteeredHere;
+                } else {
+                    ++nearHere;
+                }
+                const float steerDt = fish.lodDt[i];
+                fish.lodDt[i] = 0.0f;
+                const int frames = std::max(1, static_cast<int>(steerDt / dt + 0.5f));
+                CounterRng rng(p.seed, fish.id[i], fish.frame);
+                neighbours += steerFish(fish, i, steerDt, frames, obstacles, obstacleCount, rng);
+
+                float yawDelta = wrapDeg(fish.yawDeg[i] - fish.prevYawDeg[i]);
+                fish.yawVel[i] = yawDelta / steerDt;
+                fish.prevYawDeg[i] = fish.yawDeg[i];
+
+                // Move forward along heading, smoothing velocity to reduce twitchiness
+                const float b = frames == 1 ? blend : 1.0f - std::exp(-accel * steerDt);
+                float yawRad = fish.yawDeg[i] * (kPi / 180.0f);
+                fish.velX[i] += (std::cos(yawRad) * p.swimSpeed - fish.velX[i]) * b;
+                fish.velZ[i] += (-std::sin(yawRad) * p.swimSpeed - fish.velZ[i]) * b;
+            }
+
+            fish.posX[i] = std::clamp(fish.posX[i] + fish.velX[i] * dt, -p.bounds, p.bounds);
+            fish.posZ[i] = std::clamp(fish.posZ[i] + fish.velZ[i] * dt, -p.bounds, p.bounds);
+            fish.posY[i] = waterHeight - 0.3f + 0.15f * std::sin(timef + fish.posX[i] * 0.5f);
+
+            // Catch by launched red cube (rod) — only one fish per lure. The
+            // catch radius lies well inside the near tier.
+            if (lureOpen && d2 < near2) {
+                float dx = fish.posX[i] - rod.pos.x;
+                float dz = fish.posZ[i] - rod.pos.z;
+                if (dx * dx + dz * dz < kCatchRadius * kCatchRadius) {
+                    hookedHere = std::min(hookedHere, (static_cast<uint64_t>(fish.id[i]) << 32) |
+                                                          static_cast<uint32_t>(i));
+                }
+            }
         }
+        neighbourSum.fetch_add(neighbours, std::memory_order_relaxed);
+        landed.fetch_add(landedHere, std::memory_order_relaxed);
+        uint64_t cur = hooked.load(std::memory_order_relaxed);
+        while (hookedHere < cur && !hooked.compare_exchange_weak(cur, hookedHere)) {}
+        tierNear.fetch_add(nearHere, std::memory_order_relaxed);
+        tierMid.fetch_add(midHere, std::memory_order_relaxed);
+        tierMidSteered.fetch_add(midSteeredHere, std::memory_order_relaxed);
+        tierFar.fetch_add(farHere, std::memory_order_relaxed);
+    };
+    if (parallel) parallelFor(fish.count, 1024, updateRange);
+    else updateRange(0, fish.count);
+
+    // Respawns in grid order on the caller, so each sees the ones before it.
+    // Non-swimming fish sort after every cell, so only that tail is scanned.
+    std::vector<int> respawned;
+    for (int i = g_fishGrid.start[g_fishGrid.dim * g_fishGrid.dim]; i < fish.count; ++i) {
+        if (fish.state[i] == FishState::Respawning && fish.timer[i] > kRespawnDelay &&
+            respawnFish(fish, i, waterHeight, respawned)) {
+            respawned.push_back(i);
+        }
+    }
+
+    fishCaught += landed.load();
+    if (hooked.load() != ~0ull) {
+        const int i = static_cast<int>(hooked.load() & 0xffffffffu);
+        CounterRng rng(p.seed + 1u, fish.id[i], fish.frame); // apart from the update's draws
+        fish.state[i] = FishState::Fighting;
+        fish.timer[i] = 0.0f;
+        fish.fightDuration[i] = rng.uniform(0.9f, 1.4f);
+        rod.hasCaught = true;
+        // Do not add a strong ripple; fighting shouldn't disturb the water
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    FishStats &s = g_fishStats;
+    s.lodNear = tierNear.load();
+    s.lodMid = tierMid.load();
+    s.lodMidSteered = tierMidSteered.load();
+    s.lodFar = tierFar.load();
+    const int steered = s.lodNear + s.lodMidSteered;
+    s.avgNeighbours = steered > 0 ? static_cast<float>(neighbourSum.load()) / static_cast<float>(steered) : 0.0f;
+    s.gridMs = std::chrono::duration<float, std::milli>(gridEnd - start).count();
+    s.updateMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+    // Steer cost for the budget, in units of a full steer
+    const float units = static_cast<float>(steered) +
+                        static_cast<float>(s.lodMid - s.lodMidSteered) * kCoastCost +
+                        static_cast<float>(s.lodFar) * kCruiseCost;
+    if (units > 0.0f) {
+        const float ns = std::chrono::duration<float, std::nano>(end - gridEnd).count() / units;
+        g_fishNsPerSteer = g_fishNsPerSteer > 0.0f ? g_fishNsPerSteer * 0.9f + ns * 0.1f : ns;
+    }
+}
+
+const FishStats &fishStats() {
+    return g_fishStats;
+}
 
+int fishInstances(const FishSchool &fish, float *out) {
+    int n = 0;
+    for (int i = 0; i < fish.count; ++i) {
+        if (!fish.visible(i)) continue;
+        float *inst = out + static_cast<size_t>(n++) * kFishInstanceFloats;
+        inst[0] = fish.posX[i];
+        inst[1] = fish.posY[i];
+        inst[2] = fish.posZ[i];
+        inst[3] = (fish.yawDeg[i] + 180.0f) * (kPi / 180.0f); // mesh faces -x
+        inst[4] = std::clamp(-fish.yawVel[i] * 0.005f, -0.4f, 0.4f); // bank with turn
+        inst[5] = static_cast<float>(fish.id[i] % 1024u) * 2.39996323f; // golden-angle spread of tail phases
     }
+    return n;
 }
@@ -1,41 +1,102 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include "Math.hpp"
-#include "Boat.hpp"
 #include "Rod.hpp"
 
-struct Fish {
+// Fish school: boids-style steering (separation, alignment, cohesion) plus
+// obstacle avoidance, wander and the fishing-lure catch. Fish are kept as a
+// structure of arrays, and neighbours are found through a uniform grid over
+// the pond rebuilt every update, so each fish only looks at the few fish in
+// the cells around it.
+
+enum class FishState : uint8_t {
+    Swimming,
+    Fighting,   // hooked on the lure, wiggling until landed
+    Landed,     // caught, shown briefly before disappearing
+    Respawning, // hidden until the respawn delay passes
+};
+
+struct FishParams {
+    float bounds = 14.0f;         // half-extent of the XZ square the fish stay in
+    float swimSpeed = 1.2f;
+    float neighbourRadius = 1.5f; // alignment/cohesion reach; also the hash cell size
+    float separationRadius = 0.5f;
+    float separationWeight = 1.5f;
+    float alignmentWeight = 0.6f;
+    float cohesionWeight = 0.3f;
+    float avoidWeight = 4.0f;     // obstacles and the bounds
+    float turnRate = 270.0f;      // deg/s
+    int maxNeighbours = 12;       // dense shoals stop counting here so a query stays O(k)
+    float spawnSpacing = 1.0f;    // minimum gap at spawn and respawn; tightened if the count needs it
+    unsigned seed = 1750;         // placement, wander and respawn draws
+
+    // AI level of detail by distance to the camera or lure: near fish steer
+    // every frame; mid-range fish steer every 2..lodMaxSlice frames (with the
+    // elapsed time) and coast in between; far fish cruise on an analytic
+    // path with no neighbour queries.
+    bool lod = true;
+    float lodNearRadius = 14.0f;
+    float lodMidRadius = 40.0f;
+    int lodMaxSlice = 4;
+    // Target for a whole update. The scheduler picks the smallest slice that
+    // fits, and shrinks the radii while even lodMaxSlice overruns it. 0 = no
+    // budget: slice 2 and full radii, for reproducible runs.
+    float lodBudgetUs = 1000.0f;
+};
+
+struct FishSchool {
+    FishParams params;
+    int count = 0;
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velX, velZ; // depth follows a bob curve
+    std::vector<float> yawDeg, prevYawDeg, yawVel;
+    std::vector<float> timer;         // time in the current state
+    std::vector<float> fightDuration; // set when hooked
+    std::vector<float> lodDt;         // time since the fish last steered
+    std::vector<FishState> state;
+    std::vector<uint32_t> id; // stable across the per-update reorder; picks the random stream
+    uint64_t frame = 0;       // update counter, the other half of each fish's random stream
+    float spacing = 0.0f;     // gap initFish guaranteed, kept by respawns
+
+    Vec3 pos(int i) const { return Vec3(posX[i], posY[i], posZ[i]); }
+    bool visible(int i) const { return state[i] != FishState::Respawning; }
+};
+
+// Something the fish swim around (boat, cubes, an underwater player).
+struct FishObstacle {
     Vec3 pos;
-    Vec3 vel;
-    bool active;
-    float respawnTimer;
-    float yawDeg;
-    float prevYawDeg;
-    float yawVel;
-    bool caught;
-    float caughtTimer;
-    int state;          // 0 = idle, 1 = fighting (hooked)
-    float fightTimer;
-    float fightDuration;
-    bool catchCounted;
-    Fish()
-        : pos(),
-          vel(),
-          active(true),
-          respawnTimer(0.0f),
-          yawDeg(0.0f),
-          prevYawDeg(0.0f),
-          yawVel(0.0f),
-          caught(false),
-          caughtTimer(0.0f),
-          state(0),
-          fightTimer(0.0f),
-          fightDuration(0.0f),
-          catchCounted(false) {}
+    float radius = 1.0f;
 };
 
-void initFish(std::vector<Fish> &fish, int count, float waterHeight);
-void updateFish(std::vector<Fish> &fish, float dt, float timef, float waterHeight,
-                const Boat &boat, Rod &rod, const Vec3 &cubePos, const Vec3 &cube2Pos,
-                const Vec3 &playerPos, bool playerUnderwater, int &fishCaught);
+struct FishStats {
+    float updateMs = 0.0f;
+    float gridMs = 0.0f; // grid rebuild and reorder
+    int swimming = 0;
+    float avgNeighbours = 0.0f; // per fish that steered
+    // Swimming fish per LOD tier in the last update
+    int lodNear = 0;
+    int lodMid = 0;
+    int lodMidSteered = 0; // mid-range fish whose slice came up
+    int lodFar = 0;
+    int lodSlice = 1;       // mid-range steering period in frames
+    float lodScale = 1.0f;  // radius scale the budget has imposed
+};
+
+// Places the fish by Poisson-disk sampling, at least params.spawnSpacing
+// apart, or as far apart as count fish fit in the pond.
+void initFish(FishSchool &fish, int count, float waterHeight, const FishParams &params = FishParams());
+// Fish are updated in chunks across the worker pool (parallel = false keeps
+// everything on the caller). Every random draw comes from the fish's own
+// counter-based stream, so the result is bit-identical for any thread count.
+void updateFish(FishSchool &fish, float dt, float timef, float waterHeight, const Vec3 &viewPos,
+                const FishObstacle *obstacles, int obstacleCount, Rod &rod, int &fishCaught,
+                bool parallel = true);
+const FishStats &fishStats();
+
+// Per-instance render data of the visible fish, kFishInstanceFloats each:
+// (x, y, z, heading, bank, swim phase), angles in radians, heading as used
+// by Mat4::rotateY on the upright body. Returns the count written.
+constexpr int kFishInstanceFloats = 6;
+int fishInstances(const FishSchool &fish, float *out);
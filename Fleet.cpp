@@ -0,0 +1,389 @@
+#include "Fleet.hpp"
+#include "Parallel.hpp"
+#include "Stone.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// Hashed uniform grid over the boats (cells of avoidRadius), rebuilt every
+// step by a counting sort into a power-of-two bucket table. Harbours are
+// unbounded, so cells are hashed rather than stored densely; a query visits
+// the distinct buckets of the 3x3 cells around a boat and filters by
+// distance. Positions are snapshotted so steering within a step doesn't see
+// other boats' updates.
+struct FleetGrid {
+    float invCell = 1.0f;
+    uint32_t mask = 0;
+    std::vector<int> start; // mask + 2 entries
+    std::vector<int> items; // boat indices by bucket
+    std::vector<float> x, z, dirX, dirZ;
+};
+
+FleetGrid g_fleetGrid;
+FleetStats g_fleetStats;
+
+int cellCoord(float v, float invCell) {
+    return static_cast<int>(std::floor(v * invCell));
+}
+
+uint32_t cellBucket(int cx, int cz, uint32_t mask) {
+    return ((static_cast<uint32_t>(cx) * 73856093u) ^ (static_cast<uint32_t>(cz) * 19349663u)) & mask;
+}
+
+void buildFleetGrid(const Fleet &fleet) {
+    FleetGrid &g = g_fleetGrid;
+    g.invCell = 1.0f / fleet.params.avoidRadius;
+    uint32_t buckets = 16;
+    while (buckets < 2u * static_cast<uint32_t>(fleet.count)) buckets *= 2;
+    g.mask = buckets - 1;
+    g.start.assign(buckets + 1, 0);
+    g.items.resize(fleet.count);
+    g.x.assign(fleet.posX.begin(), fleet.posX.end());
+    g.z.assign(fleet.posZ.begin(), fleet.posZ.end());
+    g.dirX.resize(fleet.count);
+    g.dirZ.resize(fleet.count);
+
+    std::vector<uint32_t> bucketOf(fleet.count);
+    for (int i = 0; i < fleet.count; ++i) {
+        bucketOf[i] = cellBucket(cellCoord(g.x[i], g.invCell), cellCoord(g.z[i], g.invCell), g.mask);
+        g.start[bucketOf[i] + 1]++;
+        const float rad = (fleet.yawDeg[i] + 90.0f) * (kPi / 180.0f); // see boatForward
+        g.dirX[i] = std::cos(rad);
+        g.dirZ[i] = std::sin(rad);
+    }
+    for (uint32_t b = 0; b < buckets; ++b) g.start[b + 1] += g.start[b];
+    std::vector<int> fill(g.start.begin(), g.start.end() - 1);
+    for (int i = 0; i < fleet.count; ++i) g.items[fill[bucketOf[i]]++] = i;
+}
+
+// Calls fn(j) for every boat in the buckets of the 3x3 cells around (x, z),
+// each bucket once.
+template <class Fn>
+void forNearbyBoats(float x, float z, Fn &&fn) {
+    const FleetGrid &g = g_fleetGrid;
+    const int cx = cellCoord(x, g.invCell);
+    const int cz = cellCoord(z, g.invCell);
+    uint32_t seen[9];
+    int seenCount = 0;
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            const uint32_t b = cellBucket(cx + dx, cz + dz, g.mask);
+            if (std::find(seen, seen + seenCount, b) != seen + seenCount) continue;
+            seen[seenCount++] = b;
+            for (int k = g.start[b]; k < g.start[b + 1]; ++k) fn(g.items[k]);
+        }
+    }
+}
+
+float wrapDeg(float d) {
+    while (d > 180.0f) d -= 360.0f;
+    while (d < -180.0f) d += 360.0f;
+    return d;
+}
+
+// Next waypoint once the current one is reached: around a loop, or back
+// and forth along a patrol.
+void advanceWaypoint(const FleetRoute &route, int &waypoint, int &direction) {
+    const int n = static_cast<int>(route.waypoints.size());
+    if (n < 2) return;
+    if (route.loop) {
+        waypoint = (waypoint + 1) % n;
+        return;
+    }
+    if (waypoint + direction < 0 || waypoint + direction >= n) direction = -direction;
+    waypoint += direction;
+}
+
+// Waypoint seeking plus separation, then the XZ move, for one boat.
+void steerBoat(Fleet &fleet, int i, float dt) {
+    const FleetParams &p = fleet.params;
+    const FleetGrid &g = g_fleetGrid;
+    const FleetRoute &route = fleet.routes[fleet.route[i]];
+    const float x = g.x[i];
+    const float z = g.z[i];
+
+    Vec3 target = route.waypoints[fleet.waypoint[i]];
+    if ((target.x - x) * (target.x - x) + (target.z - z) * (target.z - z) < p.arriveRadius * p.arriveRadius) {
+        advanceWaypoint(route, fleet.waypoint[i], fleet.direction[i]);
+        target = route.waypoints[fleet.waypoint[i]];
+    }
+    float steerX = target.x - x;
+    float steerZ = target.z - z;
+    const float len = std::sqrt(steerX * steerX + steerZ * steerZ);
+    if (len > 1e-4f) {
+        steerX /= len;
+        steerZ /= len;
+    }
+
+    // Push away from close boats, and ease off behind one that is ahead
+    const float r2 = p.avoidRadius * p.avoidRadius;
+    float slow = 1.0f;
+    forNearbyBoats(x, z, [&](int j) {
+        if (j == i) return;
+        const float ox = g.x[j] - x;
+        const float oz = g.z[j] - z;
+        const float d2 = ox * ox + oz * oz;
+        if (d2 >= r2 || d2 < 1e-8f) return;
+        const float d = std::sqrt(d2);
+        const float w = (1.0f - d / p.avoidRadius) * p.avoidWeight;
+        steerX -= ox / d * w;
+        steerZ -= oz / d * w;
+        if ((ox * g.dirX[i] + oz * g.dirZ[i]) > 0.7f * d) {
+            slow = std::min(slow, std::max(0.2f, (d - 2.0f * p.boatRadius) / p.avoidRadius));
+        }
+    });
+
+    const float desiredYaw = std::atan2(steerZ, steerX) * 180.0f / kPi - 90.0f; // inverse of boatForward
+    const float maxTurn = p.turnRate * dt;
+    fleet.yawDeg[i] = wrapDeg(fleet.yawDeg[i] + std::clamp(wrapDeg(desiredYaw - fleet.yawDeg[i]), -maxTurn, maxTurn));
+
+    const float targetSpeed = p.cruiseSpeed * slow;
+    const float dv = std::clamp(targetSpeed - fleet.speed[i], -p.accel * dt, p.accel * dt);
+    fleet.speed[i] += dv;
+    const float rad = (fleet.yawDeg[i] + 90.0f) * (kPi / 180.0f);
+    fleet.posX[i] += std::cos(rad) * fleet.speed[i] * dt;
+    fleet.posZ[i] += std::sin(rad) * fleet.speed[i] * dt;
+}
+
+// Overlaps after the move: boat pairs separate equally and lose some speed;
+// outside bodies take half (through push). Runs on the caller in index
+// order. Returns the number of contacts.
+int resolveFleetContacts(Fleet &fleet, FleetContact *contacts, int contactCount) {
+    const FleetParams &p = fleet.params;
+    const float minDist = 2.0f * p.boatRadius;
+    int hits = 0;
+    for (int i = 0; i < fleet.count; ++i) {
+        forNearbyBoats(g_fleetGrid.x[i], g_fleetGrid.z[i], [&](int j) {
+            if (j <= i) return;
+            const float dx = fleet.posX[j] - fleet.posX[i];
+            const float dz = fleet.posZ[j] - fleet.posZ[i];
+            const float d2 = dx * dx + dz * dz;
+            if (d2 >= minDist * minDist || d2 < 1e-8f) return;
+            const float d = std::sqrt(d2);
+            const float half = 0.5f * (minDist - d) / d;
+            fleet.posX[i] -= dx * half;
+            fleet.posZ[i] -= dz * half;
+            fleet.posX[j] += dx * half;
+            fleet.posZ[j] += dz * half;
+            fleet.speed[i] *= 0.9f;
+            fleet.speed[j] *= 0.9f;
+            ++hits;
+        });
+        for (int c = 0; c < contactCount; ++c) {
+            FleetContact &body = contacts[c];
+            const float dx = body.pos.x - fleet.posX[i];
+            const float dz = body.pos.z - fleet.posZ[i];
+            const float reach = p.boatRadius + body.radius;
+            const float d2 = dx * dx + dz * dz;
+            if (d2 >= reach * reach || d2 < 1e-8f) continue;
+            const float d = std::sqrt(d2);
+            const float half = 0.5f * (reach - d) / d;
+            fleet.posX[i] -= dx * half;
+            fleet.posZ[i] -= dz * half;
+            // Later steps in this update see the reduced overlap
+            const Vec3 delta(dx * half, 0.0f, dz * half);
+            body.pos += delta;
+            body.push += delta;
+            fleet.speed[i] *= 0.9f;
+            ++hits;
+        }
+    }
+    return hits;
+}
+
+float routeLength(const FleetRoute &route, int &segments) {
+    const int n = static_cast<int>(route.waypoints.size());
+    segments = route.loop ? n : n - 1;
+    float total = 0.0f;
+    for (int s = 0; s < segments; ++s) {
+        total += length(route.waypoints[(s + 1) % n] - route.waypoints[s]);
+    }
+    return total;
+}
+
+} // namespace
+
+void clearFleet(Fleet &fleet) {
+    fleet.routes.clear();
+    fleet.count = 0;
+    for (std::vector<float> *v : {&fleet.posX, &fleet.posY, &fleet.posZ, &fleet.yawDeg, &fleet.speed,
+                                  &fleet.velY, &fleet.pitch, &fleet.pitchVel, &fleet.roll, &fleet.rollVel,
+                                  &fleet.prevX, &fleet.prevY, &fleet.prevZ, &fleet.prevYawDeg,
+                                  &fleet.prevPitch, &fleet.prevRoll, &fleet.wakeTimer}) {
+        v->clear();
+    }
+    fleet.route.clear();
+    fleet.waypoint.clear();
+    fleet.direction.clear();
+    fleet.stepTime = 0.0f;
+    fleet.started = false;
+}
+
+int addFleetRoute(Fleet &fleet, const FleetRoute &route) {
+    fleet.routes.push_back(route);
+    return static_cast<int>(fleet.routes.size()) - 1;
+}
+
+int spawnFleetBoat(Fleet &fleet, int route, float along, float waterHeight) {
+    const FleetRoute &r = fleet.routes[route];
+    const int n = static_cast<int>(r.waypoints.size());
+    int segments = 0;
+    const float total = routeLength(r, segments);
+
+    // Walk the polyline to the requested distance
+    float remaining = std::clamp(along, 0.0f, 1.0f) * total;
+    int seg = 0;
+    for (; seg < segments - 1; ++seg) {
+        const float segLen = length(r.waypoints[(seg + 1) % n] - r.waypoints[seg]);
+        if (remaining <= segLen) break;
+        remaining -= segLen;
+    }
+    const Vec3 a = r.waypoints[seg];
+    const Vec3 b = r.waypoints[(seg + 1) % n];
+    const float segLen = std::max(length(b - a), 1e-4f);
+    const Vec3 pos = a + (b - a) * std::min(remaining / segLen, 1.0f);
+
+    const int i = fleet.count++;
+    fleet.posX.push_back(pos.x);
+    fleet.posY.push_back(waterHeight + 0.05f);
+    fleet.posZ.push_back(pos.z);
+    fleet.yawDeg.push_back(std::atan2(b.z - a.z, b.x - a.x) * 180.0f / kPi - 90.0f);
+    fleet.speed.push_back(fleet.params.cruiseSpeed);
+    for (std::vector<float> *v : {&fleet.velY, &fleet.pitch, &fleet.pitchVel, &fleet.roll, &fleet.rollVel}) {
+        v->push_back(0.0f);
+    }
+    fleet.prevX.push_back(fleet.posX[i]);
+    fleet.prevY.push_back(fleet.posY[i]);
+    fleet.prevZ.push_back(fleet.posZ[i]);
+    fleet.prevYawDeg.push_back(fleet.yawDeg[i]);
+    fleet.prevPitch.push_back(0.0f);
+    fleet.prevRoll.push_back(0.0f);
+    fleet.wakeTimer.push_back(fleet.params.wakeInterval * static_cast<float>(i % 7) / 7.0f); // staggered
+    fleet.route.push_back(route);
+    fleet.waypoint.push_back((seg + 1) % n);
+    fleet.direction.push_back(1);
+    return i;
+}
+
+void initFleet(Fleet &fleet, int count, float innerRadius, float outerRadius, float waterHeight,
+               const FleetParams &params) {
+    clearFleet(fleet);
+    fleet.params = params;
+
+    // Rings every 15 m, alternating direction, and radial patrol lanes
+    // roughly 40 m apart around the middle ring
+    const float spacing = 15.0f;
+    const int rings = std::max(1, static_cast<int>((outerRadius - innerRadius) / spacing) + 1);
+    for (int k = 0; k < rings; ++k) {
+        const float radius = rings == 1 ? 0.5f * (innerRadius + outerRadius)
+                                        : innerRadius + (outerRadius - innerRadius) * k / (rings - 1);
+        FleetRoute ring;
+        const int points = std::max(8, static_cast<int>(2.0f * kPi * radius / 10.0f));
+        for (int w = 0; w < points; ++w) {
+            const float a = 2.0f * kPi * w / points * (k % 2 == 0 ? 1.0f : -1.0f);
+            ring.waypoints.push_back(Vec3(radius * std::cos(a), 0.0f, radius * std::sin(a)));
+        }
+        addFleetRoute(fleet, ring);
+    }
+    const int lanes = std::max(2, static_cast<int>(kPi * (innerRadius + outerRadius) / 40.0f));
+    for (int k = 0; k < lanes; ++k) {
+        const float a = 2.0f * kPi * (k + 0.5f) / lanes;
+        FleetRoute lane;
+        lane.loop = false;
+        for (float r = innerRadius; r <= outerRadius + 1e-3f; r += 10.0f) {
+            lane.waypoints.push_back(Vec3(r * std::cos(a), 0.0f, r * std::sin(a)));
+        }
+        if (lane.waypoints.size() < 2) {
+            lane.waypoints.push_back(Vec3(outerRadius * std::cos(a), 0.0f, outerRadius * std::sin(a)));
+        }
+        addFleetRoute(fleet, lane);
+    }
+
+    // Boats round-robin over the routes, evenly spread along each
+    const int routes = static_cast<int>(fleet.routes.size());
+    for (int i = 0; i < count; ++i) {
+        const int route = i % routes;
+        const int onRoute = (count - route + routes - 1) / routes;
+        spawnFleetBoat(fleet, route, (static_cast<float>(i / routes) + 0.5f) / static_cast<float>(onRoute),
+                       waterHeight);
+    }
+}
+
+void updateFleet(Fleet &fleet, float dt, float waterHeight, float time, const Vec3 &focus,
+                 FleetContact *contacts, int contactCount, bool parallel) {
+    const auto start = std::chrono::steady_clock::now();
+    const FleetParams &p = fleet.params;
+    const float step = 1.0f / kBoatStepHz;
+    const HullArrays hull = {fleet.posX.data(), fleet.posY.data(), fleet.posZ.data(),
+                             fleet.yawDeg.data(), fleet.speed.data(), fleet.velY.data(),
+                             fleet.pitch.data(), fleet.pitchVel.data(), fleet.roll.data(),
+                             fleet.rollVel.data()};
+
+    // As updateBoat, the simulation starts at the first update's time, so
+    // the step grid doesn't depend on the frame rate
+    const int steps = fleet.started && fleet.count > 0 ? takeFixedSteps(fleet.stepTime, dt) : 0;
+    fleet.started = true;
+    int hits = 0;
+    for (int k = 0; k < steps; ++k) {
+        fleet.prevX = fleet.posX;
+        fleet.prevY = fleet.posY;
+        fleet.prevZ = fleet.posZ;
+        fleet.prevYawDeg = fleet.yawDeg;
+        fleet.prevPitch = fleet.pitch;
+        fleet.prevRoll = fleet.roll;
+        buildFleetGrid(fleet);
+
+        const float stepEnd = time - fleet.stepTime - static_cast<float>(steps - 1 - k) * step;
+        auto stepRange = [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) steerBoat(fleet, i, step);
+            stepHulls(hull, begin, end, step, waterHeight, stepEnd);
+        };
+        if (parallel) parallelFor(fleet.count, 64, stepRange);
+        else stepRange(0, fleet.count);
+
+        hits += resolveFleetContacts(fleet, contacts, contactCount);
+    }
+
+    // Wakes at the stern, paced by speed, only where someone can see them
+    int wakes = 0;
+    const float range2 = p.wakeRange * p.wakeRange;
+    for (int i = 0; i < fleet.count; ++i) {
+        fleet.wakeTimer[i] -= dt * std::fabs(fleet.speed[i]) / p.cruiseSpeed;
+        if (fleet.wakeTimer[i] > 0.0f) continue;
+        fleet.wakeTimer[i] += p.wakeInterval;
+        const float dx = fleet.posX[i] - focus.x;
+        const float dz = fleet.posZ[i] - focus.z;
+        if (dx * dx + dz * dz > range2 || wakes >= p.maxWakesPerUpdate) continue;
+        const float rad = (fleet.yawDeg[i] + 90.0f) * (kPi / 180.0f);
+        addRipple(Vec3(fleet.posX[i] - std::cos(rad) * p.boatRadius, waterHeight,
+                       fleet.posZ[i] - std::sin(rad) * p.boatRadius),
+                  time, p.wakeRadius);
+        ++wakes;
+    }
+
+    FleetStats &s = g_fleetStats;
+    s.boats = fleet.count;
+    s.steps = steps;
+    s.contacts = hits;
+    s.wakes = wakes;
+    s.updateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const FleetStats &fleetStats() {
+    return g_fleetStats;
+}
+
+BoatPose fleetBoatPose(const Fleet &fleet, int i) {
+    const float t = fleet.stepTime * kBoatStepHz;
+    BoatPose pose;
+    pose.pos = Vec3(fleet.prevX[i] + (fleet.posX[i] - fleet.prevX[i]) * t,
+                    fleet.prevY[i] + (fleet.posY[i] - fleet.prevY[i]) * t,
+                    fleet.prevZ[i] + (fleet.posZ[i] - fleet.prevZ[i]) * t);
+    pose.yawDeg = fleet.prevYawDeg[i] + wrapDeg(fleet.yawDeg[i] - fleet.prevYawDeg[i]) * t;
+    pose.pitch = fleet.prevPitch[i] + (fleet.pitch[i] - fleet.prevPitch[i]) * t;
+    pose.roll = fleet.prevRoll[i] + (fleet.roll[i] - fleet.prevRoll[i]) * t;
+    return pose;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include "Boat.hpp"
+#include "Math.hpp"
+
+// AI boat traffic: boats following waypoint routes, kept as a structure of
+// arrays and advanced in the player boat's fixed steps (kBoatStepHz). Each
+// step steers every boat toward its next waypoint and away from the boats
+// around it (found through a hashed uniform grid), floats the hulls in
+// batches (stepHulls) across the worker pool, then resolves collisions with
+// each other and with outside bodies on the caller. Boats near the focus
+// leave wakes in the ripple field.
+
+struct FleetRoute {
+    std::vector<Vec3> waypoints; // XZ used
+    bool loop = true;            // false: patrol back and forth
+};
+
+struct FleetParams {
+    float cruiseSpeed = 5.0f;
+    float accel = 2.0f;         // m/s^2 toward the target speed
+    float turnRate = 40.0f;     // deg/s
+    float arriveRadius = 3.0f;  // waypoint reached within this
+    float boatRadius = 1.5f;    // collision disk, as the player's boat
+    float avoidRadius = 6.0f;   // steer away and slow down within this; also the grid cell
+    float avoidWeight = 2.0f;
+    float wakeInterval = 0.5f;  // seconds between wake ripples at cruise speed
+    float wakeRadius = 6.0f;
+    float wakeRange = 60.0f;    // only boats this close to the focus make wakes
+    int maxWakesPerUpdate = 8;  // leave the ripple pool to stones and the player
+};
+
+// A body the boats collide with but don't own: the player's boat, floating
+// cubes. The fleet yields half of each overlap and moves pos by the other
+// half, summed in push for the caller to apply to bodies that can move.
+struct FleetContact {
+    Vec3 pos;
+    float radius = 1.0f;
+    Vec3 push;
+};
+
+struct Fleet {
+    FleetParams params;
+    std::vector<FleetRoute> routes;
+    int count = 0;
+    std::vector<float> posX, posY, posZ, yawDeg, speed;
+    std::vector<float> velY, pitch, pitchVel, roll, rollVel;
+    // State at the start of the last step, for interpolated rendering
+    std::vector<float> prevX, prevY, prevZ, prevYawDeg, prevPitch, prevRoll;
+    std::vector<float> wakeTimer;
+    std::vector<int> route, waypoint;
+    std::vector<int> direction; // +1 / -1 along a patrol route
+    float stepTime = 0.0f;      // time not yet simulated, at most one step
+    bool started = false;       // the first update only starts the step clock
+};
+
+struct FleetStats {
+    float updateMs = 0.0f;
+    int boats = 0;
+    int steps = 0;    // fixed steps in the last update
+    int contacts = 0; // overlapping pairs resolved, boat-boat and boat-body
+    int wakes = 0;
+};
+
+// Lays out loop routes (rings, alternating direction) and patrol lanes
+// (radial, crossing the rings) in the annulus innerRadius..outerRadius around
+// the origin, and spreads count boats along them.
+void initFleet(Fleet &fleet, int count, float innerRadius, float outerRadius, float waterHeight,
+               const FleetParams &params = FleetParams());
+void clearFleet(Fleet &fleet);
+int addFleetRoute(Fleet &fleet, const FleetRoute &route);
+// A boat on route at fraction along (0..1) of its length, heading onward.
+int spawnFleetBoat(Fleet &fleet, int route, float along, float waterHeight);
+
+// Advances by dt in fixed steps. parallel = false keeps everything on the
+// caller.
+void updateFleet(Fleet &fleet, float dt, float waterHeight, float time, const Vec3 &focus,
+                 FleetContact *contacts, int contactCount, bool parallel = true);
+const FleetStats &fleetStats();
+BoatPose fleetBoatPose(const Fleet &fleet, int i); // interpolated between the last two steps
@@ -218,6 +218,34 @@ Framebuffer makeLdrBuffer(int width, int height) {
     return fb;
 }
 
+Framebuffer makeRippleBuffer(int size) {
+    Framebuffer fb{};
+    fb.width = size;
+    fb.height = size;
+
+    glGenFramebuffers(1, &fb.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fb.fbo);
+
+    glGenTextures(1, &fb.colorTex);
+    glBindTexture(GL_TEXTURE_2D, fb.colorTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, size, size, 0,
+                 GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, fb.colorTex, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Ripple framebuffer is incomplete");
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return fb;
+}
+
 void destroyFramebuffer(Framebuffer &fb) {
     if (fb.depthRbo) glDeleteRenderbuffers(1, &fb.depthRbo);
     if (fb.depthTex) glDeleteTextures(1, &fb.depthTex);
@@ -325,6 +353,28 @@ GLuint createDudvTexture(int size) {
     return tex;
 }
 
+GLuint createSimulationTexture(int size) {
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, size, size, 0,
+                 GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+void uploadSimulationTexture(GLuint tex, int size, const float *rgba, bool mipmaps) {
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_FLOAT, rgba);
+    if (mipmaps) glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 GLuint loadTexture2D(const std::string &path, bool flipY) {
     stbi_set_flip_vertically_on_load(flipY ? 1 : 0);
     int width = 0, height = 0, channels = 0;
@@ -23,6 +23,8 @@ Framebuffer makeSceneBuffer(int width, int height);
 Framebuffer makeHdrBuffer(int width, int height);
 Framebuffer makeBloomBuffer(int width, int height);
 Framebuffer makeLdrBuffer(int width, int height);
+// Square RGBA16F target for the additive ripple splats (no depth).
+Framebuffer makeRippleBuffer(int size);
 void destroyFramebuffer(Framebuffer &fb);
 
 struct ShadowMap {
@@ -37,4 +39,7 @@ void destroyShadowMap(ShadowMap &sm);
 
 GLuint createWaterNormalMap(int size, float freq);
 GLuint createDudvTexture(int size);
+// Repeat-wrapped RGBA16F texture refreshed from the CPU every frame (FFT ocean maps).
+GLuint createSimulationTexture(int size);
+void uploadSimulationTexture(GLuint tex, int size, const float *rgba, bool mipmaps);
 GLuint loadTexture2D(const std::string &path, bool flipY = true);
@@ -1,12 +1,13 @@
 #include "Mesh.hpp"
-#include <fstream>
-#include <sstream>
-#include <stdexcept>
+#include "MeshCache.hpp"
+#include <algorithm>
+#include <cmath>
 
 Mesh makeMesh(const std::vector<float> &interleavedPosNormal, bool hasTexcoord) {
     Mesh mesh{};
     const int stride = hasTexcoord ? 8 : 6;
     mesh.vertexCount = static_cast<GLsizei>(interleavedPosNormal.size() / stride);
+    mesh.vertexStride = static_cast<GLsizei>(stride * sizeof(float));
     glGenVertexArrays(1, &mesh.vao);
     glGenBuffers(1, &mesh.vbo);
 
@@ -32,12 +33,151 @@ Mesh makeMesh(const std::vector<float> &interleavedPosNormal, bool hasTexcoord)
     return mesh;
 }
 
+Mesh makeIndexedMesh(const std::vector<float> &interleavedPosNormal,
+                     const std::vector<GLuint> &indices, bool hasTexcoord) {
+    Mesh mesh = makeMesh(interleavedPosNormal, hasTexcoord);
+    mesh.indexCount = static_cast<GLsizei>(indices.size());
+    glBindVertexArray(mesh.vao);
+    glGenBuffers(1, &mesh.ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint),
+                 indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    return mesh;
+}
+
+namespace {
+
+GLenum glAttribType(VertexAttribType type) {
+    switch (type) {
+    case VertexAttribType::UNorm16: return GL_UNSIGNED_SHORT;
+    case VertexAttribType::Int2_10_10_10: return GL_INT_2_10_10_10_REV;
+    case VertexAttribType::Float32: break;
+    }
+    return GL_FLOAT;
+}
+
+void setMeshDecode(const MeshDecodeUniforms &decode, const Mesh &m) {
+    glUniform1i(decode.quantized, 1);
+    glUniform3f(decode.posOffset, m.posOffset.x, m.posOffset.y, m.posOffset.z);
+    glUniform3f(decode.posScale, m.posScale.x, m.posScale.y, m.posScale.z);
+}
+
+MeshLod lodRange(const Mesh &m, int lod) {
+    if (m.lodCount == 0) return MeshLod{0, static_cast<uint32_t>(m.indexCount), 0.0f};
+    return m.lods[std::min(std::max(lod, 0), m.lodCount - 1)];
+}
+
+const void *indexByteOffset(const MeshLod &range) {
+    return reinterpret_cast<const void *>(static_cast<uintptr_t>(range.indexOffset) * sizeof(GLuint));
+}
+
+} // namespace
+
+size_t meshBytes(const Mesh &m) {
+    return static_cast<size_t>(m.vertexCount) * m.vertexStride + static_cast<size_t>(m.indexCount) * sizeof(GLuint);
+}
+
+Mesh makeCachedMesh(const MeshCacheView &view) {
+    Mesh mesh{};
+    mesh.vertexCount = static_cast<GLsizei>(view.vertexCount);
+    mesh.indexCount = static_cast<GLsizei>(view.indexCount);
+    mesh.vertexStride = static_cast<GLsizei>(view.layout.stride);
+    mesh.lodCount = static_cast<int>(view.lodCount);
+    std::copy_n(view.lods, view.lodCount, mesh.lods);
+    if (view.format == VertexFormat::Quantized) {
+        mesh.quantized = true;
+        mesh.posOffset = view.boundsMin;
+        mesh.posScale = view.boundsMax - view.boundsMin;
+    }
+    glGenVertexArrays(1, &mesh.vao);
+    glGenBuffers(1, &mesh.vbo);
+    glGenBuffers(1, &mesh.ebo);
+
+    glBindVertexArray(mesh.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(view.vertexCount) * view.layout.stride,
+                 view.vertices, GL_STATIC_DRAW);
+    for (uint32_t a = 0; a < view.layout.attribCount; ++a) {
+        const VertexAttrib &attrib = view.layout.attribs[a];
+        glVertexAttribPointer(attrib.location, attrib.components, glAttribType(attrib.type),
+                              attrib.normalized ? GL_TRUE : GL_FALSE,
+                              static_cast<GLsizei>(view.layout.stride),
+                              reinterpret_cast<void *>(static_cast<uintptr_t>(attrib.offset)));
+        glEnableVertexAttribArray(attrib.location);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(view.indexCount) * sizeof(GLuint),
+                 view.indices, GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    return mesh;
+}
+
 void destroyMesh(Mesh &m) {
+    if (m.ebo) glDeleteBuffers(1, &m.ebo);
     if (m.vbo) glDeleteBuffers(1, &m.vbo);
     if (m.vao) glDeleteVertexArrays(1, &m.vao);
     m = Mesh{};
 }
 
+void drawMesh(const Mesh &m, int lod) {
+    if (m.indexCount > 0) {
+        const MeshLod range = lodRange(m, lod);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_INT, indexByteOffset(range));
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, m.vertexCount);
+    }
+}
+
+void drawMeshInstanced(const Mesh &m, GLsizei instances, int lod) {
+    if (m.indexCount > 0) {
+        const MeshLod range = lodRange(m, lod);
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_INT,
+                                indexByteOffset(range), instances);
+    } else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, m.vertexCount, instances);
+    }
+}
+
+int selectMeshLod(const Mesh &m, float pixelsPerUnit, float maxPixelError) {
+    for (int lod = m.lodCount - 1; lod > 0; --lod) {
+        if (m.lods[lod].error * pixelsPerUnit <= maxPixelError) return lod;
+    }
+    return 0;
+}
+
+MeshDecodeUniforms meshDecodeUniforms(GLuint program) {
+    return MeshDecodeUniforms{
+        glGetUniformLocation(program, "uQuantized"),
+        glGetUniformLocation(program, "uPosOffset"),
+        glGetUniformLocation(program, "uPosScale"),
+    };
+}
+
+void drawMesh(const Mesh &m, const MeshDecodeUniforms &decode, int lod) {
+    if (!m.quantized) {
+        drawMesh(m, lod);
+        return;
+    }
+    setMeshDecode(decode, m);
+    drawMesh(m, lod);
+    glUniform1i(decode.quantized, 0);
+}
+
+void drawMeshInstanced(const Mesh &m, GLsizei instances, const MeshDecodeUniforms &decode, int lod) {
+    if (!m.quantized) {
+        drawMeshInstanced(m, instances, lod);
+        return;
+    }
+    setMeshDecode(decode, m);
+    drawMeshInstanced(m, instances, lod);
+    glUniform1i(decode.quantized, 0);
+}
+
 Mesh makeGroundMesh(float halfSize) {
     std::vector<float> groundData = {
         -halfSize, 0.0f, -halfSize, 0, 1, 0,
@@ -51,6 +191,91 @@ Mesh makeGroundMesh(float halfSize) {
     return makeMesh(groundData);
 }
 
+int clipmapVertexCount(const ClipmapDesc &desc) {
+    const int g = desc.gridSize;
+    const int ring = (g + 1) * (g + 1) - (g / 2) * (g / 2); // grid minus the hole's inner vertices
+    const int trim = 2 * g * 4;                              // hole-border cells, 4 vertices each
+    return (g + 1) * (g + 1) + (desc.levels - 1) * (ring + trim);
+}
+
+float clipmapExtent(const ClipmapDesc &desc) {
+    return 0.5f * desc.gridSize * desc.baseCell * static_cast<float>(1 << (desc.levels - 1));
+}
+
+ClipmapDesc clipmapForBudget(int vertexBudget, float baseCell, float coverage) {
+    ClipmapDesc desc;
+    desc.baseCell = baseCell;
+    for (int levels = 1; levels <= 12; ++levels) {
+        desc.levels = levels;
+        desc.gridSize = 8;
+        while (true) {
+            ClipmapDesc bigger = desc;
+            bigger.gridSize += 4;
+            if (clipmapVertexCount(bigger) > vertexBudget) break;
+            desc = bigger;
+        }
+        if (clipmapExtent(desc) >= coverage) break;
+    }
+    return desc;
+}
+
+Mesh makeClipmapMesh(const ClipmapDesc &desc) {
+    const int g = desc.gridSize;
+    const int h = g / 2;
+    const int q = g / 4;
+    const int side = g + 1;
+    std::vector<float> verts;
+    std::vector<GLuint> indices;
+    verts.reserve(static_cast<size_t>(clipmapVertexCount(desc)) * 8);
+    std::vector<GLuint> slot(static_cast<size_t>(side) * side);
+    auto addVertex = [&](int x, int z, int level, bool trim, int cellX, int cellZ) {
+        const GLuint index = static_cast<GLuint>(verts.size() / 8);
+        verts.insert(verts.end(), {static_cast<float>(x), 0.0f, static_cast<float>(z),
+                                   static_cast<float>(level), trim ? 1.0f : 0.0f, 0.0f,
+                                   static_cast<float>(cellX), static_cast<float>(cellZ)});
+        return index;
+    };
+    // Same winding as makeGroundMesh (counter-clockwise seen from above).
+    auto addCell = [&](GLuint a, GLuint b, GLuint c, GLuint d) {
+        indices.insert(indices.end(), {a, c, d, a, d, b});
+    };
+
+    for (int level = 0; level < desc.levels; ++level) {
+        // Level L's hole holds level L-1, which sits at cell offset 0 or 1 per
+        // axis depending on the eye, so the hole is one cell wider: cells
+        // [-q, q] per axis. Its border cells are trim, collapsed in the shader
+        // wherever the finer level covers them.
+        auto cellInHole = [&](int i, int j) {
+            return level > 0 && i >= -q && i <= q && j >= -q && j <= q;
+        };
+        auto vertexInHole = [&](int i, int j) {
+            return level > 0 && i > -q && i <= q && j > -q && j <= q;
+        };
+        for (int j = -h; j <= h; ++j) {
+            for (int i = -h; i <= h; ++i) {
+                if (vertexInHole(i, j)) continue;
+                slot[static_cast<size_t>(j + h) * side + (i + h)] = addVertex(i, j, level, false, 0, 0);
+            }
+        }
+        auto at = [&](int i, int j) { return slot[static_cast<size_t>(j + h) * side + (i + h)]; };
+        for (int j = -h; j < h; ++j) {
+            for (int i = -h; i < h; ++i) {
+                if (cellInHole(i, j)) continue;
+                addCell(at(i, j), at(i + 1, j), at(i, j + 1), at(i + 1, j + 1));
+            }
+        }
+        if (level == 0) continue;
+        for (int j = -q; j <= q; ++j) {
+            for (int i = -q; i <= q; ++i) {
+                if (i != -q && i != q && j != -q && j != q) continue;
+                addCell(addVertex(i, j, level, true, i, j), addVertex(i + 1, j, level, true, i, j),
+                        addVertex(i, j + 1, level, true, i, j), addVertex(i + 1, j + 1, level, true, i, j));
+            }
+        }
+    }
+    return makeIndexedMesh(verts, indices, true);
+}
+
 Mesh makeCubeMesh() {
     std::vector<float> cubeData = {
         // +X
@@ -99,78 +324,8 @@ Mesh makeCubeMesh() {
     return makeMesh(cubeData);
 }
 
-Mesh loadObjMesh(const std::string &path) {
-    std::ifstream in(path);
-    if (!in) {
-        throw std::runtime_error("Failed to open OBJ: " + path);
-    }
-    std::vector<Vec3> positions;
-    std::vector<Vec3> normals;
-    std::vector<Vec2> uvs;
-    std::vector<float> verts;
-
-    auto pushVertex = [&](int vIdx, int nIdx, int tIdx) {
-        Vec3 p = positions.at(vIdx - 1);
-        Vec3 n = nIdx > 0 ? normals.at(nIdx - 1) : Vec3(0.0f, 1.0f, 0.0f);
-        Vec2 uv(0.0f, 0.0f);
-        if (tIdx > 0 && tIdx - 1 < static_cast<int>(uvs.size())) {
-            uv = uvs[tIdx - 1];
-        }
-        verts.push_back(p.x); verts.push_back(p.y); verts.push_back(p.z);
-        verts.push_back(n.x); verts.push_back(n.y); verts.push_back(n.z);
-        verts.push_back(uv.x); verts.push_back(uv.y);
-    };
-
-    std::string line;
-    while (std::getline(in, line)) {
-        if (line.empty() || line[0] == '#') continue;
-        std::istringstream iss(line);
-        std::string tag;
-        iss >> tag;
-        if (tag == "v") {
-            Vec3 p;
-            iss >> p.x >> p.y >> p.z;
-            positions.push_back(p);
-        } else if (tag == "vn") {
-            Vec3 n;
-            iss >> n.x >> n.y >> n.z;
-            normals.push_back(normalize(n));
-        } else if (tag == "vt") {
-            Vec2 t;
-            iss >> t.x >> t.y;
-            uvs.push_back(t);
-        } else if (tag == "f") {
-            std::vector<std::string> f;
-            std::string token;
-            while (iss >> token) f.push_back(token);
-            auto parseTriplet = [&](const std::string &s, int &vIdx, int &tIdx, int &nIdx) {
-                vIdx = nIdx = tIdx = 0;
-                size_t firstSlash = s.find('/');
-                size_t secondSlash = s.find('/', firstSlash + 1);
-                vIdx = std::stoi(s.substr(0, firstSlash));
-                if (secondSlash != std::string::npos && secondSlash > firstSlash) {
-                    std::string tstr = s.substr(firstSlash + 1, secondSlash - firstSlash - 1);
-                    if (!tstr.empty()) tIdx = std::stoi(tstr);
-                    std::string nstr = s.substr(secondSlash + 1);
-                    if (!nstr.empty()) nIdx = std::stoi(nstr);
-                }
-            };
-            auto emitTri = [&](int a, int b, int c, int ta, int tb, int tc, int na, int nb, int nc) {
-                pushVertex(a, na, ta);
-                pushVertex(b, nb, tb);
-                pushVertex(c, nc, tc);
-            };
-            if (f.size() == 3) {
-                int v[3], t[3], n[3];
-                for (int i = 0; i < 3; ++i) parseTriplet(f[i], v[i], t[i], n[i]);
-                emitTri(v[0], v[1], v[2], t[0], t[1], t[2], n[0], n[1], n[2]);
-            } else if (f.size() == 4) {
-                int v[4], t[4], n[4];
-                for (int i = 0; i < 4; ++i) parseTriplet(f[i], v[i], t[i], n[i]);
-                emitTri(v[0], v[1], v[2], t[0], t[1], t[2], n[0], n[1], n[2]);
-                emitTri(v[0], v[2], v[3], t[0], t[2], t[3], n[0], n[2], n[3]);
-            }
-        }
-    }
-    return makeMesh(verts, true);
+Mesh loadObjMesh(const std::string &path, VertexFormat format) {
+    MeshCacheFile cache;
+    loadMeshCache(path, meshCachePath(path), format, cache);
+    return makeCachedMesh(cache.view);
 }
@@ -4,16 +4,78 @@
 #include <string>
 #include "GL/glew.h"
 #include "Math.hpp"
+#include "MeshCache.hpp"
 
 struct Mesh {
     GLuint vao = 0;
     GLuint vbo = 0;
+    GLuint ebo = 0;          // only for indexed meshes
     GLsizei vertexCount = 0;
+    GLsizei indexCount = 0;  // draw with glDrawElements when non-zero; all LODs
+    GLsizei vertexStride = 0; // bytes
+    // VertexFormat::Quantized: positions decode to posOffset + aPos * posScale
+    bool quantized = false;
+    Vec3 posOffset;
+    Vec3 posScale;
+    // Loaded models: LOD index ranges, finest first. 0: one level, all of
+    // the indices.
+    int lodCount = 0;
+    MeshLod lods[kMaxMeshLods];
 };
 
+// Vertex and index buffer bytes.
+size_t meshBytes(const Mesh &m);
+
 Mesh makeMesh(const std::vector<float> &interleavedPosNormal, bool hasTexcoord = false);
+Mesh makeIndexedMesh(const std::vector<float> &interleavedPosNormal,
+                     const std::vector<GLuint> &indices, bool hasTexcoord = false);
+// Uploads a mapped .wmesh as it is, with its own vertex layout.
+Mesh makeCachedMesh(const MeshCacheView &view);
 void destroyMesh(Mesh &m);
+// GL_TRIANGLES with the mesh's VAO bound: glDrawElements for indexed meshes,
+// glDrawArrays otherwise. lod is clamped to the mesh's coarsest.
+void drawMesh(const Mesh &m, int lod = 0);
+void drawMeshInstanced(const Mesh &m, GLsizei instances, int lod = 0);
+// Coarsest LOD whose simplification error stays within maxPixelError on
+// screen, where one model unit covers pixelsPerUnit pixels.
+int selectMeshLod(const Mesh &m, float pixelsPerUnit, float maxPixelError);
+
+// Decode uniforms of a program that can draw quantized meshes
+// (simple.vshader, shadow.vshader). The overloads below set them for a
+// quantized mesh and clear uQuantized again after the draw, so every other
+// mesh draws as plain floats.
+struct MeshDecodeUniforms {
+    GLint quantized = -1;
+    GLint posOffset = -1;
+    GLint posScale = -1;
+};
+MeshDecodeUniforms meshDecodeUniforms(GLuint program);
+void drawMesh(const Mesh &m, const MeshDecodeUniforms &decode, int lod = 0);
+void drawMeshInstanced(const Mesh &m, GLsizei instances, const MeshDecodeUniforms &decode, int lod = 0);
 
 Mesh makeGroundMesh(float halfSize);
 Mesh makeCubeMesh();
-Mesh loadObjMesh(const std::string &path);
+// Indexed: corners deduplicated, then reordered by optimizeMesh, with
+// buildMeshLods' LODs. Served from the model's .wmesh cache when current,
+// which is written otherwise.
+Mesh loadObjMesh(const std::string &path, VertexFormat format = VertexFormat::Quantized);
+
+// Camera-centred nested-ring water grid (geometry clipmap), drawn in one
+// call. Level 0 is gridSize x gridSize cells of baseCell metres; each further
+// level doubles the cell size and rings the previous one. Every level snaps
+// to its own lattice in water.vshader, so vertices never swim; the trim cells
+// around each hole and a CDLOD morph at each level's rim keep the seams
+// watertight. Vertices hold grid coordinates, not positions: aPos.xz = grid
+// coords within the level, aNormal = (level, trim flag, 0), aTexcoord =
+// owning cell of trim vertices.
+struct ClipmapDesc {
+    float baseCell = 0.1f;
+    int gridSize = 64; // cells per side per level, multiple of 4
+    int levels = 6;
+};
+
+// Largest grid that fits vertexBudget while still reaching coverage metres.
+ClipmapDesc clipmapForBudget(int vertexBudget, float baseCell, float coverage);
+int clipmapVertexCount(const ClipmapDesc &desc);
+float clipmapExtent(const ClipmapDesc &desc); // half-size of the outermost level
+Mesh makeClipmapMesh(const ClipmapDesc &desc);
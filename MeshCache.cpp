@@ -0,0 +1,258 @@
+#include "MeshCache.hpp"
+#include "MeshOptimize.hpp"
+#include "MeshSimplify.hpp"
+#include "Random.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+// Written and read as raw bytes; no padding, so the format doesn't depend
+// on the compiler.
+static_assert(sizeof(VertexAttrib) == 8, "VertexAttrib layout");
+static_assert(sizeof(MeshLod) == 12, "MeshLod layout");
+static_assert(sizeof(MeshCacheHeader) == 176, "MeshCacheHeader layout");
+
+namespace {
+
+constexpr uint64_t align16(uint64_t x) { return (x + 15) & ~uint64_t(15); }
+
+struct QuantizedVertex {
+    uint16_t pos[4]; // w unused, keeps the normal 4-byte aligned
+    uint32_t normal;
+    uint16_t uv[2];
+};
+static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex layout");
+
+uint16_t unorm16(float v) {
+    return static_cast<uint16_t>(std::lround(std::min(std::max(v, 0.0f), 1.0f) * 65535.0f));
+}
+
+uint32_t snorm10(float v) {
+    return static_cast<uint32_t>(std::lround(std::min(std::max(v, -1.0f), 1.0f) * 511.0f)) & 0x3ffu;
+}
+
+// Octahedral map of a unit normal into x and y of a 2_10_10_10_REV word;
+// octDecode in simple.vshader inverts it
+uint32_t packOctNormal(float x, float y, float z) {
+    const float l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    if (l1 <= 0.0f) return snorm10(0.0f) | (snorm10(1.0f) << 10); // degenerate: +Y, as a missing normal
+    x /= l1;
+    y /= l1;
+    if (z < 0.0f) {
+        const float fx = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float fy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+    return snorm10(x) | (snorm10(y) << 10);
+}
+
+bool texcoordsInUnitRange(const MeshData &mesh) {
+    for (size_t v = 0; v < mesh.vertices.size(); v += kObjVertexFloats) {
+        const float u = mesh.vertices[v + 6], w = mesh.vertices[v + 7];
+        if (!(u >= 0.0f && u <= 1.0f && w >= 0.0f && w <= 1.0f)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+VertexLayout vertexLayout(VertexFormat format) {
+    VertexLayout layout;
+    layout.attribCount = 3;
+    if (format == VertexFormat::Quantized) {
+        layout.stride = sizeof(QuantizedVertex);
+        layout.attribs[0] = {0, 3, VertexAttribType::UNorm16, 1, offsetof(QuantizedVertex, pos)};
+        layout.attribs[1] = {1, 4, VertexAttribType::Int2_10_10_10, 1, offsetof(QuantizedVertex, normal)};
+        layout.attribs[2] = {2, 2, VertexAttribType::UNorm16, 1, offsetof(QuantizedVertex, uv)};
+    } else {
+        layout.stride = kObjVertexFloats * sizeof(float);
+        layout.attribs[0] = {0, 3, VertexAttribType::Float32, 0, 0};
+        layout.attribs[1] = {1, 3, VertexAttribType::Float32, 0, 3 * sizeof(float)};
+        layout.attribs[2] = {2, 2, VertexAttribType::Float32, 0, 6 * sizeof(float)};
+    }
+    return layout;
+}
+
+uint64_t hashBytes(const void *data, size_t size) {
+    // Four independent multiply-rotate lanes over 32-byte blocks, folded
+    // with splitMix64
+    constexpr uint64_t kP1 = 0x9e3779b185ebca87ull;
+    constexpr uint64_t kP2 = 0xc2b2ae3d27d4eb4full;
+    auto round = [](uint64_t acc, uint64_t word) {
+        acc += word * kP2;
+        acc = (acc << 31) | (acc >> 33);
+        return acc * kP1;
+    };
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    uint64_t lane[4] = {kP1 + kP2, kP2, 0, 0 - kP1};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int k = 0; k < 4; ++k) {
+            uint64_t word;
+            std::memcpy(&word, p + i + 8 * k, 8);
+            lane[k] = round(lane[k], word);
+        }
+    }
+    uint64_t h = size;
+    for (uint64_t l : lane) h = splitMix64(h ^ l);
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        h = splitMix64(h ^ word);
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p + i, size - i);
+    return splitMix64(h ^ tail);
+}
+
+std::string meshCachePath(const std::string &objPath) {
+    const size_t slash = objPath.find_last_of('/');
+    const size_t dot = objPath.find_last_of('.');
+    const bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    return (hasExtension ? objPath.substr(0, dot) : objPath) + ".wmesh";
+}
+
+std::vector<uint8_t> serializeMeshCache(const MeshData &mesh, VertexFormat format, uint64_t sourceHash,
+                                        uint64_t sourceSize) {
+    MeshCacheHeader header;
+    header.sourceHash = sourceHash;
+    header.sourceSize = sourceSize;
+    header.requested = format;
+    if (format == VertexFormat::Quantized && !texcoordsInUnitRange(mesh)) format = VertexFormat::Float;
+    header.format = format;
+    header.layout = vertexLayout(format);
+    header.vertexCount = static_cast<uint32_t>(mesh.vertices.size() / kObjVertexFloats);
+    header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    if (mesh.lods.empty()) {
+        header.lodCount = 1;
+        header.lods[0] = {0, header.indexCount, 0.0f};
+    } else {
+        header.lodCount = static_cast<uint32_t>(std::min<size_t>(mesh.lods.size(), kMaxMeshLods));
+        std::copy_n(mesh.lods.begin(), header.lodCount, header.lods);
+    }
+    if (header.vertexCount > 0) {
+        for (int a = 0; a < 3; ++a) {
+            header.boundsMin[a] = header.boundsMax[a] = mesh.vertices[a];
+        }
+        for (size_t v = 0; v < mesh.vertices.size(); v += kObjVertexFloats) {
+            for (int a = 0; a < 3; ++a) {
+                header.boundsMin[a] = std::min(header.boundsMin[a], mesh.vertices[v + a]);
+                header.boundsMax[a] = std::max(header.boundsMax[a], mesh.vertices[v + a]);
+            }
+        }
+    }
+    const uint64_t vertexBytes = static_cast<uint64_t>(header.vertexCount) * header.layout.stride;
+    const uint64_t indexBytes = mesh.indices.size() * sizeof(uint32_t);
+    header.vertexOffset = align16(sizeof(MeshCacheHeader));
+    header.indexOffset = align16(header.vertexOffset + vertexBytes);
+
+    std::vector<uint8_t> bytes(header.indexOffset + indexBytes, 0);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    if (format == VertexFormat::Quantized) {
+        float scale[3];
+        for (int a = 0; a < 3; ++a) {
+            const float extent = header.boundsMax[a] - header.boundsMin[a];
+            scale[a] = extent > 0.0f ? 1.0f / extent : 0.0f;
+        }
+        QuantizedVertex *out = reinterpret_cast<QuantizedVertex *>(bytes.data() + header.vertexOffset);
+        for (uint32_t i = 0; i < header.vertexCount; ++i) {
+            const float *v = &mesh.vertices[static_cast<size_t>(i) * kObjVertexFloats];
+            for (int a = 0; a < 3; ++a) out[i].pos[a] = unorm16((v[a] - header.boundsMin[a]) * scale[a]);
+            out[i].pos[3] = 0;
+            out[i].normal = packOctNormal(v[3], v[4], v[5]);
+            out[i].uv[0] = unorm16(v[6]);
+            out[i].uv[1] = unorm16(v[7]);
+        }
+    } else {
+        std::memcpy(bytes.data() + header.vertexOffset, mesh.vertices.data(), vertexBytes);
+    }
+    std::memcpy(bytes.data() + header.indexOffset, mesh.indices.data(), indexBytes);
+    return bytes;
+}
+
+bool parseMeshCache(const void *data, size_t size, VertexFormat format, uint64_t sourceHash,
+                    uint64_t sourceSize, MeshCacheView &view) {
+    MeshCacheHeader header;
+    if (size < sizeof(header)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kMeshCacheMagic || header.version != kMeshCacheVersion) return false;
+    if (header.sourceHash != sourceHash || header.sourceSize != sourceSize) return false;
+    if (header.requested != format) return false;
+    const VertexLayout &layout = header.layout;
+    if (layout.stride == 0 || layout.attribCount > kMaxVertexAttribs) return false;
+    if (header.vertexOffset % 16 != 0 || header.indexOffset % 16 != 0) return false;
+    const uint64_t vertexEnd = header.vertexOffset + static_cast<uint64_t>(header.vertexCount) * layout.stride;
+    const uint64_t indexEnd = header.indexOffset + static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t);
+    if (vertexEnd > size || indexEnd > size || header.indexCount % 3 != 0) return false;
+    if (header.lodCount == 0 || header.lodCount > kMaxMeshLods) return false;
+    for (uint32_t l = 0; l < header.lodCount; ++l) {
+        const MeshLod &lod = header.lods[l];
+        if (lod.indexOffset % 3 != 0 || lod.indexCount % 3 != 0 ||
+            static_cast<uint64_t>(lod.indexOffset) + lod.indexCount > header.indexCount) {
+            return false;
+        }
+    }
+
+    const uint8_t *base = static_cast<const uint8_t *>(data);
+    const uint32_t *indices = reinterpret_cast<const uint32_t *>(base + header.indexOffset);
+    // A damaged index would read past the vertex buffer on the GPU
+    uint32_t maxIndex = 0;
+    for (uint32_t i = 0; i < header.indexCount; ++i) maxIndex = std::max(maxIndex, indices[i]);
+    if (header.indexCount > 0 && maxIndex >= header.vertexCount) return false;
+
+    view.format = header.format;
+    view.layout = layout;
+    view.vertexCount = header.vertexCount;
+    view.indexCount = header.indexCount;
+    view.vertices = base + header.vertexOffset;
+    view.indices = indices;
+    view.boundsMin = Vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    view.boundsMax = Vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    view.lodCount = header.lodCount;
+    std::copy_n(header.lods, header.lodCount, view.lods);
+    return true;
+}
+
+void loadMeshCache(const std::string &objPath, const std::string &cachePath, VertexFormat format,
+                   MeshCacheFile &out) {
+    MappedFile source;
+    if (!source.open(objPath)) throw std::runtime_error("Failed to open OBJ: " + objPath);
+    const uint64_t sourceHash = hashBytes(source.begin(), source.size());
+
+    out.memory.clear();
+    out.fromCache = out.mapping.open(cachePath) &&
+                    parseMeshCache(out.mapping.begin(), out.mapping.size(), format, sourceHash, source.size(),
+                                   out.view);
+    if (out.fromCache) return;
+    out.mapping.close();
+
+    MeshData mesh = loadObj(objPath);
+    optimizeMesh(mesh);
+    buildMeshLods(mesh);
+    out.memory = serializeMeshCache(mesh, format, sourceHash, source.size());
+    parseMeshCache(out.memory.data(), out.memory.size(), format, sourceHash, source.size(), out.view);
+
+    // Per-process temporary name, so launches racing to build the same
+    // cache each rename a complete file
+    const std::string temp = cachePath + ".tmp" + std::to_string(::getpid());
+    bool written = false;
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (file) {
+            file.write(reinterpret_cast<const char *>(out.memory.data()),
+                       static_cast<std::streamsize>(out.memory.size()));
+            written = static_cast<bool>(file.flush());
+        }
+    }
+    if (!written || std::rename(temp.c_str(), cachePath.c_str()) != 0) {
+        std::remove(temp.c_str());
+        std::cerr << "Could not write mesh cache " << cachePath << std::endl;
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+#include "Math.hpp"
+#include "ObjLoader.hpp"
+
+// Binary model cache (.wmesh), written next to each OBJ the first time it
+// loads. Later launches map the cache and hand its vertex and index blobs
+// straight to glBufferData; nothing is parsed. The header records the
+// vertex layout, an AABB and a hash of the source OBJ, and a cache whose
+// hash, version or sizes don't match is rebuilt from the OBJ.
+//
+// Layout (host byte order, little-endian on every target):
+//   MeshCacheHeader
+//   vertex blob at vertexOffset, vertexCount * layout.stride bytes
+//   index blob at indexOffset, indexCount uint32_t: every LOD's range
+// Both blobs start 16-byte aligned.
+
+constexpr uint32_t kMeshCacheMagic = 0x48534d57; // "WMSH"
+constexpr uint32_t kMeshCacheVersion = 3;         // bump when the loader or optimizer output changes
+constexpr int kMaxVertexAttribs = 4;
+
+enum class VertexAttribType : uint8_t {
+    Float32,
+    UNorm16,      // GL_UNSIGNED_SHORT, normalized
+    Int2_10_10_10, // GL_INT_2_10_10_10_REV, normalized; four components
+};
+
+// Vertex encodings for loaded models. Both carry position, normal and
+// texcoord at attribute locations 0, 1 and 2.
+enum class VertexFormat : uint32_t {
+    Float,     // 32 bytes: three, three and two floats
+    // 16 bytes: position as 16-bit unorm within the mesh AABB, normal
+    // octahedral in the x and y of a 2_10_10_10 (z and w unused), texcoord as
+    // 16-bit unorm. Decoded in simple.vshader and shadow.vshader (uQuantized).
+    // Models with texcoords outside [0, 1] stay Float.
+    Quantized,
+};
+
+struct VertexAttrib {
+    uint8_t location = 0; // shader attribute location
+    uint8_t components = 0;
+    VertexAttribType type = VertexAttribType::Float32;
+    uint8_t normalized = 0;
+    uint32_t offset = 0;  // bytes into the vertex
+};
+
+struct VertexLayout {
+    uint32_t stride = 0; // bytes
+    uint32_t attribCount = 0;
+    VertexAttrib attribs[kMaxVertexAttribs];
+};
+
+VertexLayout vertexLayout(VertexFormat format);
+
+struct MeshCacheHeader {
+    uint32_t magic = kMeshCacheMagic;
+    uint32_t version = kMeshCacheVersion;
+    uint64_t sourceHash = 0;
+    uint64_t sourceSize = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    VertexFormat requested = VertexFormat::Float; // asked for by the loader
+    VertexFormat format = VertexFormat::Float;    // written; layout describes it
+    VertexLayout layout;
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+    uint64_t vertexOffset = 0;
+    uint64_t indexOffset = 0;
+    uint32_t lodCount = 0; // at least 1; ranges of the index blob, finest first
+    uint32_t reserved = 0;
+    MeshLod lods[kMaxMeshLods];
+};
+
+// A validated cache in memory. The pointers stay valid while the
+// MeshCacheFile that produced it is alive.
+struct MeshCacheView {
+    VertexFormat format = VertexFormat::Float; // as written
+    VertexLayout layout;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    const void *vertices = nullptr;
+    const uint32_t *indices = nullptr;
+    Vec3 boundsMin, boundsMax;
+    uint32_t lodCount = 0;
+    MeshLod lods[kMaxMeshLods];
+};
+
+struct MeshCacheFile {
+    MappedFile mapping;
+    std::vector<uint8_t> memory; // the cache, when it couldn't be written or mapped
+    MeshCacheView view;
+    bool fromCache = false;      // false: the OBJ was parsed this time
+};
+
+// 64-bit hash of a byte range, several GB/s; for cache invalidation, not
+// security.
+uint64_t hashBytes(const void *data, size_t size);
+std::string meshCachePath(const std::string &objPath); // model.obj -> model.wmesh
+
+// Serialized cache of an (already optimized) loaded model. Without
+// mesh.lods, all of its indices are the one level.
+std::vector<uint8_t> serializeMeshCache(const MeshData &mesh, VertexFormat format, uint64_t sourceHash,
+                                        uint64_t sourceSize);
+// Checks the header against the source and requested format, and the blob
+// bounds against size; fills view on success.
+bool parseMeshCache(const void *data, size_t size, VertexFormat format, uint64_t sourceHash,
+                    uint64_t sourceSize, MeshCacheView &view);
+
+// The model at objPath in format, from its cache at cachePath when that is
+// current and was asked for in the same format; otherwise parsed,
+// optimized and simplified into LODs, then cached (written to a temporary file and renamed into
+// place, so a crash never leaves half a cache). A cache that can't be
+// written is only logged. Throws like loadObj.
+void loadMeshCache(const std::string &objPath, const std::string &cachePath, VertexFormat format,
+                   MeshCacheFile &out);
@@ -0,0 +1,175 @@
+#include "MeshOptimize.hpp"
+#include "Math.hpp"
+#include <algorithm>
+#include <numeric>
+
+void optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, int cacheSize,
+                         std::vector<uint32_t> *clusters) {
+    const size_t triCount = indices.size() / 3;
+    if (triCount == 0) return;
+
+    // Vertex -> triangle adjacency, and each vertex's live (unemitted)
+    // triangle count
+    std::vector<uint32_t> live(vertexCount, 0);
+    for (uint32_t v : indices) ++live[v];
+    std::vector<uint32_t> offset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) offset[v + 1] = offset[v] + live[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(offset.begin(), offset.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    const uint32_t k = static_cast<uint32_t>(cacheSize);
+    std::vector<uint32_t> stamp(vertexCount, 0); // cache time of the last miss
+    std::vector<uint8_t> emitted(triCount, 0);
+    std::vector<uint32_t> deadEnds;
+    deadEnds.reserve(indices.size());
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> out;
+    out.reserve(indices.size());
+    uint32_t time = k + 1;
+    size_t cursor = 0;
+
+    // Fall back to a recently used vertex, then to the next one in order
+    auto skipDeadEnd = [&]() -> int64_t {
+        while (!deadEnds.empty()) {
+            const uint32_t v = deadEnds.back();
+            deadEnds.pop_back();
+            if (live[v] > 0) return v;
+        }
+        for (; cursor < vertexCount; ++cursor) {
+            if (live[cursor] > 0) return static_cast<int64_t>(cursor);
+        }
+        return -1;
+    };
+
+    int64_t fan = skipDeadEnd();
+    bool coldStart = true;
+    while (fan >= 0) {
+        // Emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (uint32_t a = offset[fan]; a < offset[fan + 1]; ++a) {
+            const uint32_t t = adjacency[a];
+            if (emitted[t]) continue;
+            if (coldStart && clusters) clusters->push_back(static_cast<uint32_t>(out.size() / 3));
+            coldStart = false;
+            for (int c = 0; c < 3; ++c) {
+                const uint32_t v = indices[t * 3 + c];
+                out.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - stamp[v] > k) stamp[v] = time++;
+            }
+            emitted[t] = 1;
+        }
+
+        // Next fan: the oldest candidate that will still be in the cache
+        // after its remaining triangles are emitted
+        int64_t next = -1;
+        uint32_t best = 0;
+        for (uint32_t v : candidates) {
+            if (live[v] == 0) continue;
+            uint32_t priority = 0;
+            if (time - stamp[v] + 2 * live[v] <= k) priority = time - stamp[v];
+            if (priority > best) {
+                best = priority;
+                next = v;
+            }
+        }
+        if (next < 0) {
+            next = skipDeadEnd();
+            coldStart = true;
+        }
+        fan = next;
+    }
+    indices.swap(out);
+}
+
+void optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<float> &vertices, int stride,
+                      const std::vector<uint32_t> &clusters) {
+    const size_t triCount = indices.size() / 3;
+    const size_t clusterCount = clusters.size();
+    if (clusterCount < 2) return;
+
+    auto position = [&](uint32_t v) {
+        const float *p = &vertices[static_cast<size_t>(v) * stride];
+        return Vec3(p[0], p[1], p[2]);
+    };
+    // Area-weighted centroid and normal per cluster; the mesh centroid from
+    // their sum
+    std::vector<Vec3> centroid(clusterCount), normal(clusterCount);
+    std::vector<float> area(clusterCount, 0.0f);
+    Vec3 meshCentroid;
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; ++c) {
+        const size_t end = c + 1 < clusterCount ? clusters[c + 1] : triCount;
+        for (size_t t = clusters[c]; t < end; ++t) {
+            const Vec3 a = position(indices[t * 3]);
+            const Vec3 b = position(indices[t * 3 + 1]);
+            const Vec3 d = position(indices[t * 3 + 2]);
+            const Vec3 n = cross(b - a, d - a);
+            const float w = length(n);
+            centroid[c] = centroid[c] + (a + b + d) * (w / 3.0f);
+            normal[c] = normal[c] + n;
+            area[c] += w;
+        }
+        meshCentroid = meshCentroid + centroid[c];
+        meshArea += area[c];
+    }
+    if (meshArea <= 0.0f) return;
+    meshCentroid = meshCentroid * (1.0f / meshArea);
+
+    std::vector<float> facing(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        if (area[c] > 0.0f) facing[c] = dot(centroid[c] * (1.0f / area[c]) - meshCentroid, normalize(normal[c]));
+    }
+    std::vector<uint32_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return facing[a] > facing[b]; });
+
+    std::vector<uint32_t> out;
+    out.reserve(indices.size());
+    for (uint32_t c : order) {
+        const size_t end = c + 1 < clusterCount ? clusters[c + 1] : triCount;
+        out.insert(out.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+    }
+    indices.swap(out);
+}
+
+void optimizeVertexFetch(std::vector<float> &vertices, std::vector<uint32_t> &indices, int stride) {
+    const size_t vertexCount = vertices.size() / stride;
+    std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    std::vector<float> out(vertices.size());
+    uint32_t next = 0;
+    for (uint32_t &index : indices) {
+        if (remap[index] == UINT32_MAX) {
+            std::copy_n(&vertices[static_cast<size_t>(index) * stride], stride, &out[static_cast<size_t>(next) * stride]);
+            remap[index] = next++;
+        }
+        index = remap[index];
+    }
+    out.resize(static_cast<size_t>(next) * stride);
+    vertices.swap(out);
+}
+
+void optimizeMesh(MeshData &mesh, int cacheSize) {
+    std::vector<uint32_t> clusters;
+    optimizeVertexCache(mesh.indices, mesh.vertices.size() / kObjVertexFloats, cacheSize, &clusters);
+    optimizeOverdraw(mesh.indices, mesh.vertices, kObjVertexFloats, clusters);
+    optimizeVertexFetch(mesh.vertices, mesh.indices, kObjVertexFloats);
+}
+
+float vertexCacheMissRatio(const std::vector<uint32_t> &indices, size_t vertexCount, int cacheSize) {
+    if (indices.empty()) return 0.0f;
+    // FIFO: a vertex is resident while fewer than cacheSize misses followed its own
+    std::vector<uint32_t> missTime(vertexCount, 0);
+    uint32_t misses = 0;
+    for (uint32_t v : indices) {
+        if (missTime[v] == 0 || misses - missTime[v] >= static_cast<uint32_t>(cacheSize)) {
+            missTime[v] = ++misses;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ObjLoader.hpp"
+
+// Triangle and vertex order for indexed models: fewer vertex shader runs
+// through the post-transform cache, less overdraw, and vertex fetches that
+// walk the buffer forward. Only the order changes, never the geometry.
+
+constexpr int kVertexCacheSize = 16; // post-transform cache entries assumed (FIFO)
+
+// Tipsify (Sander, Nehab & Barczak 2007): linear-time triangle reorder for
+// the vertex cache. When clusters is given, the first triangle of every run
+// that starts after a dead end (where the cache is effectively cold) is
+// appended to it, for optimizeOverdraw.
+void optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount,
+                         int cacheSize = kVertexCacheSize, std::vector<uint32_t> *clusters = nullptr);
+// Draws the clusters facing out from the mesh centre first, so they occlude
+// the rest from most views. Positions are the first three of stride floats.
+void optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<float> &vertices, int stride,
+                      const std::vector<uint32_t> &clusters);
+// Renumbers vertices in order of first use; unreferenced ones are dropped.
+void optimizeVertexFetch(std::vector<float> &vertices, std::vector<uint32_t> &indices, int stride);
+// All three, on a loaded model.
+void optimizeMesh(MeshData &mesh, int cacheSize = kVertexCacheSize);
+
+// Average cache misses (vertex shader runs) per triangle through a FIFO
+// cache: 3 for a triangle soup, 0.5 at best on a regular grid.
+float vertexCacheMissRatio(const std::vector<uint32_t> &indices, size_t vertexCount,
+                           int cacheSize = kVertexCacheSize);
@@ -0,0 +1,314 @@
+#include "MeshSimplify.hpp"
+#include "Math.hpp"
+#include "MeshOptimize.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+// Weight of the planes that hold open borders in place, relative to face
+// area
+constexpr double kBorderWeight = 10.0;
+
+// Sum of w * (dot(n, p) + d)^2 over planes, as a symmetric 4x4 matrix;
+// w totals the weights so errors can be averaged
+struct Quadric {
+    double a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+    double b0 = 0, b1 = 0, b2 = 0, c = 0, w = 0;
+};
+
+void addPlane(Quadric &q, const Vec3 &n, float d, double w) {
+    q.a00 += w * n.x * n.x;
+    q.a11 += w * n.y * n.y;
+    q.a22 += w * n.z * n.z;
+    q.a01 += w * n.x * n.y;
+    q.a02 += w * n.x * n.z;
+    q.a12 += w * n.y * n.z;
+    q.b0 += w * n.x * d;
+    q.b1 += w * n.y * d;
+    q.b2 += w * n.z * d;
+    q.c += w * d * d;
+    q.w += w;
+}
+
+void addQuadric(Quadric &q, const Quadric &o) {
+    q.a00 += o.a00;
+    q.a11 += o.a11;
+    q.a22 += o.a22;
+    q.a01 += o.a01;
+    q.a02 += o.a02;
+    q.a12 += o.a12;
+    q.b0 += o.b0;
+    q.b1 += o.b1;
+    q.b2 += o.b2;
+    q.c += o.c;
+    q.w += o.w;
+}
+
+// Weighted sum of squared plane distances at p
+double quadricSum(const Quadric &q, const Vec3 &p) {
+    const double x = p.x, y = p.y, z = p.z;
+    return q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+           2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+           2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+}
+
+enum class VertexKind : uint8_t {
+    Manifold, // interior: collapses onto any neighbour
+    Border,   // on one open boundary loop: collapses along it
+    Locked,   // seam, corner or non-manifold: never moves
+};
+
+struct Collapse {
+    uint32_t from, to; // vertices
+    float cost;
+};
+
+} // namespace
+
+std::vector<uint32_t> simplifyMesh(const std::vector<float> &vertices, int stride,
+                                   const std::vector<uint32_t> &indices, size_t targetIndexCount,
+                                   float *error) {
+    std::vector<uint32_t> result(indices);
+    if (error) *error = 0.0f;
+    const size_t vertexCount = vertices.size() / stride;
+    if (result.size() <= targetIndexCount || vertexCount == 0) return result;
+
+    // Positions scaled into the unit cube, so quadric sums stay well
+    // conditioned whatever the model's units
+    Vec3 lo(vertices[0], vertices[1], vertices[2]), hi = lo;
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float *p = &vertices[v * stride];
+        lo = Vec3(std::min(lo.x, p[0]), std::min(lo.y, p[1]), std::min(lo.z, p[2]));
+        hi = Vec3(std::max(hi.x, p[0]), std::max(hi.y, p[1]), std::max(hi.z, p[2]));
+    }
+    const float extent = std::max(std::max(hi.x - lo.x, hi.y - lo.y), std::max(hi.z - lo.z, 1e-12f));
+    std::vector<Vec3> position(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float *p = &vertices[v * stride];
+        position[v] = (Vec3(p[0], p[1], p[2]) - lo) * (1.0f / extent);
+    }
+
+    // Vertices split only by normal or texcoord share one canonical
+    // position vertex; topology and quadrics live on those
+    std::vector<uint32_t> canonical(vertexCount);
+    std::vector<uint32_t> wedges(vertexCount, 0); // referenced vertices per position
+    {
+        std::vector<uint32_t> order(vertexCount);
+        std::iota(order.begin(), order.end(), 0u);
+        auto samePosition = [&](uint32_t a, uint32_t b) {
+            return std::memcmp(&vertices[static_cast<size_t>(a) * stride],
+                               &vertices[static_cast<size_t>(b) * stride], 3 * sizeof(float)) == 0;
+        };
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const int c = std::memcmp(&vertices[static_cast<size_t>(a) * stride],
+                                      &vertices[static_cast<size_t>(b) * stride], 3 * sizeof(float));
+            return c != 0 ? c < 0 : a < b;
+        });
+        for (size_t i = 0; i < vertexCount; ++i) {
+            canonical[order[i]] = i > 0 && samePosition(order[i - 1], order[i]) ? canonical[order[i - 1]] : order[i];
+        }
+        std::vector<uint8_t> used(vertexCount, 0);
+        for (uint32_t v : result) {
+            if (!used[v]) ++wedges[canonical[v]];
+            used[v] = 1;
+        }
+    }
+
+    // Directed edges between positions; an edge whose reverse is missing is
+    // open, one seen twice is non-manifold
+    std::vector<uint64_t> edges;
+    edges.reserve(result.size());
+    for (size_t t = 0; t < result.size(); t += 3) {
+        for (int e = 0; e < 3; ++e) {
+            const uint32_t a = canonical[result[t + e]], b = canonical[result[t + (e + 1) % 3]];
+            if (a != b) edges.push_back((static_cast<uint64_t>(a) << 32) | b);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    std::vector<uint8_t> openOut(vertexCount, 0), openIn(vertexCount, 0), nonManifold(vertexCount, 0);
+    std::vector<uint32_t> loopNext(vertexCount, UINT32_MAX), loopPrev(vertexCount, UINT32_MAX);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const uint32_t a = static_cast<uint32_t>(edges[i] >> 32), b = static_cast<uint32_t>(edges[i]);
+        if (i + 1 < edges.size() && edges[i + 1] == edges[i]) nonManifold[a] = nonManifold[b] = 1;
+        if (i > 0 && edges[i - 1] == edges[i]) continue;
+        const uint64_t reverse = (static_cast<uint64_t>(b) << 32) | a;
+        if (std::binary_search(edges.begin(), edges.end(), reverse)) continue;
+        openOut[a] = static_cast<uint8_t>(std::min(openOut[a] + 1, 2));
+        openIn[b] = static_cast<uint8_t>(std::min(openIn[b] + 1, 2));
+        loopNext[a] = b;
+        loopPrev[b] = a;
+    }
+    std::vector<VertexKind> kind(vertexCount, VertexKind::Locked);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (wedges[v] != 1 || nonManifold[v]) continue;
+        if (openOut[v] == 0 && openIn[v] == 0) kind[v] = VertexKind::Manifold;
+        else if (openOut[v] == 1 && openIn[v] == 1) kind[v] = VertexKind::Border;
+    }
+
+    // Each position starts with the planes of its faces, area-weighted, and
+    // of its open edges, so borders keep their outline
+    std::vector<Quadric> quadric(vertexCount);
+    for (size_t t = 0; t < result.size(); t += 3) {
+        const uint32_t c[3] = {canonical[result[t]], canonical[result[t + 1]], canonical[result[t + 2]]};
+        const Vec3 n = cross(position[c[1]] - position[c[0]], position[c[2]] - position[c[0]]);
+        const float doubleArea = length(n);
+        if (doubleArea <= 0.0f) continue;
+        const Vec3 unit = n * (1.0f / doubleArea);
+        const float d = -dot(unit, position[c[0]]);
+        for (uint32_t v : c) addPlane(quadric[v], unit, d, 0.5 * doubleArea);
+        for (int e = 0; e < 3; ++e) {
+            const uint32_t a = c[e], b = c[(e + 1) % 3];
+            const uint64_t reverse = (static_cast<uint64_t>(b) << 32) | a;
+            if (std::binary_search(edges.begin(), edges.end(), reverse)) continue;
+            const Vec3 edge = position[b] - position[a];
+            const Vec3 side = cross(edge, unit);
+            const float sideLength = length(side);
+            if (sideLength <= 0.0f) continue;
+            const Vec3 sideUnit = side * (1.0f / sideLength);
+            const float sideD = -dot(sideUnit, position[a]);
+            const double w = kBorderWeight * dot(edge, edge);
+            addPlane(quadric[a], sideUnit, sideD, w);
+            addPlane(quadric[b], sideUnit, sideD, w);
+        }
+    }
+
+    // Passes of independent collapses: each pass ranks every allowed
+    // collapse, then takes the cheapest whose neighbourhoods don't overlap,
+    // up to a little over the cost the target needs
+    std::vector<uint32_t> offset(vertexCount + 1), adjacency, remap(vertexCount);
+    std::vector<uint8_t> locked(vertexCount);
+    std::vector<Collapse> collapses;
+    double maxError = 0.0;
+    while (result.size() > targetIndexCount) {
+        std::fill(offset.begin(), offset.end(), 0u);
+        for (uint32_t v : result) ++offset[canonical[v] + 1];
+        for (size_t v = 0; v < vertexCount; ++v) offset[v + 1] += offset[v];
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> fill(offset.begin(), offset.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i) {
+                adjacency[fill[canonical[result[i]]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        collapses.clear();
+        auto consider = [&](uint32_t from, uint32_t to) {
+            const uint32_t c0 = canonical[from], c1 = canonical[to];
+            if (kind[c0] == VertexKind::Locked) return;
+            if (kind[c0] == VertexKind::Border && loopNext[c0] != c1 && loopPrev[c0] != c1) return;
+            Quadric merged = quadric[c0];
+            addQuadric(merged, quadric[c1]);
+            const double cost = std::fabs(quadricSum(merged, position[c1])) / std::max(merged.w, 1e-30);
+            collapses.push_back({from, to, static_cast<float>(cost)});
+        };
+        // Each interior edge is two half-edges in two faces, one per
+        // direction; open edges have only the one
+        for (size_t t = 0; t < result.size(); t += 3) {
+            for (int e = 0; e < 3; ++e) {
+                const uint32_t a = result[t + e], b = result[t + (e + 1) % 3];
+                if (canonical[a] == canonical[b]) continue;
+                consider(a, b);
+                if (kind[canonical[b]] == VertexKind::Border) consider(b, a);
+            }
+        }
+        if (collapses.empty()) break;
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse &a, const Collapse &b) { return a.cost < b.cost; });
+
+        // About two triangles go per interior collapse
+        const size_t needed = (result.size() - targetIndexCount + 2) / 3;
+        const float limit = collapses[std::min(collapses.size() - 1, (needed + 1) / 2)].cost * 1.5f;
+
+        std::fill(locked.begin(), locked.end(), 0);
+        std::iota(remap.begin(), remap.end(), 0u);
+        size_t removed = 0;
+        for (const Collapse &c : collapses) {
+            if (c.cost > limit || removed >= needed) break;
+            const uint32_t c0 = canonical[c.from], c1 = canonical[c.to];
+            if (locked[c0] || locked[c1]) continue;
+
+            // No face around c0 may turn over when it moves onto c1
+            bool flips = false;
+            for (uint32_t a = offset[c0]; a < offset[c0 + 1] && !flips; ++a) {
+                const uint32_t t = adjacency[a] * 3;
+                const uint32_t k[3] = {canonical[result[t]], canonical[result[t + 1]], canonical[result[t + 2]]};
+                if (k[0] == c1 || k[1] == c1 || k[2] == c1) continue;
+                const Vec3 before = cross(position[k[1]] - position[k[0]], position[k[2]] - position[k[0]]);
+                Vec3 moved[3] = {position[k[0]], position[k[1]], position[k[2]]};
+                for (int i = 0; i < 3; ++i) {
+                    if (k[i] == c0) moved[i] = position[c1];
+                }
+                const Vec3 after = cross(moved[1] - moved[0], moved[2] - moved[0]);
+                flips = dot(before, after) <= 0.0f;
+            }
+            if (flips) continue;
+
+            remap[c.from] = c.to;
+            addQuadric(quadric[c1], quadric[c0]);
+            if (kind[c0] == VertexKind::Border) {
+                if (loopNext[c0] == c1) {
+                    loopNext[loopPrev[c0]] = c1;
+                    loopPrev[c1] = loopPrev[c0];
+                } else {
+                    loopPrev[loopNext[c0]] = c1;
+                    loopNext[c1] = loopNext[c0];
+                }
+            }
+            removed += kind[c0] == VertexKind::Border ? 1 : 2;
+            kind[c0] = VertexKind::Locked;
+            maxError = std::max(maxError, static_cast<double>(c.cost));
+            for (uint32_t a = offset[c0]; a < offset[c0 + 1]; ++a) {
+                const uint32_t t = adjacency[a] * 3;
+                for (int i = 0; i < 3; ++i) locked[canonical[result[t + i]]] = 1;
+            }
+        }
+
+        // Faces that lost an edge go
+        size_t out = 0;
+        for (size_t t = 0; t < result.size(); t += 3) {
+            const uint32_t a = remap[result[t]], b = remap[result[t + 1]], d = remap[result[t + 2]];
+            if (canonical[a] == canonical[b] || canonical[b] == canonical[d] || canonical[a] == canonical[d]) continue;
+            result[out++] = a;
+            result[out++] = b;
+            result[out++] = d;
+        }
+        if (out == result.size()) break;
+        result.resize(out);
+    }
+
+    if (error) *error = static_cast<float>(std::sqrt(maxError)) * extent;
+    return result;
+}
+
+void buildMeshLods(MeshData &mesh) {
+    if (!mesh.lods.empty()) mesh.indices.resize(mesh.lods[0].indexCount);
+    const std::vector<uint32_t> base(mesh.indices);
+    const size_t vertexCount = mesh.vertices.size() / kObjVertexFloats;
+    mesh.lods.assign(1, MeshLod{0, static_cast<uint32_t>(base.size()), 0.0f});
+
+    // Each level from LOD 0, so its error is measured against full detail
+    std::vector<uint32_t> levels[kMaxMeshLods];
+    float errors[kMaxMeshLods] = {};
+    parallelFor(kMaxMeshLods - 1, 1, [&](int begin, int end) {
+        for (int level = begin + 1; level <= end; ++level) {
+            levels[level] = simplifyMesh(mesh.vertices, kObjVertexFloats, base, (base.size() >> level) / 3 * 3,
+                                         &errors[level]);
+            optimizeVertexCache(levels[level], vertexCount);
+        }
+    });
+
+    size_t previous = base.size();
+    for (int level = 1; level < kMaxMeshLods; ++level) {
+        // Locked seams can stall it; a near copy isn't worth the indices
+        const std::vector<uint32_t> &lod = levels[level];
+        if (lod.empty() || lod.size() * 4 > previous * 3) break;
+        mesh.lods.push_back(
+            {static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(lod.size()), errors[level]});
+        mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+        previous = lod.size();
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ObjLoader.hpp"
+
+// Quadric-error mesh simplification (Garland & Heckbert) for model LODs.
+// Vertices are collapsed onto neighbours, cheapest first by the summed
+// squared distance to their original faces' planes; no new vertices are
+// made, so every LOD indexes the full-detail vertex buffer. Vertices on UV
+// or normal seams and on complex or non-manifold edges stay put; open
+// borders only slide along themselves.
+
+// Reduces indices to at most targetIndexCount where the mesh allows it.
+// Positions are the first three of stride floats. error, if given, receives
+// the largest RMS plane distance of any collapse, in model units.
+std::vector<uint32_t> simplifyMesh(const std::vector<float> &vertices, int stride,
+                                   const std::vector<uint32_t> &indices, size_t targetIndexCount,
+                                   float *error = nullptr);
+
+// Replaces mesh.lods with LOD 0 (the current indices) plus up to
+// kMaxMeshLods - 1 coarser levels, each about half the triangles of the one
+// before and cache-ordered, appended to mesh.indices. Stops early once a
+// level barely shrinks.
+void buildMeshLods(MeshData &mesh);
@@ -0,0 +1,429 @@
+#include "ObjLoader.hpp"
+#include "MappedFile.hpp"
+#include "Math.hpp"
+#include "Parallel.hpp"
+#include "Random.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool isSpace(char c) { return isBlank(c) || c == '\n'; }
+
+inline const char *skipBlanks(const char *p, const char *end) {
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+}
+
+inline const char *nextLine(const char *p, const char *end) {
+    const void *nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return nl ? static_cast<const char *>(nl) + 1 : end;
+}
+
+enum class ObjLine { Other, Position, Normal, Texcoord, Face };
+
+// Classifies the line at p and returns where its arguments start.
+inline ObjLine lineTag(const char *&p, const char *end) {
+    p = skipBlanks(p, end);
+    if (end - p < 2) return ObjLine::Other;
+    if (p[0] == 'v') {
+        if (isBlank(p[1])) { p += 2; return ObjLine::Position; }
+        if (end - p >= 3 && isBlank(p[2])) {
+            if (p[1] == 'n') { p += 3; return ObjLine::Normal; }
+            if (p[1] == 't') { p += 3; return ObjLine::Texcoord; }
+        }
+    } else if (p[0] == 'f' && isBlank(p[1])) {
+        p += 2;
+        return ObjLine::Face;
+    }
+    return ObjLine::Other;
+}
+
+// Missing or malformed numbers read as 0, as operator>> leaves them.
+float parseFloat(const char *&p, const char *end) {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+') ++p; // from_chars takes no sign but '-'
+    float value = 0.0f;
+#if defined(__cpp_lib_to_chars)
+    const std::from_chars_result r = std::from_chars(p, end, value);
+    if (r.ec == std::errc()) p = r.ptr;
+#else
+    // Standard libraries without floating-point from_chars: strtof on a
+    // bounded copy, since the mapping isn't NUL-terminated.
+    char buf[64];
+    size_t n = 0;
+    while (p + n < end && n + 1 < sizeof(buf) && !isSpace(p[n])) {
+        buf[n] = p[n];
+        ++n;
+    }
+    buf[n] = '\0';
+    char *stop = buf;
+    value = std::strtof(buf, &stop);
+    p += stop - buf;
+#endif
+    while (p < end && !isSpace(*p)) ++p; // rest of a malformed token
+    return value;
+}
+
+inline int parseIndex(const char *&p, const char *end) {
+    int value = 0;
+    if (p < end && *p == '+') ++p;
+    const std::from_chars_result r = std::from_chars(p, end, value);
+    if (r.ec == std::errc()) p = r.ptr;
+    return value;
+}
+
+// One face corner, "v", "v/t", "v//n" or "v/t/n"; 0 marks a missing index.
+inline void parseCorner(const char *&p, const char *end, int &v, int &t, int &n) {
+    v = parseIndex(p, end);
+    t = n = 0;
+    if (p < end && *p == '/') {
+        ++p;
+        if (p < end && *p != '/') t = parseIndex(p, end);
+        if (p < end && *p == '/') {
+            ++p;
+            n = parseIndex(p, end);
+        }
+    }
+    while (p < end && !isSpace(*p)) ++p;
+}
+
+// 1-based or negative (relative to the elements read so far) to 0-based;
+// -1 when missing.
+inline int resolveIndex(int index, int count) {
+    if (index > 0) return index - 1;
+    if (index < 0) return count + index;
+    return -1;
+}
+
+// A face corner as resolved 0-based indices; -1 for a missing texcoord or
+// normal.
+struct Corner {
+    int v, t, n;
+};
+
+inline uint64_t cornerHash(const Corner &c) {
+    return splitMix64((static_cast<uint64_t>(static_cast<uint32_t>(c.v)) << 32) ^
+                      (static_cast<uint64_t>(static_cast<uint32_t>(c.t)) << 16) ^ static_cast<uint32_t>(c.n));
+}
+
+// Distinct corners in first-use order, looked up through open addressing
+// over the index triple at most half full.
+struct CornerSet {
+    std::vector<Corner> keys;
+    std::vector<uint32_t> table;
+
+    explicit CornerSet(size_t capacity) {
+        keys.reserve(capacity);
+        size_t slots = 16;
+        while (slots < capacity * 2) slots *= 2;
+        table.assign(slots, UINT32_MAX);
+    }
+
+    uint32_t insert(const Corner &c) {
+        const size_t mask = table.size() - 1;
+        size_t slot = static_cast<size_t>(cornerHash(c)) & mask;
+        while (table[slot] != UINT32_MAX) {
+            const Corner &k = keys[table[slot]];
+            if (k.v == c.v && k.t == c.t && k.n == c.n) return table[slot];
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = static_cast<uint32_t>(keys.size());
+        keys.push_back(c);
+        return table[slot];
+    }
+};
+
+// A line-aligned slice of the file. Counted first; the prefix sums of the
+// counts give each chunk where its elements and triangles land and what
+// relative indices resolve against.
+struct ObjChunk {
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    size_t positions = 0, normals = 0, texcoords = 0, triangles = 0, corners = 0;
+    size_t positionBase = 0, normalBase = 0, texcoordBase = 0, triangleBase = 0; // totals before it
+    std::vector<Corner> keys; // distinct corners, first use in this chunk first
+    bool badIndex = false;
+};
+
+// Below this a chunk isn't worth a task.
+constexpr size_t kObjMinChunkBytes = 256 * 1024;
+
+void countChunk(ObjChunk &chunk) {
+    const char *const end = chunk.end;
+    for (const char *p = chunk.begin; p < end; p = nextLine(p, end)) {
+        switch (lineTag(p, end)) {
+        case ObjLine::Position: ++chunk.positions; break;
+        case ObjLine::Normal: ++chunk.normals; break;
+        case ObjLine::Texcoord: ++chunk.texcoords; break;
+        case ObjLine::Face: {
+            size_t corners = 0;
+            while (true) {
+                p = skipBlanks(p, end);
+                if (p >= end || *p == '\n') break;
+                ++corners;
+                while (p < end && !isSpace(*p)) ++p;
+            }
+            if (corners >= 3) {
+                chunk.triangles += corners - 2;
+                chunk.corners += corners;
+            }
+            break;
+        }
+        case ObjLine::Other: break;
+        }
+    }
+}
+
+// Fills the chunk's slots of the element arrays, and its triangles with
+// indices into chunk.keys. Stops at the first out-of-range index.
+void parseChunk(ObjChunk &chunk, float *positions, float *normals, float *texcoords, uint32_t *indices) {
+    const char *const end = chunk.end;
+    CornerSet corners(chunk.corners);
+    uint32_t *outIndex = indices + chunk.triangleBase * 3;
+    // Elements read so far in the whole file, as relative indices count them
+    int positionsRead = static_cast<int>(chunk.positionBase);
+    int normalsRead = static_cast<int>(chunk.normalBase);
+    int texcoordsRead = static_cast<int>(chunk.texcoordBase);
+
+    for (const char *p = chunk.begin; p < end; p = nextLine(p, end)) {
+        switch (lineTag(p, end)) {
+        case ObjLine::Position: {
+            float *dst = &positions[static_cast<size_t>(positionsRead++) * 3];
+            dst[0] = parseFloat(p, end);
+            dst[1] = parseFloat(p, end);
+            dst[2] = parseFloat(p, end);
+            break;
+        }
+        case ObjLine::Normal: {
+            Vec3 n;
+            n.x = parseFloat(p, end);
+            n.y = parseFloat(p, end);
+            n.z = parseFloat(p, end);
+            n = normalize(n);
+            float *dst = &normals[static_cast<size_t>(normalsRead++) * 3];
+            dst[0] = n.x; dst[1] = n.y; dst[2] = n.z;
+            break;
+        }
+        case ObjLine::Texcoord: {
+            float *dst = &texcoords[static_cast<size_t>(texcoordsRead++) * 2];
+            dst[0] = parseFloat(p, end);
+            dst[1] = parseFloat(p, end);
+            break;
+        }
+        case ObjLine::Face: {
+            // Fan from the first corner: (0, k-1, k) for k >= 2
+            uint32_t first = 0, prev = 0;
+            int count = 0;
+            while (true) {
+                p = skipBlanks(p, end);
+                if (p >= end || *p == '\n') break;
+                int v, t, n;
+                parseCorner(p, end, v, t, n);
+                Corner c{resolveIndex(v, positionsRead), resolveIndex(t, texcoordsRead),
+                         resolveIndex(n, normalsRead)};
+                if (c.v < 0 || c.v >= positionsRead || c.n >= normalsRead || (n != 0 && c.n < 0)) {
+                    chunk.badIndex = true;
+                    return;
+                }
+                if (c.t < 0 || c.t >= texcoordsRead) c.t = -1; // read as (0, 0), like a missing texcoord
+                const uint32_t index = corners.insert(c);
+                if (count >= 2) {
+                    outIndex[0] = first;
+                    outIndex[1] = prev;
+                    outIndex[2] = index;
+                    outIndex += 3;
+                }
+                if (count == 0) first = index;
+                prev = index;
+                ++count;
+            }
+            break;
+        }
+        case ObjLine::Other: break;
+        }
+    }
+    chunk.keys = std::move(corners.keys);
+}
+
+// Numbers the distinct corners of all chunks by first use in the file, as
+// one serial pass would, and rewrites each chunk's triangles from its own
+// key indices to those numbers. Corners are sharded by hash so the shards
+// deduplicate in parallel; each walks the chunks in file order, so the
+// earliest chunk using a corner owns it, and each chunk's owned corners take
+// the next numbers in its own first-use order.
+std::vector<Corner> mergeChunkCorners(std::vector<ObjChunk> &chunks, uint32_t *indices) {
+    constexpr int kShardBits = 6;
+    constexpr int kShards = 1 << kShardBits;
+    const int chunkCount = static_cast<int>(chunks.size());
+    auto forChunks = [&](const std::function<void(int)> &fn) {
+        parallelFor(chunkCount, 1, [&](int begin, int end) {
+            for (int c = begin; c < end; ++c) fn(c);
+        });
+    };
+    auto pack = [](int c, size_t k) { return (static_cast<uint64_t>(c) << 32) | k; };
+
+    // Each chunk's keys grouped by shard
+    std::vector<std::vector<uint32_t>> shardStart(chunkCount), byShard(chunkCount);
+    forChunks([&](int c) {
+        const std::vector<Corner> &keys = chunks[c].keys;
+        std::vector<uint8_t> shard(keys.size());
+        std::vector<uint32_t> &start = shardStart[c];
+        start.assign(kShards + 1, 0);
+        for (size_t k = 0; k < keys.size(); ++k) {
+            shard[k] = static_cast<uint8_t>(cornerHash(keys[k]) >> (64 - kShardBits));
+            ++start[shard[k] + 1];
+        }
+        for (int b = 0; b < kShards; ++b) start[b + 1] += start[b];
+        std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+        byShard[c].resize(keys.size());
+        for (size_t k = 0; k < keys.size(); ++k) byShard[c][fill[shard[k]]++] = static_cast<uint32_t>(k);
+    });
+
+    // Owner (chunk, key) of every chunk key
+    std::vector<std::vector<uint64_t>> owner(chunkCount);
+    for (int c = 0; c < chunkCount; ++c) owner[c].resize(chunks[c].keys.size());
+    parallelFor(kShards, 1, [&](int begin, int end) {
+        for (int b = begin; b < end; ++b) {
+            size_t capacity = 0;
+            for (int c = 0; c < chunkCount; ++c) capacity += shardStart[c][b + 1] - shardStart[c][b];
+            CornerSet seen(capacity);
+            std::vector<uint64_t> first;
+            first.reserve(capacity);
+            for (int c = 0; c < chunkCount; ++c) {
+                for (uint32_t j = shardStart[c][b]; j < shardStart[c][b + 1]; ++j) {
+                    const uint32_t k = byShard[c][j];
+                    const size_t known = seen.keys.size();
+                    const uint32_t id = seen.insert(chunks[c].keys[k]);
+                    if (id == known) first.push_back(pack(c, k));
+                    owner[c][k] = first[id];
+                }
+            }
+        }
+    });
+
+    std::vector<size_t> base(chunkCount + 1, 0);
+    forChunks([&](int c) {
+        for (size_t k = 0; k < owner[c].size(); ++k) base[c + 1] += owner[c][k] == pack(c, k);
+    });
+    for (int c = 0; c < chunkCount; ++c) base[c + 1] += base[c];
+
+    std::vector<Corner> keys(base[chunkCount]);
+    std::vector<std::vector<uint32_t>> renumber(chunkCount);
+    forChunks([&](int c) {
+        renumber[c].resize(owner[c].size());
+        size_t next = base[c];
+        for (size_t k = 0; k < owner[c].size(); ++k) {
+            if (owner[c][k] != pack(c, k)) continue;
+            keys[next] = chunks[c].keys[k];
+            renumber[c][k] = static_cast<uint32_t>(next++);
+        }
+    });
+    forChunks([&](int c) {
+        for (size_t k = 0; k < owner[c].size(); ++k) {
+            const uint64_t o = owner[c][k];
+            if (o != pack(c, k)) renumber[c][k] = renumber[o >> 32][static_cast<uint32_t>(o)];
+        }
+        uint32_t *index = indices + chunks[c].triangleBase * 3;
+        for (size_t i = 0; i < chunks[c].triangles * 3; ++i) index[i] = renumber[c][index[i]];
+    });
+    return keys;
+}
+
+} // namespace
+
+MeshData loadObj(const std::string &path, bool parallel) {
+    MappedFile file;
+    if (!file.open(path)) throw std::runtime_error("Failed to open OBJ: " + path);
+
+    // Line-aligned chunks, a few per worker so uneven ones balance out
+    size_t chunkCount = 1;
+    if (parallel) {
+        chunkCount = std::max<size_t>(1, std::min(static_cast<size_t>(workerThreadCount()) * 4,
+                                                  file.size() / kObjMinChunkBytes));
+    }
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char *p = file.begin();
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char *split = file.begin() + file.size() * (i + 1) / chunkCount;
+        if (i + 1 < chunkCount && split > p) split = nextLine(split - 1, file.end());
+        chunks[i].begin = p;
+        chunks[i].end = std::max(split, p);
+        p = chunks[i].end;
+    }
+    auto forEachChunk = [&](const std::function<void(ObjChunk &)> &fn) {
+        if (chunkCount == 1) {
+            fn(chunks[0]);
+            return;
+        }
+        parallelFor(static_cast<int>(chunkCount), 1, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) fn(chunks[i]);
+        });
+    };
+
+    // Counting pass: element and triangle totals, so nothing below grows,
+    // and each chunk's place in them
+    forEachChunk(countChunk);
+    size_t positionCount = 0, normalCount = 0, texcoordCount = 0, triangleCount = 0;
+    for (ObjChunk &chunk : chunks) {
+        chunk.positionBase = positionCount;
+        chunk.normalBase = normalCount;
+        chunk.texcoordBase = texcoordCount;
+        chunk.triangleBase = triangleCount;
+        positionCount += chunk.positions;
+        normalCount += chunk.normals;
+        texcoordCount += chunk.texcoords;
+        triangleCount += chunk.triangles;
+    }
+
+    std::vector<float> positions(positionCount * 3);
+    std::vector<float> normals(normalCount * 3);
+    std::vector<float> texcoords(texcoordCount * 2);
+    MeshData mesh;
+    mesh.indices.resize(triangleCount * 3);
+    forEachChunk([&](ObjChunk &chunk) {
+        parseChunk(chunk, positions.data(), normals.data(), texcoords.data(), mesh.indices.data());
+    });
+    for (const ObjChunk &chunk : chunks) {
+        if (chunk.badIndex) throw std::runtime_error("OBJ face index out of range: " + path);
+    }
+
+    // Distinct corners become vertices, numbered by first use in the file
+    std::vector<Corner> keys = chunkCount == 1 ? std::move(chunks[0].keys)
+                                               : mergeChunkCorners(chunks, mesh.indices.data());
+
+    mesh.vertices.resize(keys.size() * kObjVertexFloats);
+    auto assemble = [&](int begin, int end) {
+        float *out = mesh.vertices.data() + static_cast<size_t>(begin) * kObjVertexFloats;
+        for (int i = begin; i < end; ++i) {
+            const Corner &c = keys[i];
+            const float *pos = &positions[static_cast<size_t>(c.v) * 3];
+            out[0] = pos[0]; out[1] = pos[1]; out[2] = pos[2];
+            if (c.n >= 0) {
+                const float *nrm = &normals[static_cast<size_t>(c.n) * 3];
+                out[3] = nrm[0]; out[4] = nrm[1]; out[5] = nrm[2];
+            } else {
+                out[3] = 0.0f; out[4] = 1.0f; out[5] = 0.0f;
+            }
+            if (c.t >= 0) {
+                out[6] = texcoords[static_cast<size_t>(c.t) * 2];
+                out[7] = texcoords[static_cast<size_t>(c.t) * 2 + 1];
+            } else {
+                out[6] = 0.0f; out[7] = 0.0f;
+            }
+            out += kObjVertexFloats;
+        }
+    };
+    const int vertexCount = static_cast<int>(keys.size());
+    if (chunkCount > 1) {
+        parallelFor(vertexCount, 16384, assemble);
+    } else {
+        assemble(0, vertexCount);
+    }
+    return mesh;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Wavefront OBJ parsing, kept apart from GL so tools and the bench can load
+// models headless (Mesh.* uploads the result). The file is memory-mapped and
+// scanned in place: a counting pass sizes every output, then numbers are
+// read with std::from_chars straight out of the mapping. Large files are
+// split into line-aligned chunks that are counted and parsed across the
+// worker pool.
+
+constexpr int kObjVertexFloats = 8; // position, normal, texcoord
+constexpr int kMaxMeshLods = 4;
+
+// One level of detail: a range of the index buffer over the shared
+// vertices, and how far (RMS, model units) its surface strays from LOD 0.
+struct MeshLod {
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f;
+};
+
+struct MeshData {
+    std::vector<float> vertices;  // kObjVertexFloats per vertex
+    std::vector<uint32_t> indices; // three per triangle
+    std::vector<MeshLod> lods;     // finest first (buildMeshLods); empty: indices is the only level
+};
+
+// One vertex per distinct position/texcoord/normal index triple among the
+// face corners (hashed as they are read), indexed in file order; see
+// MeshOptimize.hpp for reordering. Polygons are triangulated as fans,
+// negative (relative) indices are resolved, a corner without a normal gets
+// +Y and one without a texcoord (0, 0). Throws std::runtime_error when the
+// file can't be read or an index is out of range. The result is the same
+// with or without parallel, whatever the worker count.
+MeshData loadObj(const std::string &path, bool parallel = true);
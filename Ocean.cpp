@@ -0,0 +1,442 @@
+#include "Ocean.hpp"
+#include "Parallel.hpp"
+#include "Simd.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr float kGravity = 9.81f;
+constexpr int kNumFields = 4;          // packed complex FFTs per update
+constexpr float kFoamJacobian = 0.6f;  // surface folds (foam) below this
+constexpr int kOceanHeightIters = 8;
+constexpr float kOceanHeightTolerance = 1e-3f;
+// Frequencies are snapped to multiples of 2 pi / kOceanLoopSeconds so the
+// animation loops and time can be wrapped before it loses float precision.
+constexpr double kOceanLoopSeconds = 256.0;
+
+// Baseline-ISA lane for the per-frame phase rows (no separate AVX2 unit needed;
+// the FFTs dominate).
+#if WATER_HAVE_SSE2
+using OceanLane = LaneSse;
+#elif WATER_HAVE_NEON
+using OceanLane = LaneNeon;
+#else
+using OceanLane = LaneScalar;
+#endif
+
+struct OceanState {
+    OceanParams params;
+    int n = 0;
+    bool valid = false;
+    std::vector<float> h0Re, h0Im;   // h0(k)
+    std::vector<float> h0mRe, h0mIm; // conj(h0(-k))
+    std::vector<float> omega;        // deep-water dispersion sqrt(g k), quantized
+    std::vector<float> kAxis;        // wavenumber per grid index, shared by x and z
+    // Two real fields per complex FFT (P + iQ), see updateOcean.
+    std::vector<float> re[kNumFields], im[kNumFields];
+    std::vector<int> bitrev;
+    std::vector<float> twRe, twIm;   // stage twiddles: [half + j] = exp(+i pi j / half)
+    std::vector<float> disp;
+    std::vector<float> normalFoam;
+};
+
+OceanState g_ocean;
+OceanStats g_oceanStats;
+
+float directionalSpectrum(const OceanParams &p, float kx, float kz) {
+    const float k = std::sqrt(kx * kx + kz * kz);
+    if (k < 1e-6f) return 0.0f;
+
+    // One-sided cos^2 spreading around the wind (waves travel downwind).
+    const Vec3 wind = normalize(Vec3(p.windDir.x, 0.0f, p.windDir.z));
+    const float cosTheta = (kx * wind.x + kz * wind.z) / k;
+    if (cosTheta <= 0.0f) return 0.0f;
+    const float spread = (2.0f / kPi) * cosTheta * cosTheta;
+
+    float sk = 0.0f; // omnidirectional wavenumber spectrum S(k)
+    if (p.spectrum == OceanSpectrum::Phillips) {
+        // S(omega) = a g^2 / omega^5 -> S(k) = a / (2 k^3), with the wind cutoff.
+        const float windLen = p.windSpeed * p.windSpeed / kGravity;
+        const float small = windLen * 1e-3f;
+        sk = 0.0081f / (2.0f * k * k * k) * std::exp(-1.0f / (k * windLen * k * windLen)) *
+             std::exp(-k * k * small * small);
+    } else {
+        // Fetch-limited JONSWAP (Hasselmann et al. 1973) mapped to k via
+        // S(k) = S(omega) * d(omega)/dk, d(omega)/dk = g / (2 omega).
+        const float u = std::max(p.windSpeed, 0.5f);
+        const float alpha = 0.076f * std::pow(u * u / (p.fetch * kGravity), 0.22f);
+        const float wp = 22.0f * std::cbrt(kGravity * kGravity / (u * p.fetch));
+        const float w = std::sqrt(kGravity * k);
+        const float sigma = (w <= wp) ? 0.07f : 0.09f;
+        const float r = std::exp(-(w - wp) * (w - wp) / (2.0f * sigma * sigma * wp * wp));
+        const float sw = alpha * kGravity * kGravity / std::pow(w, 5.0f) *
+                         std::exp(-1.25f * std::pow(wp / w, 4.0f)) * std::pow(p.gamma, r);
+        sk = sw * kGravity / (2.0f * w);
+    }
+    // S(k, theta) dk dtheta = S(k, theta) / k dkx dkz
+    return sk * spread / k;
+}
+
+// cos/sin(omega * t) for one row; n is a multiple of every lane width.
+template <class L>
+void phaseRow(const float *omega, float time, int n, float *outCos, float *outSin) {
+    using F = typename L::F;
+    const F t = L::set1(time);
+    for (int i = 0; i < n; i += L::kWidth) {
+        F sn, c;
+        L::sincos(L::mul(L::load(omega + i), t), sn, c);
+        L::store(outCos + i, c);
+        L::store(outSin + i, sn);
+    }
+}
+
+// In-place inverse FFT of one contiguous row (unnormalized, exp(+i)).
+void fftRow(float *re, float *im) {
+    const int n = g_ocean.n;
+    const int *rev = g_ocean.bitrev.data();
+    for (int i = 0; i < n; ++i) {
+        const int j = rev[i];
+        if (j > i) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        const int half = len >> 1;
+        const float *wr = &g_ocean.twRe[half];
+        const float *wi = &g_ocean.twIm[half];
+        for (int i = 0; i < n; i += len) {
+            float *ar = re + i, *ai = im + i;
+            float *br = ar + half, *bi = ai + half;
+            for (int j = 0; j < half; ++j) {
+                const float tr = br[j] * wr[j] - bi[j] * wi[j];
+                const float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+// Column FFTs for columns [c0, c1): the same butterflies applied to whole row
+// segments, so memory is walked contiguously and the inner loop vectorizes.
+void fftColumns(float *re, float *im, int c0, int c1) {
+    const int n = g_ocean.n;
+    const int *rev = g_ocean.bitrev.data();
+    for (int i = 0; i < n; ++i) {
+        const int j = rev[i];
+        if (j > i) {
+            float *ri = re + static_cast<size_t>(i) * n, *rj = re + static_cast<size_t>(j) * n;
+            float *ii = im + static_cast<size_t>(i) * n, *ij = im + static_cast<size_t>(j) * n;
+            for (int c = c0; c < c1; ++c) {
+                std::swap(ri[c], rj[c]);
+                std::swap(ii[c], ij[c]);
+            }
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        const int half = len >> 1;
+        for (int i = 0; i < n; i += len) {
+            for (int j = 0; j < half; ++j) {
+                const float wr = g_ocean.twRe[half + j];
+                const float wi = g_ocean.twIm[half + j];
+                float *ar = re + static_cast<size_t>(i + j) * n;
+                float *ai = im + static_cast<size_t>(i + j) * n;
+                float *br = ar + static_cast<size_t>(half) * n;
+                float *bi = ai + static_cast<size_t>(half) * n;
+                for (int c = c0; c < c1; ++c) {
+                    const float tr = br[c] * wr - bi[c] * wi;
+                    const float ti = br[c] * wi + bi[c] * wr;
+                    br[c] = ar[c] - tr;
+                    bi[c] = ai[c] - ti;
+                    ar[c] += tr;
+                    ai[c] += ti;
+                }
+            }
+        }
+    }
+}
+
+// Bilinear, wrapping sample of an RGBA map at world XZ.
+void sampleMap(const std::vector<float> &map, float x, float z, float out[4]) {
+    const int n = g_ocean.n;
+    const float scale = n / g_ocean.params.patchSize;
+    const float gx = x * scale;
+    const float gz = z * scale;
+    const float fx0 = std::floor(gx);
+    const float fz0 = std::floor(gz);
+    const float fx = gx - fx0;
+    const float fz = gz - fz0;
+    const int i0 = static_cast<int>(fx0) & (n - 1);
+    const int j0 = static_cast<int>(fz0) & (n - 1);
+    const int i1 = (i0 + 1) & (n - 1);
+    const int j1 = (j0 + 1) & (n - 1);
+    const float *p00 = &map[(static_cast<size_t>(j0) * n + i0) * 4];
+    const float *p10 = &map[(static_cast<size_t>(j0) * n + i1) * 4];
+    const float *p01 = &map[(static_cast<size_t>(j1) * n + i0) * 4];
+    const float *p11 = &map[(static_cast<size_t>(j1) * n + i1) * 4];
+    for (int c = 0; c < 4; ++c) {
+        const float a = p00[c] + (p10[c] - p00[c]) * fx;
+        const float b = p01[c] + (p11[c] - p01[c]) * fx;
+        out[c] = a + (b - a) * fz;
+    }
+}
+
+// Rest-plane point whose displaced position lies above (x, z); see
+// gerstnerHeightLanes for the iteration.
+int invertDisplacement(float x, float z, float &px, float &pz, float d[4]) {
+    px = x;
+    pz = z;
+    sampleMap(g_ocean.disp, px, pz, d);
+    int iters = 0;
+    while (iters < kOceanHeightIters) {
+        const float ex = px + d[0] - x;
+        const float ez = pz + d[2] - z;
+        if (std::fabs(ex) <= kOceanHeightTolerance && std::fabs(ez) <= kOceanHeightTolerance) break;
+        px -= ex;
+        pz -= ez;
+        sampleMap(g_ocean.disp, px, pz, d);
+        ++iters;
+    }
+    return iters;
+}
+
+} // namespace
+
+void initOcean(const OceanParams &params) {
+    OceanState &s = g_ocean;
+    s.params = params;
+    int n = kOceanMinRes;
+    while (n < params.resolution && n < kOceanMaxRes) n <<= 1;
+    s.params.resolution = n;
+    s.n = n;
+    const size_t total = static_cast<size_t>(n) * n;
+
+    int logN = 0;
+    while ((1 << logN) < n) ++logN;
+    s.bitrev.resize(n);
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < logN; ++b) r |= ((i >> b) & 1) << (logN - 1 - b);
+        s.bitrev[i] = r;
+    }
+    s.twRe.assign(n, 0.0f);
+    s.twIm.assign(n, 0.0f);
+    for (int half = 1; half < n; half <<= 1) {
+        for (int j = 0; j < half; ++j) {
+            const double a = 3.14159265358979323846 * j / half;
+            s.twRe[half + j] = static_cast<float>(std::cos(a));
+            s.twIm[half + j] = static_cast<float>(std::sin(a));
+        }
+    }
+
+    // Grid index i holds wavenumber 2 pi (i - N/2) / L.
+    const float dk = 2.0f * kPi / params.patchSize;
+    s.kAxis.resize(n);
+    for (int i = 0; i < n; ++i) s.kAxis[i] = dk * static_cast<float>(i - n / 2);
+
+    s.h0Re.assign(total, 0.0f);
+    s.h0Im.assign(total, 0.0f);
+    s.omega.assign(total, 0.0f);
+    std::mt19937 rng(params.seed);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
+            const size_t idx = static_cast<size_t>(j) * n + i;
+            const float kx = s.kAxis[i];
+            const float kz = s.kAxis[j];
+            // The Nyquist row/column has no -k partner on the grid; leave it empty
+            // so every field stays real after the inverse FFT.
+            const float spectrum = (i == 0 || j == 0) ? 0.0f : directionalSpectrum(s.params, kx, kz);
+            const float amp = params.amplitude * std::sqrt(0.5f * spectrum * dk * dk);
+            const float xr = gauss(rng);
+            const float xi = gauss(rng);
+            s.h0Re[idx] = xr * amp;
+            s.h0Im[idx] = xi * amp;
+            const float w0 = static_cast<float>(2.0 * 3.14159265358979323846 / kOceanLoopSeconds);
+            s.omega[idx] = std::floor(std::sqrt(kGravity * std::sqrt(kx * kx + kz * kz)) / w0) * w0;
+        }
+    }
+    s.h0mRe.resize(total);
+    s.h0mIm.resize(total);
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
+            const size_t idx = static_cast<size_t>(j) * n + i;
+            const size_t neg = static_cast<size_t>((n - j) & (n - 1)) * n + ((n - i) & (n - 1));
+            s.h0mRe[idx] = s.h0Re[neg];
+            s.h0mIm[idx] = -s.h0Im[neg];
+        }
+    }
+
+    for (int f = 0; f < kNumFields; ++f) {
+        s.re[f].assign(total, 0.0f);
+        s.im[f].assign(total, 0.0f);
+    }
+    s.disp.assign(total * 4, 0.0f);
+    s.normalFoam.assign(total * 4, 0.0f);
+    s.valid = false;
+}
+
+const OceanParams &oceanParams() {
+    return g_ocean.params;
+}
+
+int oceanResolution() {
+    return g_ocean.n;
+}
+
+void updateOcean(float time, bool parallel) {
+    OceanState &s = g_ocean;
+    if (s.n == 0) initOcean(OceanParams());
+    const auto start = std::chrono::steady_clock::now();
+    const int n = s.n;
+    const float lambda = s.params.choppiness;
+    const float loopTime = static_cast<float>(std::fmod(static_cast<double>(time), kOceanLoopSeconds));
+    auto run = [&](int count, int grain, const std::function<void(int, int)> &fn) {
+        if (parallel) parallelFor(count, grain, fn);
+        else fn(0, count);
+    };
+
+    // h(k, t) and its derived fields, packed two real outputs per FFT:
+    // 0 = height + i dx, 1 = dz + i dh/dx, 2 = dh/dz + i ddx/dx, 3 = ddz/dz + i ddx/dz.
+    run(n, 8, [&](int begin, int end) {
+        std::vector<float> rowCos(n), rowSin(n);
+        for (int j = begin; j < end; ++j) {
+            const float kz = s.kAxis[j];
+            phaseRow<OceanLane>(&s.omega[static_cast<size_t>(j) * n], loopTime, n,
+                                rowCos.data(), rowSin.data());
+            for (int i = 0; i < n; ++i) {
+                const size_t idx = static_cast<size_t>(j) * n + i;
+                const float kx = s.kAxis[i];
+                const float k = std::sqrt(kx * kx + kz * kz);
+                const float c = rowCos[i];
+                const float sn = rowSin[i];
+                // h0 e^{iwt} + conj(h0(-k)) e^{-iwt}
+                const float hr = s.h0Re[idx] * c - s.h0Im[idx] * sn + s.h0mRe[idx] * c + s.h0mIm[idx] * sn;
+                const float hi = s.h0Re[idx] * sn + s.h0Im[idx] * c - s.h0mRe[idx] * sn + s.h0mIm[idx] * c;
+                const float invK = k > 1e-6f ? 1.0f / k : 0.0f;
+                // -i k/|k| h (choppy displacement) and i k h (slopes)
+                const float dxr = lambda * kx * invK * hi, dxi = -lambda * kx * invK * hr;
+                const float dzr = lambda * kz * invK * hi, dzi = -lambda * kz * invK * hr;
+                const float sxr = -kx * hi, sxi = kx * hr;
+                const float szr = -kz * hi, szi = kz * hr;
+                const float jxx = lambda * kx * kx * invK, jzz = lambda * kz * kz * invK;
+                const float jxz = lambda * kx * kz * invK;
+                // P + iQ = (P.re - Q.im, P.im + Q.re)
+                s.re[0][idx] = hr - dxi;           s.im[0][idx] = hi + dxr;
+                s.re[1][idx] = dzr - sxi;          s.im[1][idx] = dzi + sxr;
+                s.re[2][idx] = szr - jxx * hi;     s.im[2][idx] = szi + jxx * hr;
+                s.re[3][idx] = jzz * hr - jxz * hi; s.im[3][idx] = jzz * hi + jxz * hr;
+            }
+        }
+    });
+
+    const auto fftStart = std::chrono::steady_clock::now();
+    run(n * kNumFields, 8, [&](int begin, int end) {
+        for (int r = begin; r < end; ++r) {
+            const int f = r / n;
+            const size_t row = static_cast<size_t>(r % n) * n;
+            fftRow(&s.re[f][row], &s.im[f][row]);
+        }
+    });
+    // Columns go in chunks of 16 (one cache line of each row per task).
+    const int colChunks = std::max(1, n / 16);
+    run(colChunks * kNumFields, 1, [&](int begin, int end) {
+        for (int t = begin; t < end; ++t) {
+            const int f = t / colChunks;
+            const int chunk = t % colChunks;
+            fftColumns(s.re[f].data(), s.im[f].data(), chunk * n / colChunks, (chunk + 1) * n / colChunks);
+        }
+    });
+    const auto fftEnd = std::chrono::steady_clock::now();
+
+    run(n, 16, [&](int begin, int end) {
+        for (int j = begin; j < end; ++j) {
+            for (int i = 0; i < n; ++i) {
+                const size_t idx = static_cast<size_t>(j) * n + i;
+                // Undo the N/2 shift of the spectrum: (-1)^(i + j).
+                const float sign = ((i + j) & 1) ? -1.0f : 1.0f;
+                const float h = sign * s.re[0][idx];
+                const float dx = sign * s.im[0][idx];
+                const float dz = sign * s.re[1][idx];
+                const float sx = sign * s.im[1][idx];
+                const float sz = sign * s.re[2][idx];
+                const float jxx = sign * s.im[2][idx];
+                const float jzz = sign * s.re[3][idx];
+                const float jxz = sign * s.im[3][idx];
+
+                float *d = &s.disp[idx * 4];
+                d[0] = dx; d[1] = h; d[2] = dz; d[3] = 0.0f;
+
+                const float invLen = 1.0f / std::sqrt(sx * sx + 1.0f + sz * sz);
+                const float jacobian = (1.0f + jxx) * (1.0f + jzz) - jxz * jxz;
+                float *nf = &s.normalFoam[idx * 4];
+                nf[0] = -sx * invLen; nf[1] = invLen; nf[2] = -sz * invLen;
+                nf[3] = std::clamp((kFoamJacobian - jacobian) * 4.0f, 0.0f, 1.0f);
+            }
+        }
+    });
+    s.valid = true;
+
+    const auto end = std::chrono::steady_clock::now();
+    g_oceanStats.fftMs = std::chrono::duration<float, std::milli>(fftEnd - fftStart).count();
+    g_oceanStats.updateMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+const OceanStats &oceanStats() {
+    return g_oceanStats;
+}
+
+const float *oceanDisplacementMap() {
+    return g_ocean.disp.data();
+}
+
+const float *oceanNormalFoamMap() {
+    return g_ocean.normalFoam.data();
+}
+
+float oceanHeight(float x, float z) {
+    float y = 0.0f;
+    oceanHeightBatch(&x, &z, 1, &y);
+    return y;
+}
+
+Vec3 oceanGradient(float x, float z) {
+    float y, sx, sz;
+    oceanHeightBatch(&x, &z, 1, &y, &sx, &sz);
+    return Vec3(sx, 0.0f, sz);
+}
+
+int oceanHeightBatch(const float *x, const float *z, int n, float *outY,
+                     float *outSlopeX, float *outSlopeZ) {
+    const bool slopes = outSlopeX && outSlopeZ;
+    if (!g_ocean.valid) {
+        std::fill(outY, outY + n, 0.0f);
+        if (slopes) {
+            std::fill(outSlopeX, outSlopeX + n, 0.0f);
+            std::fill(outSlopeZ, outSlopeZ + n, 0.0f);
+        }
+        return 0;
+    }
+    int maxIters = 0;
+    for (int i = 0; i < n; ++i) {
+        float px, pz, d[4];
+        maxIters = std::max(maxIters, invertDisplacement(x[i], z[i], px, pz, d));
+        outY[i] = d[1];
+        if (slopes) {
+            // The normal map holds the spectral (exact) normal at the rest point.
+            float nf[4];
+            sampleMap(g_ocean.normalFoam, px, pz, nf);
+            const float ny = std::max(nf[1], 1e-3f);
+            outSlopeX[i] = -nf[0] / ny;
+            outSlopeZ[i] = -nf[2] / ny;
+        }
+    }
+    return maxIters;
+}
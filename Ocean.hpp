@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Math.hpp"
+
+// Tessendorf FFT ocean: a statistical wave spectrum on an N x N grid that
+// tiles every patchSize metres. Each update evaluates the spectrum at time t
+// and runs inverse 2D FFTs (rows and columns split across the worker pool)
+// into displacement, normal and foam maps for the water shaders and the
+// gameplay height queries.
+
+enum class OceanSpectrum { Phillips, Jonswap };
+
+struct OceanParams {
+    int resolution = 256;          // N, power of two in [kOceanMinRes, kOceanMaxRes]
+    float patchSize = 48.0f;       // metres covered by one tile
+    float windSpeed = 7.0f;        // m/s at 10 m
+    Vec3 windDir = Vec3(1.0f, 0.0f, 0.3f);
+    float fetch = 8000.0f;         // metres (JONSWAP only)
+    float gamma = 3.3f;            // JONSWAP peak enhancement
+    float amplitude = 1.0f;        // overall height scale
+    float choppiness = 0.9f;       // horizontal displacement scale (lambda)
+    OceanSpectrum spectrum = OceanSpectrum::Jonswap;
+    unsigned seed = 1750;
+};
+
+constexpr int kOceanMinRes = 64;
+constexpr int kOceanMaxRes = 512;
+
+struct OceanStats {
+    float fftMs = 0.0f;    // inverse FFTs only
+    float updateMs = 0.0f; // spectrum evaluation + FFTs + map assembly
+};
+
+// Rebuilds the initial spectrum h0(k); the resolution is clamped and rounded
+// up to a power of two.
+void initOcean(const OceanParams &params);
+const OceanParams &oceanParams();
+int oceanResolution();
+
+// Advances the maps to time t. parallel = false keeps everything on the caller.
+void updateOcean(float time, bool parallel = true);
+const OceanStats &oceanStats();
+
+// Maps from the last update, row-major N x N texels (row = z), RGBA floats:
+// displacement = (dx, dy, dz, 0), normalFoam = (nx, ny, nz, foam in [0, 1]).
+const float *oceanDisplacementMap();
+const float *oceanNormalFoamMap();
+
+// Gameplay queries in world XZ, heights relative to the rest plane. The
+// horizontal (choppy) displacement is inverted like evalGerstnerHeight, so
+// the height is the surface directly above (x, z). Batch returns the most
+// iterations any point needed; slopes (dh/dx, dh/dz) are filled when both
+// outputs are given.
+float oceanHeight(float x, float z);
+Vec3 oceanGradient(float x, float z); // (dh/dx, 0, dh/dz)
+int oceanHeightBatch(const float *x, const float *z, int n, float *outY,
+                     float *outSlopeX = nullptr, float *outSlopeZ = nullptr);
@@ -0,0 +1,133 @@
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+thread_local bool t_inWorkerTask = false;
+
+class WorkerPool {
+public:
+    ~WorkerPool() { stop(); }
+
+    void resize(int threads) {
+        std::lock_guard<std::mutex> submit(submitMutex_);
+        stop();
+        if (threads <= 0) {
+            threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        quit_ = false;
+        for (int i = 1; i < threads; ++i) {
+            workers_.emplace_back([this, gen = generation_] { workerLoop(gen); });
+        }
+        threadCount_ = threads;
+    }
+
+    int threadCount() const { return threadCount_; }
+
+    void run(int count, int grain, const std::function<void(int, int)> &fn) {
+        std::lock_guard<std::mutex> submit(submitMutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            fn_ = &fn;
+            count_ = count;
+            grain_ = grain;
+            next_.store(0);
+            pending_ = static_cast<int>(workers_.size());
+            ++generation_;
+        }
+        wakeCv_.notify_all();
+        runChunks();
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCv_.wait(lock, [this] { return pending_ == 0; });
+        fn_ = nullptr;
+    }
+
+private:
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            quit_ = true;
+        }
+        wakeCv_.notify_all();
+        for (std::thread &t : workers_) t.join();
+        workers_.clear();
+        threadCount_ = 1;
+    }
+
+    void runChunks() {
+        const bool wasInTask = t_inWorkerTask;
+        t_inWorkerTask = true;
+        for (;;) {
+            const int begin = next_.fetch_add(grain_);
+            if (begin >= count_) break;
+            (*fn_)(begin, std::min(begin + grain_, count_));
+        }
+        t_inWorkerTask = wasInTask;
+    }
+
+    void workerLoop(uint64_t seen) {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeCv_.wait(lock, [&] { return quit_ || generation_ != seen; });
+                if (quit_) return;
+                seen = generation_;
+            }
+            runChunks();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --pending_;
+            }
+            doneCv_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    int threadCount_ = 1;
+    std::mutex submitMutex_;
+    std::mutex mutex_;
+    std::condition_variable wakeCv_;
+    std::condition_variable doneCv_;
+    const std::function<void(int, int)> *fn_ = nullptr;
+    int count_ = 0;
+    int grain_ = 1;
+    std::atomic<int> next_{0};
+    int pending_ = 0;
+    uint64_t generation_ = 0;
+    bool quit_ = false;
+};
+
+WorkerPool &pool() {
+    static WorkerPool p;
+    static const bool started = (p.resize(0), true);
+    (void)started;
+    return p;
+}
+
+} // namespace
+
+int workerThreadCount() {
+    return pool().threadCount();
+}
+
+void setWorkerThreadCount(int threads) {
+    pool().resize(threads);
+}
+
+void parallelFor(int count, int grain, const std::function<void(int, int)> &fn) {
+    if (count <= 0) return;
+    grain = std::max(1, grain);
+    WorkerPool &p = pool();
+    if (count <= grain || t_inWorkerTask || p.threadCount() <= 1) {
+        fn(0, count);
+        return;
+    }
+    p.run(count, grain, fn);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <functional>
+
+// Small persistent worker pool for data-parallel loops. The calling thread
+// takes part in the work; nested calls from inside a task run serially.
+
+// Number of threads used by parallelFor, including the caller.
+int workerThreadCount();
+// Resizes the pool (1 = run everything on the caller). 0 = hardware default.
+void setWorkerThreadCount(int threads);
+
+// Splits [0, count) into chunks of at least grain items and calls
+// fn(begin, end) for each chunk across the pool. Returns when all are done.
+void parallelFor(int count, int grain, const std::function<void(int, int)> &fn);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+// Counter-based random numbers: each draw is a pure function of (seed,
+// stream, counter), so a simulation that gives every agent its own stream
+// produces the same results in any update order or thread count, on any
+// platform (unlike std::rand).
+
+// SplitMix64 finalizer; a good 64-bit mixing function on its own.
+inline uint64_t splitMix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+struct CounterRng {
+    uint64_t key = 0;
+    uint64_t counter = 0;
+
+    // One stream per (seed, stream, step): e.g. a fish id and a frame number.
+    CounterRng(uint64_t seed, uint64_t stream, uint64_t step = 0)
+        : key(splitMix64(splitMix64(seed ^ splitMix64(stream)) ^ step)) {}
+
+    uint32_t nextU32() { return static_cast<uint32_t>(splitMix64(key + 0x632be59bd9b4e019ull * ++counter) >> 32); }
+    // [0, 1) with 24 random bits
+    float uniform() { return static_cast<float>(nextU32() >> 8) * (1.0f / 16777216.0f); }
+    float uniform(float a, float b) { return a + (b - a) * uniform(); }
+};
@@ -1,4 +1,6 @@
 #include "Rod.hpp"
+#include "Events.hpp"
+#include "WaterField.hpp"
 #include <cmath>
 
 void startRodCharge(Rod &r) {
@@ -46,9 +48,7 @@ void updateRod(Rod &r, float dt, float timef, float waterHeight) {
     // If already splashed, pin it near the surface briefly then remove.
     if (!r.flying) {
         r.timer += dt;
-        Vec3 sample(r.pos.x, 0.0f, r.pos.z);
-        Vec3 surf = evalGerstnerXZ(sample, timef);
-        float surfaceY = waterHeight + surf.y + rippleFieldHeight(sample, timef);
+        float surfaceY = waterHeight + surfaceHeight(r.pos.x, r.pos.z);
         r.pos.y = surfaceY + 0.05f;
         if (r.timer > 2.0f) {
             r.active = false;
@@ -64,15 +64,14 @@ void updateRod(Rod &r, float dt, float timef, float waterHeight) {
     r.vel = r.vel * drag;
     r.pos += r.vel * dt;
 
-    Vec3 sample(r.pos.x, 0.0f, r.pos.z);
-    Vec3 surf = evalGerstnerXZ(sample, timef);
-    float surfaceY = waterHeight + surf.y + rippleFieldHeight(sample, timef);
+    float surfaceY = waterHeight + surfaceHeight(r.pos.x, r.pos.z);
     if (r.pos.y < surfaceY + 0.05f) {
         r.pos.y = surfaceY + 0.05f;
-        r.vel.y = 0.0f;
         if (r.flying) {
             addRipple(Vec3(r.pos.x, waterHeight, r.pos.z), timef); // small ripple at impact
+            pushGameEvent(GameEventType::LureSplash, r.pos, length(r.vel) / 10.0f, timef);
         }
+        r.vel.y = 0.0f;
         r.flying = false; // stop bouncing; stays once
     }
 
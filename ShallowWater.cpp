@@ -0,0 +1,368 @@
+#include "ShallowWater.hpp"
+#include "Parallel.hpp"
+#include "Simd.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace {
+
+constexpr float kGravity = 9.81f;
+constexpr float kBodyPush = 0.12f;  // height rate per m/s of body speed against the water
+constexpr float kBodyHeave = 0.5f;  // height rate per m/s of body sinking
+constexpr float kMaxCourant = 0.5f; // c dt / dx; the explicit scheme needs < 1/sqrt(2)
+
+// The stencils are memory-bound; the baseline-ISA lane is enough (as for
+// the ocean phase rows).
+#if WATER_HAVE_SSE2
+using SweLane = LaneSse;
+#elif WATER_HAVE_NEON
+using SweLane = LaneNeon;
+#else
+using SweLane = LaneScalar;
+#endif
+
+struct ShallowWaterState {
+    ShallowWaterParams params;
+    int n = 0;
+    float originX = 0.0f; // world XZ of cell (0, 0)'s centre
+    float originZ = 0.0f;
+    bool placed = false;
+    float timeAccum = 0.0f;
+    std::vector<float> h;      // height above rest
+    std::vector<float> u;      // x velocity on the face between cells i and i + 1
+    std::vector<float> w;      // z velocity on the face between rows j and j + 1
+    std::vector<float> sponge; // per-cell decay toward the border
+    std::vector<float> keep;   // sponge with body cells zeroed (solid)
+    std::vector<float> zeroRow;
+    std::vector<float> scratch;
+    std::vector<float> map;
+    std::vector<std::pair<int, float>> bodyRates; // cell, height rate from moving bodies
+};
+
+ShallowWaterState g_swe;
+ShallowWaterStats g_sweStats;
+
+// vel[i] = (vel[i] + a (h0[i] - h1[i])) * k0[i] * k1[i]: face velocity from
+// the height difference across it; a solid cell on either side closes the
+// face, which reflects the wave.
+template <class L>
+void faceRow(float *vel, const float *h0, const float *h1, const float *k0, const float *k1,
+             int count, float a) {
+    using F = typename L::F;
+    constexpr int W = L::kWidth;
+    const F va = L::set1(a);
+    int i = 0;
+    for (; i + W <= count; i += W) {
+        const F dh = L::sub(L::load(h0 + i), L::load(h1 + i));
+        const F v = L::madd(va, dh, L::load(vel + i));
+        L::store(vel + i, L::mul(v, L::mul(L::load(k0 + i), L::load(k1 + i))));
+    }
+    for (; i < count; ++i) {
+        vel[i] = (vel[i] + a * (h0[i] - h1[i])) * k0[i] * k1[i];
+    }
+}
+
+// h[i] = (h[i] - b (u[i] - uLeft[i] + w[i] - wUp[i])) * keep[i] * decay: the
+// height follows the net flux through the cell's four faces.
+template <class L>
+void heightRow(float *h, const float *u, const float *uLeft, const float *w, const float *wUp,
+               const float *keep, int count, float b, float decay) {
+    using F = typename L::F;
+    constexpr int W = L::kWidth;
+    const F vb = L::set1(-b);
+    const F vd = L::set1(decay);
+    int i = 0;
+    for (; i + W <= count; i += W) {
+        const F div = L::add(L::sub(L::load(u + i), L::load(uLeft + i)),
+                             L::sub(L::load(w + i), L::load(wUp + i)));
+        const F hn = L::madd(vb, div, L::load(h + i));
+        L::store(h + i, L::mul(hn, L::mul(L::load(keep + i), vd)));
+    }
+    for (; i < count; ++i) {
+        h[i] = (h[i] - b * (u[i] - uLeft[i] + w[i] - wUp[i])) * keep[i] * decay;
+    }
+}
+
+// Moves the contents by whole cells so the grid stays on the world lattice;
+// cells scrolled in start flat.
+void shiftField(std::vector<float> &field, std::vector<float> &tmp, int n, int di, int dj) {
+    tmp.assign(field.size(), 0.0f);
+    for (int j = 0; j < n; ++j) {
+        const int sj = j + dj;
+        if (sj < 0 || sj >= n) continue;
+        const int i0 = std::max(0, -di);
+        const int i1 = std::min(n, n - di);
+        if (i1 <= i0) continue;
+        std::memcpy(&tmp[static_cast<size_t>(j) * n + i0],
+                    &field[static_cast<size_t>(sj) * n + i0 + di],
+                    sizeof(float) * (i1 - i0));
+    }
+    field.swap(tmp);
+}
+
+void recentre(const Vec3 &center) {
+    ShallowWaterState &s = g_swe;
+    const float cell = s.params.cellSize;
+    const float ox = std::floor(center.x / cell - 0.5f * s.n) * cell;
+    const float oz = std::floor(center.z / cell - 0.5f * s.n) * cell;
+    if (!s.placed) {
+        s.originX = ox;
+        s.originZ = oz;
+        s.placed = true;
+        return;
+    }
+    const int di = static_cast<int>(std::lround((ox - s.originX) / cell));
+    const int dj = static_cast<int>(std::lround((oz - s.originZ) / cell));
+    if (di == 0 && dj == 0) return;
+    shiftField(s.h, s.scratch, s.n, di, dj);
+    shiftField(s.u, s.scratch, s.n, di, dj);
+    shiftField(s.w, s.scratch, s.n, di, dj);
+    s.originX += di * cell;
+    s.originZ += dj * cell;
+}
+
+// Solid cells under each body, plus the height each pushes into the ring of
+// water just outside it: the leading side rises, the trailing side drops,
+// and a sinking body raises the water around it.
+void applyBodies(const SweBody *bodies, int bodyCount) {
+    ShallowWaterState &s = g_swe;
+    const int n = s.n;
+    const float cell = s.params.cellSize;
+    s.keep = s.sponge;
+    s.bodyRates.clear();
+    for (int b = 0; b < bodyCount; ++b) {
+        const SweBody &body = bodies[b];
+        const float radius = std::max(body.radius, 0.5f * cell);
+        const float ring = std::max(2.0f * cell, 0.5f * radius);
+        const float reach = radius + ring;
+        const int i0 = std::max(0, static_cast<int>(std::floor((body.pos.x - reach - s.originX) / cell)));
+        const int i1 = std::min(n - 1, static_cast<int>(std::ceil((body.pos.x + reach - s.originX) / cell)));
+        const int j0 = std::max(0, static_cast<int>(std::floor((body.pos.z - reach - s.originZ) / cell)));
+        const int j1 = std::min(n - 1, static_cast<int>(std::ceil((body.pos.z + reach - s.originZ) / cell)));
+        for (int j = j0; j <= j1; ++j) {
+            for (int i = i0; i <= i1; ++i) {
+                const float dx = s.originX + i * cell - body.pos.x;
+                const float dz = s.originZ + j * cell - body.pos.z;
+                const float r = std::sqrt(dx * dx + dz * dz);
+                const int idx = j * n + i;
+                if (r < radius) {
+                    s.keep[idx] = 0.0f;
+                } else if (r < reach) {
+                    const float falloff = 1.0f - (r - radius) / ring;
+                    const float push = (body.vel.x * dx + body.vel.z * dz) / r;
+                    const float rate = (kBodyPush * push - kBodyHeave * body.vel.y) * falloff;
+                    if (rate != 0.0f) s.bodyRates.emplace_back(idx, rate);
+                }
+            }
+        }
+    }
+}
+
+void step(float dt, const std::function<void(int, int, const std::function<void(int, int)> &)> &run) {
+    ShallowWaterState &s = g_swe;
+    const int n = s.n;
+    const float depth = s.params.waveSpeed * s.params.waveSpeed / kGravity;
+    const float a = kGravity * dt / s.params.cellSize;
+    const float b = depth * dt / s.params.cellSize;
+    const float decay = std::exp(-s.params.damping * dt);
+
+    for (const auto &br : s.bodyRates) s.h[br.first] += br.second * dt;
+
+    run(n, 16, [&](int begin, int end) {
+        for (int j = begin; j < end; ++j) {
+            const size_t row = static_cast<size_t>(j) * n;
+            faceRow<SweLane>(&s.u[row], &s.h[row], &s.h[row + 1], &s.keep[row], &s.keep[row + 1],
+                             n - 1, a);
+            if (j + 1 < n) {
+                faceRow<SweLane>(&s.w[row], &s.h[row], &s.h[row + n], &s.keep[row], &s.keep[row + n],
+                                 n, a);
+            }
+        }
+    });
+    run(n, 16, [&](int begin, int end) {
+        for (int j = begin; j < end; ++j) {
+            const size_t row = static_cast<size_t>(j) * n;
+            const float *wUp = j > 0 ? &s.w[row - n] : s.zeroRow.data();
+            // Cell 0 has a closed left face; the rest go through the kernel.
+            s.h[row] = (s.h[row] - b * (s.u[row] + s.w[row] - wUp[0])) * s.keep[row] * decay;
+            heightRow<SweLane>(&s.h[row + 1], &s.u[row + 1], &s.u[row], &s.w[row + 1], wUp + 1,
+                               &s.keep[row + 1], n - 1, b, decay);
+        }
+    });
+}
+
+void buildMap(const std::function<void(int, int, const std::function<void(int, int)> &)> &run) {
+    ShallowWaterState &s = g_swe;
+    const int n = s.n;
+    const float inv2 = 0.5f / s.params.cellSize;
+    run(n, 16, [&](int begin, int end) {
+        for (int j = begin; j < end; ++j) {
+            const float *row = &s.h[static_cast<size_t>(j) * n];
+            const float *up = &s.h[static_cast<size_t>(std::max(j - 1, 0)) * n];
+            const float *dn = &s.h[static_cast<size_t>(std::min(j + 1, n - 1)) * n];
+            float *m = &s.map[static_cast<size_t>(j) * n * 4];
+            for (int i = 0; i < n; ++i) {
+                const int il = std::max(i - 1, 0);
+                const int ir = std::min(i + 1, n - 1);
+                m[i * 4 + 0] = row[i];
+                m[i * 4 + 1] = (row[ir] - row[il]) * inv2;
+                m[i * 4 + 2] = (dn[i] - up[i]) * inv2;
+                m[i * 4 + 3] = 0.0f;
+            }
+        }
+    });
+}
+
+} // namespace
+
+void initShallowWater(const ShallowWaterParams &params) {
+    ShallowWaterState &s = g_swe;
+    s.params = params;
+    int n = kSweMinRes;
+    while (n < params.resolution && n < kSweMaxRes) n *= 2;
+    s.params.resolution = n;
+    s.params.cellSize = std::max(params.cellSize, 1e-3f);
+    // Keep the explicit scheme stable whatever the requested rate.
+    s.params.stepHz = std::max(params.stepHz, params.waveSpeed / (kMaxCourant * s.params.cellSize));
+    s.n = n;
+    const size_t total = static_cast<size_t>(n) * n;
+    s.h.assign(total, 0.0f);
+    s.u.assign(total, 0.0f);
+    s.w.assign(total, 0.0f);
+    s.map.assign(total * 4, 0.0f);
+    s.zeroRow.assign(n, 0.0f);
+    s.sponge.assign(total, 1.0f);
+    const int border = std::max(1, std::min(params.spongeCells, n / 4));
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
+            const int d = std::min(std::min(i, n - 1 - i), std::min(j, n - 1 - j));
+            if (d < border) {
+                const float t = 1.0f - static_cast<float>(d) / border;
+                s.sponge[static_cast<size_t>(j) * n + i] = 1.0f - 0.15f * t * t;
+            }
+        }
+    }
+    s.keep = s.sponge;
+    s.bodyRates.clear();
+    s.placed = false;
+    s.timeAccum = 0.0f;
+}
+
+const ShallowWaterParams &shallowWaterParams() {
+    return g_swe.params;
+}
+
+int shallowWaterResolution() {
+    return g_swe.n;
+}
+
+void updateShallowWater(const Vec3 &center, float dt, const SweBody *bodies, int bodyCount,
+                        bool parallel) {
+    ShallowWaterState &s = g_swe;
+    if (s.n == 0) initShallowWater(ShallowWaterParams());
+    const auto start = std::chrono::steady_clock::now();
+    auto run = [parallel](int count, int grain, const std::function<void(int, int)> &fn) {
+        if (parallel) parallelFor(count, grain, fn);
+        else fn(0, count);
+    };
+
+    recentre(center);
+    applyBodies(bodies, bodyCount);
+
+    const float stepDt = 1.0f / s.params.stepHz;
+    s.timeAccum += std::max(dt, 0.0f);
+    int steps = static_cast<int>(s.timeAccum / stepDt);
+    if (steps > kSweMaxSubsteps) {
+        steps = kSweMaxSubsteps;
+        s.timeAccum = 0.0f; // a long frame: drop the backlog rather than spiral
+    } else {
+        s.timeAccum -= steps * stepDt;
+    }
+    const auto stepStart = std::chrono::steady_clock::now();
+    for (int k = 0; k < steps; ++k) step(stepDt, run);
+    const auto stepEnd = std::chrono::steady_clock::now();
+    buildMap(run);
+
+    g_sweStats.steps = steps;
+    g_sweStats.stepMs = steps > 0
+        ? std::chrono::duration<float, std::milli>(stepEnd - stepStart).count() / steps
+        : 0.0f;
+    g_sweStats.updateMs = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+const ShallowWaterStats &shallowWaterStats() {
+    return g_sweStats;
+}
+
+void shallowWaterImpulse(float x, float z, float radius, float height) {
+    ShallowWaterState &s = g_swe;
+    if (s.n == 0 || !s.placed) return;
+    const float cell = s.params.cellSize;
+    radius = std::max(radius, cell);
+    const int i0 = std::max(0, static_cast<int>(std::floor((x - radius - s.originX) / cell)));
+    const int i1 = std::min(s.n - 1, static_cast<int>(std::ceil((x + radius - s.originX) / cell)));
+    const int j0 = std::max(0, static_cast<int>(std::floor((z - radius - s.originZ) / cell)));
+    const int j1 = std::min(s.n - 1, static_cast<int>(std::ceil((z + radius - s.originZ) / cell)));
+    for (int j = j0; j <= j1; ++j) {
+        for (int i = i0; i <= i1; ++i) {
+            const float dx = s.originX + i * cell - x;
+            const float dz = s.originZ + j * cell - z;
+            const float r = std::sqrt(dx * dx + dz * dz);
+            if (r >= radius) continue;
+            s.h[static_cast<size_t>(j) * s.n + i] += height * 0.5f * (1.0f + std::cos(kPi * r / radius));
+        }
+    }
+}
+
+const float *shallowWaterMap() {
+    return g_swe.map.data();
+}
+
+void shallowWaterOrigin(float &originX, float &originZ) {
+    originX = g_swe.originX;
+    originZ = g_swe.originZ;
+}
+
+void shallowWaterSample(float x, float z, float &height, float &slopeX, float &slopeZ) {
+    const ShallowWaterState &s = g_swe;
+    height = slopeX = slopeZ = 0.0f;
+    if (s.n == 0 || !s.placed) return;
+    const float gx = (x - s.originX) / s.params.cellSize;
+    const float gz = (z - s.originZ) / s.params.cellSize;
+    const float maxCoord = static_cast<float>(s.n - 1);
+    if (!(gx >= 0.0f && gz >= 0.0f && gx < maxCoord && gz < maxCoord)) return;
+    const int i0 = static_cast<int>(gx);
+    const int j0 = static_cast<int>(gz);
+    const float fx = gx - i0;
+    const float fz = gz - j0;
+    const float *p00 = &s.map[(static_cast<size_t>(j0) * s.n + i0) * 4];
+    const float *p10 = p00 + 4;
+    const float *p01 = p00 + static_cast<size_t>(s.n) * 4;
+    const float *p11 = p01 + 4;
+    float out[3];
+    for (int c = 0; c < 3; ++c) {
+        const float top = p00[c] + (p10[c] - p00[c]) * fx;
+        const float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+        out[c] = top + (bottom - top) * fz;
+    }
+    height = out[0];
+    slopeX = out[1];
+    slopeZ = out[2];
+}
+
+float shallowWaterHeight(float x, float z) {
+    float h, sx, sz;
+    shallowWaterSample(x, z, h, sx, sz);
+    return h;
+}
+
+Vec3 shallowWaterGradient(float x, float z) {
+    float h, sx, sz;
+    shallowWaterSample(x, z, h, sx, sz);
+    return Vec3(sx, 0.0f, sz);
+}
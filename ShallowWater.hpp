@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Math.hpp"
+
+// Linearized shallow-water equations on a square grid that follows the
+// player: heights at cell centres, velocities on the faces between cells
+// (staggered), advanced with a fixed timestep. Floating bodies are solid cells
+// the waves reflect off; impacts and moving bodies inject height. An
+// alternative to the analytic ripple rings (Stone.*), which pass through each
+// other and ignore obstacles.
+
+struct ShallowWaterParams {
+    int resolution = 256;    // cells per side, power of two in [kSweMinRes, kSweMaxRes]
+    float cellSize = 0.1f;   // metres
+    float waveSpeed = 1.2f;  // sqrt(g * depth), m/s
+    float damping = 0.35f;   // amplitude decay, 1/s
+    float stepHz = 120.0f;   // fixed timestep rate
+    int spongeCells = 16;    // absorbing border so waves leave the grid quietly
+};
+
+constexpr int kSweMinRes = 64;
+constexpr int kSweMaxRes = 1024;
+constexpr int kSweMaxSubsteps = 4; // per update; longer frames drop time
+
+// Disk footprint of a floating body; vel pushes water ahead of and around it.
+struct SweBody {
+    Vec3 pos;
+    Vec3 vel;
+    float radius = 0.5f;
+};
+
+struct ShallowWaterStats {
+    float updateMs = 0.0f; // whole update: recentre, bodies, steps, map
+    float stepMs = 0.0f;   // average per fixed step
+    int steps = 0;         // fixed steps in the last update
+};
+
+void initShallowWater(const ShallowWaterParams &params);
+const ShallowWaterParams &shallowWaterParams();
+int shallowWaterResolution();
+
+// Re-centres the grid on center (whole-cell shifts), marks the bodies as
+// obstacles, injects their motion and advances by dt in fixed steps.
+// parallel = false keeps everything on the caller.
+void updateShallowWater(const Vec3 &center, float dt, const SweBody *bodies, int bodyCount,
+                        bool parallel = true);
+const ShallowWaterStats &shallowWaterStats();
+
+// Cosine-shaped height change of peak `height` (negative = crater) within
+// radius of (x, z), e.g. a stone or lure hitting the water.
+void shallowWaterImpulse(float x, float z, float radius, float height);
+
+// Map from the last update, row-major N x N texels (row = z), RGBA floats:
+// (height, dh/dx, dh/dz, 0). Texel (0, 0) is centred on (originX, originZ).
+const float *shallowWaterMap();
+void shallowWaterOrigin(float &originX, float &originZ);
+
+// Bilinear samples of the map; zero outside the grid.
+void shallowWaterSample(float x, float z, float &height, float &slopeX, float &slopeZ);
+float shallowWaterHeight(float x, float z);
+Vec3 shallowWaterGradient(float x, float z); // (dh/dx, 0, dh/dz)
@@ -0,0 +1,53 @@
+#include "Simd.hpp"
+
+const char *simdPathName(SimdPath path) {
+    switch (path) {
+    case SimdPath::Scalar: return "scalar";
+    case SimdPath::SSE:    return "sse2";
+    case SimdPath::AVX2:   return "avx2";
+    case SimdPath::NEON:   return "neon";
+    }
+    return "unknown";
+}
+
+bool simdPathAvailable(SimdPath path) {
+    switch (path) {
+    case SimdPath::Scalar:
+        return true;
+    case SimdPath::SSE:
+#if WATER_HAVE_SSE2
+        return true;
+#else
+        return false;
+#endif
+    case SimdPath::AVX2:
+        // The AVX2 kernels live in *Avx2.cpp files built with -mavx2 -mfma
+        // (see Makefile); still check the CPU before dispatching to them.
+#if defined(WATER_BUILD_AVX2) && (defined(__GNUC__) || defined(__clang__))
+        {
+            static const bool supported =
+                __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            return supported;
+        }
+#else
+        return false;
+#endif
+    case SimdPath::NEON:
+#if WATER_HAVE_NEON
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+SimdPath bestSimdPath() {
+    static const SimdPath best = [] {
+        if (simdPathAvailable(SimdPath::AVX2)) return SimdPath::AVX2;
+        if (simdPathAvailable(SimdPath::NEON)) return SimdPath::NEON;
+        if (simdPathAvailable(SimdPath::SSE)) return SimdPath::SSE;
+        return SimdPath::Scalar;
+    }();
+    return best;
+}
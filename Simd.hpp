@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Thin SIMD lane wrappers for the batched water kernels. Every lane type
+// exposes the same static interface so a kernel is written once as a template
+// and instantiated per instruction set. The scalar lane is the reference path.
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define WATER_HAVE_SSE2 1
+#endif
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define WATER_HAVE_AVX2 1
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define WATER_HAVE_NEON 1
+#endif
+
+enum class SimdPath { Scalar, SSE, AVX2, NEON };
+constexpr int kNumSimdPaths = 4;
+
+const char *simdPathName(SimdPath path);
+bool simdPathAvailable(SimdPath path);
+SimdPath bestSimdPath();
+
+struct LaneScalar {
+    using F = float;
+    static constexpr int kWidth = 1;
+    static F load(const float *p) { return *p; }
+    static void store(float *p, F v) { *p = v; }
+    static F set1(float v) { return v; }
+    static F add(F a, F b) { return a + b; }
+    static F sub(F a, F b) { return a - b; }
+    static F mul(F a, F b) { return a * b; }
+    static F div(F a, F b) { return a / b; }
+    static F madd(F a, F b, F c) { return a * b + c; }
+    static void sincos(F x, F &s, F &c) { s = std::sin(x); c = std::cos(x); }
+};
+
+// Polynomial sin/cos shared by the vector lanes: Cody-Waite reduction to
+// [-pi/4, pi/4] followed by the Cephes minimax polynomials (~1e-7 abs error).
+template <class L>
+inline void polySinCos(typename L::F x, typename L::F &s, typename L::F &c) {
+    using F = typename L::F;
+    using I = typename L::I;
+    const I q = L::roundToInt(L::mul(x, L::set1(0.63661977236758134f)));
+    const F qf = L::toFloat(q);
+    F r = L::madd(qf, L::set1(-1.5703125f), x);
+    r = L::madd(qf, L::set1(-4.837512969970703125e-4f), r);
+    r = L::madd(qf, L::set1(-7.54978995489188216e-8f), r);
+    const F r2 = L::mul(r, r);
+
+    F ps = L::madd(r2, L::set1(-1.9515295891e-4f), L::set1(8.3321608736e-3f));
+    ps = L::madd(ps, r2, L::set1(-1.6666654611e-1f));
+    ps = L::madd(L::mul(ps, r2), r, r);
+
+    F pc = L::madd(r2, L::set1(2.443315711809948e-5f), L::set1(-1.388731625493765e-3f));
+    pc = L::madd(pc, r2, L::set1(4.166664568298827e-2f));
+    pc = L::madd(L::mul(pc, r2), r2, L::madd(r2, L::set1(-0.5f), L::set1(1.0f)));
+
+    // Odd quadrants swap sin/cos; bit 1 of the quadrant flips the sign.
+    s = L::flipSign(L::selectOdd(q, pc, ps), q);
+    c = L::flipSign(L::selectOdd(q, ps, pc), L::addI(q, 1));
+}
+
+#if WATER_HAVE_SSE2
+struct LaneSse {
+    using F = __m128;
+    using I = __m128i;
+    static constexpr int kWidth = 4;
+    static F load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, F v) { _mm_storeu_ps(p, v); }
+    static F set1(float v) { return _mm_set1_ps(v); }
+    static F add(F a, F b) { return _mm_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm_div_ps(a, b); }
+    static F madd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static I roundToInt(F a) { return _mm_cvtps_epi32(a); }
+    static F toFloat(I a) { return _mm_cvtepi32_ps(a); }
+    static I addI(I a, int v) { return _mm_add_epi32(a, _mm_set1_epi32(v)); }
+    static F flipSign(F v, I q) {
+        const I bit = _mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30);
+        return _mm_xor_ps(v, _mm_castsi128_ps(bit));
+    }
+    static F selectOdd(I q, F odd, F even) {
+        const F isEven = _mm_castsi128_ps(
+            _mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_setzero_si128()));
+        return _mm_or_ps(_mm_and_ps(isEven, even), _mm_andnot_ps(isEven, odd));
+    }
+    static void sincos(F x, F &s, F &c) { polySinCos<LaneSse>(x, s, c); }
+};
+#endif
+
+#if WATER_HAVE_AVX2
+struct LaneAvx2 {
+    using F = __m256;
+    using I = __m256i;
+    static constexpr int kWidth = 8;
+    static F load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, F v) { _mm256_storeu_ps(p, v); }
+    static F set1(float v) { return _mm256_set1_ps(v); }
+    static F add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm256_div_ps(a, b); }
+    static F madd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+    static I roundToInt(F a) { return _mm256_cvtps_epi32(a); }
+    static F toFloat(I a) { return _mm256_cvtepi32_ps(a); }
+    static I addI(I a, int v) { return _mm256_add_epi32(a, _mm256_set1_epi32(v)); }
+    static F flipSign(F v, I q) {
+        const I bit = _mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30);
+        return _mm256_xor_ps(v, _mm256_castsi256_ps(bit));
+    }
+    static F selectOdd(I q, F odd, F even) {
+        const F isOdd = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+            _mm256_and_si256(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+        return _mm256_blendv_ps(even, odd, isOdd);
+    }
+    static void sincos(F x, F &s, F &c) { polySinCos<LaneAvx2>(x, s, c); }
+};
+#endif
+
+#if WATER_HAVE_NEON
+struct LaneNeon {
+    using F = float32x4_t;
+    using I = int32x4_t;
+    static constexpr int kWidth = 4;
+    static F load(const float *p) { return vld1q_f32(p); }
+    static void store(float *p, F v) { vst1q_f32(p, v); }
+    static F set1(float v) { return vdupq_n_f32(v); }
+    static F add(F a, F b) { return vaddq_f32(a, b); }
+    static F sub(F a, F b) { return vsubq_f32(a, b); }
+    static F mul(F a, F b) { return vmulq_f32(a, b); }
+    static F div(F a, F b) { return vdivq_f32(a, b); }
+    static F madd(F a, F b, F c) { return vfmaq_f32(c, a, b); }
+    static I roundToInt(F a) { return vcvtnq_s32_f32(a); }
+    static F toFloat(I a) { return vcvtq_f32_s32(a); }
+    static I addI(I a, int v) { return vaddq_s32(a, vdupq_n_s32(v)); }
+    static F flipSign(F v, I q) {
+        const uint32x4_t bit = vshlq_n_u32(vreinterpretq_u32_s32(vandq_s32(q, vdupq_n_s32(2))), 30);
+        return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v), bit));
+    }
+    static F selectOdd(I q, F odd, F even) {
+        const uint32x4_t isOdd = vtstq_s32(q, vdupq_n_s32(1));
+        return vbslq_f32(isOdd, odd, even);
+    }
+    static void sincos(F x, F &s, F &c) { polySinCos<LaneNeon>(x, s, c); }
+};
+#endif
@@ -1,118 +1,189 @@
 #include "Stone.hpp"
+#include "Events.hpp"
+#include "Parallel.hpp"
+#include "ShallowWater.hpp"
+#include "Simd.hpp"
+#include "WaterField.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <cmath>
+#include <functional>
 
-Stone g_stones[kMaxStones];
+StonePool g_stones;
+static StoneStats g_stoneStats;
 RippleEvent g_ripples[kMaxRipples];
 static int g_rippleWriteIndex = 0;
-static bool g_pendingSplash = false;
-static bool g_pendingWaterSplash = false;
-static bool g_pendingTinySplash = false;
-static bool g_pendingCubeHit = false;
-static bool g_pendingBoatHit = false;
-
-inline float singleRippleHeight(float r, float age) {
-    if (age < 0.0f || age > 2.5f) return 0.0f; // very short lifetime
+static std::vector<int> g_rippleCells[kRippleGridDim * kRippleGridDim];
+static std::vector<int> g_liveRipples; // slots with active set
+
+float singleRippleHeight(float r, float age, float radius) {
+    float dhdr;
+    return singleRippleHeight(r, age, radius, dhdr);
+}
+
+float singleRippleHeight(float r, float age, float radius, float &dhdr) {
+    dhdr = 0.0f;
+    if (age < 0.0f || age > kRippleLife || r >= radius) return 0.0f; // very short lifetime
     const float freq = 5.0f;   // lower frequency
     const float speed = 0.8f;  // slower propagation
     const float decay = 0.5f;
     const float scale = 0.05f; // smaller amplitude
-    float phase = freq * (r - speed * age);
-    float envelope = std::exp(-decay * r) * std::exp(-0.7f * age); // faster time decay
-    return scale * envelope * std::sin(phase);
+    const float phase = freq * (r - speed * age);
+    const float envelope = scale * std::exp(-decay * r) * std::exp(-0.7f * age); // faster time decay
+    const float s = std::sin(phase);
+    const float c = std::cos(phase);
+    dhdr = envelope * (freq * c - decay * s);
+    float h = envelope * s;
+    // Smoothstep fade over the outer quarter of the radius so a truncated
+    // ripple has no visible rim.
+    const float fadeStart = 0.75f * radius;
+    if (r > fadeStart) {
+        const float t = (r - fadeStart) / (radius - fadeStart);
+        const float fade = 1.0f - t * t * (3.0f - 2.0f * t);
+        const float dFade = -6.0f * t * (1.0f - t) / (radius - fadeStart);
+        dhdr = dhdr * fade + h * dFade;
+        h *= fade;
+    }
+    return h;
 }
 
-void addRipple(const Vec3 &pos, float time) {
-    RippleEvent &r = g_ripples[g_rippleWriteIndex];
-    r.pos = pos;
-    r.startTime = time;
-    r.active = true;
-    g_rippleWriteIndex = (g_rippleWriteIndex + 1) % kMaxRipples;
-    g_pendingSplash = true;
+namespace {
+
+int rippleCellCoord(float v) {
+    return static_cast<int>(std::floor(v * (1.0f / kRippleCellSize)));
 }
 
-void pruneRipples(float time) {
-    const float kLife = 2.5f; // very short ripple lifetime
-    for (int i = 0; i < kMaxRipples; ++i) {
-        if (!g_ripples[i].active) continue;
-        if (time - g_ripples[i].startTime > kLife) {
-            g_ripples[i].active = false;
-        }
+std::vector<int> &rippleCell(int cx, int cz) {
+    constexpr int mask = kRippleGridDim - 1;
+    return g_rippleCells[(cz & mask) * kRippleGridDim + (cx & mask)];
+}
+
+// Visits every grid cell the ripple's influence disk can touch (its bounding
+// square; kRippleMaxRadius keeps it narrower than the wrapping grid).
+template <class Fn>
+void forRippleCells(const RippleEvent &r, Fn fn) {
+    const int x0 = rippleCellCoord(r.pos.x - r.radius);
+    const int x1 = rippleCellCoord(r.pos.x + r.radius);
+    const int z0 = rippleCellCoord(r.pos.z - r.radius);
+    const int z1 = rippleCellCoord(r.pos.z + r.radius);
+    for (int cz = z0; cz <= z1; ++cz) {
+        for (int cx = x0; cx <= x1; ++cx) fn(rippleCell(cx, cz));
     }
 }
 
-float rippleFieldHeight(const Vec3 &pos, float time) {
-    float h = 0.0f;
-    for (int i = 0; i < kMaxRipples; ++i) {
-        if (!g_ripples[i].active) continue;
-        float age = time - g_ripples[i].startTime;
-        if (age < 0.0f || age > 8.0f) continue;
-        Vec3 d(pos.x - g_ripples[i].pos.x, 0.0f, pos.z - g_ripples[i].pos.z);
-        float r = std::sqrt(d.x * d.x + d.z * d.z);
-        h += singleRippleHeight(r, age);
+void unlinkRipple(int slot) {
+    forRippleCells(g_ripples[slot], [slot](std::vector<int> &cell) {
+        auto it = std::find(cell.begin(), cell.end(), slot);
+        if (it != cell.end()) {
+            *it = cell.back();
+            cell.pop_back();
+        }
+    });
+    g_ripples[slot].active = false;
+}
+
+// Calls fn(dx, dz, r, age, radius) for each live ripple reaching (x, z).
+template <class Fn>
+void forRipplesAt(float x, float z, float time, Fn fn) {
+    for (int slot : rippleCell(rippleCellCoord(x), rippleCellCoord(z))) {
+        const RippleEvent &rp = g_ripples[slot];
+        const float age = time - rp.startTime;
+        if (age < 0.0f || age > kRippleLife) continue;
+        const float dx = x - rp.pos.x;
+        const float dz = z - rp.pos.z;
+        const float d2 = dx * dx + dz * dz;
+        if (d2 > rp.radius * rp.radius) continue;
+        fn(dx, dz, std::sqrt(d2), age, rp.radius);
     }
-    return h;
 }
 
-Vec3 rippleFieldGrad(const Vec3 &pos, float time) {
-    const float eps = 0.1f;
-    float h0 = rippleFieldHeight(pos, time);
-    float hx = rippleFieldHeight(Vec3(pos.x + eps, pos.y, pos.z), time);
-    float hz = rippleFieldHeight(Vec3(pos.x, pos.y, pos.z + eps), time);
-    return Vec3((hx - h0) / eps, 0.0f, (hz - h0) / eps);
+} // namespace
+
+void addRipple(const Vec3 &pos, float time, float radius) {
+    const int slot = g_rippleWriteIndex;
+    g_rippleWriteIndex = (g_rippleWriteIndex + 1) % kMaxRipples;
+    if (g_ripples[slot].active) {
+        unlinkRipple(slot);
+        g_liveRipples.erase(std::find(g_liveRipples.begin(), g_liveRipples.end(), slot));
+    }
+    RippleEvent &r = g_ripples[slot];
+    r.pos = pos;
+    r.startTime = time;
+    r.radius = std::min(std::max(radius, 0.0f), kRippleMaxRadius);
+    r.active = true;
+    forRippleCells(r, [slot](std::vector<int> &cell) { cell.push_back(slot); });
+    g_liveRipples.push_back(slot);
+    // The same impact dents the shallow-water grid (no-op until it runs).
+    shallowWaterImpulse(pos.x, pos.z, 0.3f, -0.05f);
 }
 
-bool consumeStoneSplash() {
-    bool was = g_pendingSplash;
-    g_pendingSplash = false;
-    return was;
+void pruneRipples(float time) {
+    size_t kept = 0;
+    for (int slot : g_liveRipples) {
+        if (time - g_ripples[slot].startTime > kRippleLife) {
+            unlinkRipple(slot);
+        } else {
+            g_liveRipples[kept++] = slot;
+        }
+    }
+    g_liveRipples.resize(kept);
 }
 
-bool consumeWaterSplash() {
-    bool was = g_pendingWaterSplash;
-    g_pendingWaterSplash = false;
-    return was;
+void clearRipples() {
+    for (std::vector<int> &cell : g_rippleCells) cell.clear();
+    for (RippleEvent &r : g_ripples) r = RippleEvent();
+    g_liveRipples.clear();
+    g_rippleWriteIndex = 0;
 }
 
-bool consumeTinySplash() {
-    bool was = g_pendingTinySplash;
-    g_pendingTinySplash = false;
-    return was;
+int liveRippleCount() {
+    return static_cast<int>(g_liveRipples.size());
 }
 
-bool consumeCubeHit() {
-    bool was = g_pendingCubeHit;
-    g_pendingCubeHit = false;
-    return was;
+float rippleFieldHeight(const Vec3 &pos, float time) {
+    float h = 0.0f;
+    forRipplesAt(pos.x, pos.z, time, [&h](float, float, float r, float age, float radius) {
+        h += singleRippleHeight(r, age, radius);
+    });
+    return h;
 }
 
-bool consumeBoatHit() {
-    bool was = g_pendingBoatHit;
-    g_pendingBoatHit = false;
-    return was;
+Vec3 rippleFieldGrad(const Vec3 &pos, float time) {
+    Vec3 g(0.0f, 0.0f, 0.0f);
+    forRipplesAt(pos.x, pos.z, time, [&g](float dx, float dz, float r, float age, float radius) {
+        if (r < 1e-6f) return; // radial slope has no direction at the centre
+        float dhdr;
+        singleRippleHeight(r, age, radius, dhdr);
+        g.x += dhdr * dx / r;
+        g.z += dhdr * dz / r;
+    });
+    return g;
 }
 
-void spawnStone(const Vec3 &cameraPos, const Vec3 &forward, const Vec3 &up,
-                float angleDownDeg, float speed) {
-    int idx = -1;
-    for (int i = 0; i < kMaxStones; ++i) {
-        if (!g_stones[i].active) { idx = i; break; }
+int gatherRipples(float minX, float minZ, float maxX, float maxZ, float time,
+                  int *outSlots, int maxCount) {
+    static std::vector<int> candidates;
+    candidates.clear();
+    for (int slot : g_liveRipples) {
+        const RippleEvent &r = g_ripples[slot];
+        const float age = time - r.startTime;
+        if (age < 0.0f || age > kRippleLife) continue;
+        if (r.pos.x + r.radius < minX || r.pos.x - r.radius > maxX ||
+            r.pos.z + r.radius < minZ || r.pos.z - r.radius > maxZ) continue;
+        candidates.push_back(slot);
     }
-    if (idx < 0) {
-        float oldestLife = -1.0f;
-        for (int i = 0; i < kMaxStones; ++i) {
-            if (g_stones[i].life > oldestLife) {
-                oldestLife = g_stones[i].life;
-                idx = i;
-            }
-        }
+    const int count = std::min(static_cast<int>(candidates.size()), maxCount);
+    if (count < static_cast<int>(candidates.size())) {
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                          [](int a, int b) { return g_ripples[a].startTime > g_ripples[b].startTime; });
     }
+    std::copy(candidates.begin(), candidates.begin() + count, outSlots);
+    return count;
+}
 
-    Stone &s = g_stones[idx];
-    s.active = true;
-    s.bounces = 0;
-    s.life = 0.0f;
-
+void spawnStone(const Vec3 &cameraPos, const Vec3 &forward, const Vec3 &up,
+                float angleDownDeg, float speed) {
     Vec3 forwardFlat(forward.x, 0.0f, forward.z);
     if (length(forwardFlat) < 1e-3f) {
         forwardFlat = Vec3(0.0f, 0.0f, -1.0f);
@@ -124,103 +195,256 @@ void spawnStone(const Vec3 &cameraPos, const Vec3 &forward, const Vec3 &up,
         forwardFlat * std::cos(angleDown) +
         Vec3(0.0f, -std::sin(angleDown), 0.0f));
 
-    s.vel = throwDir * speed;
-    s.pos = cameraPos + forward * 0.5f + up * -0.1f;
+    spawnStoneAt(cameraPos + forward * 0.5f + up * -0.1f, throwDir * speed);
 }
 
-void updateStones(float dt, float timef, float waterHeight,
-                  Vec3 &cubePos, Vec3 &cube2Pos, float &cubeVelY, float &cube2VelY,
-                  const Vec3 &boatPos, float boatRadius) {
-    const Vec3 gravity(0.0f, -9.81f, 0.0f);
-
-    for (int i = 0; i < kMaxStones; ++i) {
-        Stone &s = g_stones[i];
-        if (!s.active) continue;
-
-        s.life += dt;
-        if (s.life > 10.0f) {
-            s.active = false;
-            continue;
-        }
-
-        Vec3 oldPos = s.pos;
-        Vec3 vel = s.vel;
-
-        vel = vel + gravity * dt;
-        Vec3 newPos = oldPos + vel * dt;
-
-        Vec3 sample(newPos.x, 0.0f, newPos.z);
-        Vec3 surf = evalGerstnerXZ(sample, timef);
-        float waterY = waterHeight + surf.y;
-
-        bool wasAbove = (oldPos.y > waterY);
-        bool isBelowOrOn = (newPos.y <= waterY);
-
-        if (wasAbove && isBelowOrOn && vel.y < 0.0f) {
-            float vMag = length(vel);
-            float horizMag = std::sqrt(vel.x * vel.x + vel.z * vel.z);
-            float alpha = (horizMag > 1e-4f) ? std::atan2(-vel.y, horizMag) : 0.0f;
-            float alphaDeg = alpha * 180.0f / kPi;
+void spawnStoneAt(const Vec3 &pos, const Vec3 &vel) {
+    StonePool &s = g_stones;
+    int idx = s.count;
+    if (idx < kMaxStones) {
+        ++s.count;
+    } else {
+        idx = static_cast<int>(std::max_element(s.life, s.life + s.count) - s.life);
+    }
+    s.posX[idx] = pos.x;
+    s.posY[idx] = pos.y;
+    s.posZ[idx] = pos.z;
+    s.velX[idx] = vel.x;
+    s.velY[idx] = vel.y;
+    s.velZ[idx] = vel.z;
+    s.life[idx] = 0.0f;
+    s.surfY[idx] = surfaceHeight(pos.x, pos.z);
+    s.bounces[idx] = 0;
+}
 
-            const float minSpeed = 5.0f;
-            const float maxAngleDeg = 30.0f;
-            const int maxBounces = 8;
+void clearStones() {
+    g_stones.count = 0;
+}
 
-            if (vMag > minSpeed && alphaDeg < maxAngleDeg && s.bounces < maxBounces) {
-                Vec3 n(0.0f, 1.0f, 0.0f);
-                float vn = dot(vel, n);
-                Vec3 vN = n * vn;
-                Vec3 vT = vel - vN;
+Vec3 stonePosition(int i) {
+    return Vec3(g_stones.posX[i], g_stones.posY[i], g_stones.posZ[i]);
+}
 
-                const float normalRestitution = 0.6f;
-                const float tangentBase = 0.9f;
-                float tangentDamping = tangentBase - 0.04f * static_cast<float>(s.bounces);
-                if (tangentDamping < 0.6f) tangentDamping = 0.6f;
+const StoneStats &stoneStats() {
+    return g_stoneStats;
+}
 
-                vN = vN * (-normalRestitution);
-                vT = vT * tangentDamping;
+namespace {
+
+constexpr float kStoneGravity = -9.81f;
+constexpr int kNoHit = -2;
+constexpr int kHitWater = -1; // otherwise the collider index
+
+// Integration is a few multiply-adds per stone and memory-bound; the
+// baseline-ISA lane is enough.
+#if WATER_HAVE_SSE2
+using StoneLane = LaneSse;
+#elif WATER_HAVE_NEON
+using StoneLane = LaneNeon;
+#else
+using StoneLane = LaneScalar;
+#endif
+
+// Per-update scratch, indexed like the pool.
+struct StoneScratch {
+    alignas(32) float newX[kMaxStones];
+    alignas(32) float newY[kMaxStones];
+    alignas(32) float newZ[kMaxStones];
+    alignas(32) float newSurf[kMaxStones];
+    float hitT[kMaxStones];
+    int hit[kMaxStones];
+    bool dead[kMaxStones];
+};
+StoneScratch g_stoneScratch;
+
+// Semi-implicit Euler: v += g dt, p' = p + v dt (p' goes to the scratch so
+// the old position is still there for the sweep).
+template <class L>
+int integrateStones(StonePool &s, StoneScratch &t, int begin, int end, float dt) {
+    using F = typename L::F;
+    const F vdt = L::set1(dt);
+    const F gdt = L::set1(kStoneGravity * dt);
+    int i = begin;
+    for (; i + L::kWidth <= end; i += L::kWidth) {
+        const F vy = L::add(L::load(&s.velY[i]), gdt);
+        L::store(&s.velY[i], vy);
+        L::store(&s.life[i], L::add(L::load(&s.life[i]), vdt));
+        L::store(&t.newX[i], L::madd(L::load(&s.velX[i]), vdt, L::load(&s.posX[i])));
+        L::store(&t.newY[i], L::madd(vy, vdt, L::load(&s.posY[i])));
+        L::store(&t.newZ[i], L::madd(L::load(&s.velZ[i]), vdt, L::load(&s.posZ[i])));
+    }
+    return i;
+}
 
-                vel = vN + vT;
-                newPos.y = waterY + 0.02f;
+// Entry parameter in [0, 1] of the segment p + t d into a sphere or cube
+// (0 when it starts inside), or -1 when it misses.
+float sweepCollider(const StoneCollider &c, const Vec3 &p, const Vec3 &d) {
+    const Vec3 m = p - c.pos;
+    if (!c.box) {
+        const float cc = dot(m, m) - c.radius * c.radius;
+        if (cc <= 0.0f) return 0.0f;
+        const float a = dot(d, d);
+        const float b = dot(m, d);
+        if (b >= 0.0f || a < 1e-12f) return -1.0f;
+        const float disc = b * b - a * cc;
+        if (disc < 0.0f) return -1.0f;
+        const float t = (-b - std::sqrt(disc)) / a;
+        return t <= 1.0f ? t : -1.0f;
+    }
+    // Slab test against the cube
+    float tMin = 0.0f, tMax = 1.0f;
+    const float mc[3] = {m.x, m.y, m.z};
+    const float dc[3] = {d.x, d.y, d.z};
+    for (int k = 0; k < 3; ++k) {
+        if (std::fabs(dc[k]) < 1e-12f) {
+            if (std::fabs(mc[k]) >= c.radius) return -1.0f;
+            continue;
+        }
+        const float inv = 1.0f / dc[k];
+        float t0 = (-c.radius - mc[k]) * inv;
+        float t1 = (c.radius - mc[k]) * inv;
+        if (t0 > t1) std::swap(t0, t1);
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax) return -1.0f;
+    }
+    return tMin;
+}
 
-                s.bounces++;
+} // namespace
 
-                addRipple(Vec3(newPos.x, waterHeight, newPos.z), timef);
-                g_pendingWaterSplash = true;
-            } else {
-                g_pendingTinySplash = true;
-                s.active = false;
-                continue;
+void updateStones(float dt, float timef, float waterHeight,
+                  StoneCollider *colliders, int colliderCount, bool parallel) {
+    const auto start = std::chrono::steady_clock::now();
+    StonePool &s = g_stones;
+    StoneScratch &t = g_stoneScratch;
+    for (int c = 0; c < colliderCount; ++c) {
+        colliders[c].hits = 0;
+        colliders[c].push = Vec3();
+    }
+    auto run = [parallel](int count, int grain, const std::function<void(int, int)> &fn) {
+        if (parallel) parallelFor(count, grain, fn);
+        else fn(0, count);
+    };
+
+    // Integrate, sample the surface under the new positions and find each
+    // stone's first contact along its path. Stones without one move on here.
+    run(s.count, 1024, [&](int begin, int end) {
+        int i = integrateStones<StoneLane>(s, t, begin, end, dt);
+        integrateStones<LaneScalar>(s, t, i, end, dt);
+        surfaceHeightBatch(&t.newX[begin], &t.newZ[begin], end - begin, &t.newSurf[begin]);
+
+        for (i = begin; i < end; ++i) {
+            t.dead[i] = s.life[i] > kStoneLifetime;
+            t.hit[i] = kNoHit;
+            t.hitT[i] = 2.0f;
+            const Vec3 p(s.posX[i], s.posY[i], s.posZ[i]);
+            const Vec3 d = Vec3(t.newX[i], t.newY[i], t.newZ[i]) - p;
+
+            // Water: height above the surface, linear along the path
+            const float f0 = p.y - (waterHeight + s.surfY[i]);
+            const float f1 = t.newY[i] - (waterHeight + t.newSurf[i]);
+            if (f0 > 0.0f && f1 <= 0.0f && s.velY[i] < 0.0f) {
+                t.hit[i] = kHitWater;
+                t.hitT[i] = f0 / (f0 - f1);
             }
-        }
-
-        auto tryHitCube = [&](Vec3 &cPos, float &cVelY) {
-            const float half = 0.6f;
-            if (std::fabs(newPos.x - cPos.x) < half &&
-                std::fabs(newPos.y - cPos.y) < half &&
-                std::fabs(newPos.z - cPos.z) < half) {
-                cVelY += 2.5f;
-                Vec3 dir = normalize(vel);
-                cPos += dir * 0.08f;
-                addRipple(newPos, timef);
-                g_pendingCubeHit = true;
-                s.active = false;
+            for (int c = 0; c < colliderCount; ++c) {
+                const float tc = sweepCollider(colliders[c], p, d);
+                if (tc >= 0.0f && tc < t.hitT[i]) {
+                    t.hit[i] = c;
+                    t.hitT[i] = tc;
+                }
             }
-        };
-        if (s.active) tryHitCube(cubePos, cubeVelY);
-        if (s.active) tryHitCube(cube2Pos, cube2VelY);
-
-        if (s.active) {
-            Vec3 d = newPos - boatPos;
-            float dist2 = dot(d, d);
-            if (dist2 < boatRadius * boatRadius) {
-                addRipple(newPos, timef);
-                g_pendingBoatHit = true;
-                s.active = false;
+            if (t.hit[i] == kNoHit) {
+                s.posX[i] = t.newX[i];
+                s.posY[i] = t.newY[i];
+                s.posZ[i] = t.newZ[i];
+                s.surfY[i] = t.newSurf[i];
             }
         }
+    });
+
+    // Contacts raise ripples and events, so they are resolved in order here.
+    int impacts = 0;
+    for (int i = 0; i < s.count; ++i) {
+        if (t.hit[i] == kNoHit || t.dead[i]) continue;
+        ++impacts;
+        const float h = t.hitT[i];
+        const Vec3 p(s.posX[i], s.posY[i], s.posZ[i]);
+        const Vec3 contact = p + (Vec3(t.newX[i], t.newY[i], t.newZ[i]) - p) * h;
+        Vec3 vel(s.velX[i], s.velY[i], s.velZ[i]);
+        const float vMag = length(vel);
+
+        if (t.hit[i] >= 0) {
+            StoneCollider &c = colliders[t.hit[i]];
+            c.hits++;
+            if (vMag > 1e-6f) c.push += vel * (1.0f / vMag);
+            addRipple(contact, timef);
+            pushGameEvent(c.hitEvent, contact, vMag / 20.0f, timef);
+            t.dead[i] = true;
+            continue;
+        }
 
-        s.pos = newPos;
-        s.vel = vel;
+        float horizMag = std::sqrt(vel.x * vel.x + vel.z * vel.z);
+        float alpha = std::atan2(-vel.y, horizMag); // straight down is 90 degrees
+        float alphaDeg = alpha * 180.0f / kPi;
+
+        const float minSpeed = 5.0f;
+        const float maxAngleDeg = 30.0f;
+        const int maxBounces = 8;
+
+        if (vMag > minSpeed && alphaDeg < maxAngleDeg && s.bounces[i] < maxBounces) {
+            const float normalRestitution = 0.6f;
+            const float tangentBase = 0.9f;
+            float tangentDamping = tangentBase - 0.04f * static_cast<float>(s.bounces[i]);
+            if (tangentDamping < 0.6f) tangentDamping = 0.6f;
+
+            vel = Vec3(vel.x * tangentDamping, -vel.y * normalRestitution, vel.z * tangentDamping);
+            s.bounces[i]++;
+
+            // Leave the surface at the contact and spend the rest of the step
+            // on the new velocity.
+            const float surf = s.surfY[i] + (t.newSurf[i] - s.surfY[i]) * h;
+            Vec3 newPos = contact + vel * ((1.0f - h) * dt);
+            newPos.y = std::max(newPos.y, waterHeight + surf + 0.02f);
+            s.posX[i] = newPos.x;
+            s.posY[i] = newPos.y;
+            s.posZ[i] = newPos.z;
+            s.velX[i] = vel.x;
+            s.velY[i] = vel.y;
+            s.velZ[i] = vel.z;
+            s.surfY[i] = t.newSurf[i];
+
+            addRipple(Vec3(contact.x, waterHeight, contact.z), timef);
+            pushGameEvent(GameEventType::WaterSplash, contact, vMag / 20.0f, timef);
+        } else {
+            pushGameEvent(GameEventType::TinySplash, contact, vMag / 10.0f, timef);
+            t.dead[i] = true;
+        }
     }
+
+    // Swap the last live stone into each dead slot.
+    int i = 0;
+    while (i < s.count) {
+        if (!t.dead[i]) {
+            ++i;
+            continue;
+        }
+        const int last = --s.count;
+        s.posX[i] = s.posX[last];
+        s.posY[i] = s.posY[last];
+        s.posZ[i] = s.posZ[last];
+        s.velX[i] = s.velX[last];
+        s.velY[i] = s.velY[last];
+        s.velZ[i] = s.velZ[last];
+        s.life[i] = s.life[last];
+        s.surfY[i] = s.surfY[last];
+        s.bounces[i] = s.bounces[last];
+        t.dead[i] = t.dead[last];
+    }
+
+    g_stoneStats.live = s.count;
+    g_stoneStats.impacts = impacts;
+    g_stoneStats.updateMs = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
 }
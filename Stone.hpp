@@ -1,44 +1,93 @@
 #pragma once
 
+#include "Events.hpp"
 #include "Math.hpp"
 #include "Waves.hpp"
 #include <vector>
 
-struct Stone {
+// Skipping stones in a structure-of-arrays pool. Live stones are packed in
+// [0, count) so integration streams through contiguous arrays; the free slots
+// are the tail, a removed stone is replaced by the last live one, and when
+// the pool is full a new throw replaces the oldest stone.
+constexpr int kMaxStones = 16384;
+constexpr float kStoneLifetime = 10.0f; // seconds before a stone is dropped
+
+struct StonePool {
+    alignas(32) float posX[kMaxStones];
+    alignas(32) float posY[kMaxStones];
+    alignas(32) float posZ[kMaxStones];
+    alignas(32) float velX[kMaxStones];
+    alignas(32) float velY[kMaxStones];
+    alignas(32) float velZ[kMaxStones];
+    alignas(32) float life[kMaxStones];
+    alignas(32) float surfY[kMaxStones]; // water-field height under pos at the last update
+    int bounces[kMaxStones];
+    int count = 0;
+};
+
+// Something stones can hit, tested against each stone's swept path for the
+// frame so fast stones cannot pass through it. Hits are summed for the caller
+// to react to (e.g. nudging a floating cube).
+struct StoneCollider {
     Vec3 pos;
-    Vec3 vel;
-    int bounces;
-    float life;
-    bool active;
+    float radius = 0.5f; // sphere radius, or half-extent of an axis-aligned cube
+    bool box = false;
+    GameEventType hitEvent = GameEventType::CubeHit;
+    int hits = 0; // outputs, reset by updateStones
+    Vec3 push;    // sum of the hitting stones' directions of travel
+};
 
-    Stone() : pos(), vel(), bounces(0), life(0.0f), active(false) {}
+struct StoneStats {
+    float updateMs = 0.0f;
+    int live = 0;
+    int impacts = 0; // water contacts and hits in the last update
 };
 
+// Ripples live in a fixed pool indexed by a hashed uniform grid: each live
+// ripple is linked into every cell its influence disk overlaps, so a point
+// query only walks the one cell it falls in.
+constexpr int kMaxRipples = 4096;
+constexpr float kRippleRadius = 8.0f;    // default reach; envelope exp(-0.5 r) leaves < 1 mm beyond this
+constexpr float kRippleMaxRadius = 16.0f;
+constexpr float kRippleLife = 2.5f;      // singleRippleHeight is zero after this
+constexpr float kRippleCellSize = 2.0f;  // metres per grid cell
+constexpr int kRippleGridDim = 64;       // cells per side, wrapping (power of two)
+
 struct RippleEvent {
     Vec3 pos;
     float startTime;
+    float radius; // influence radius; the ripple contributes nothing beyond it
     bool active;
-    RippleEvent() : pos(), startTime(0.0f), active(false) {}
+    RippleEvent() : pos(), startTime(0.0f), radius(kRippleRadius), active(false) {}
 };
 
-constexpr int kMaxStones = 8;
-constexpr int kMaxRipples = 32;
-
-extern Stone g_stones[kMaxStones];
+extern StonePool g_stones;
 extern RippleEvent g_ripples[kMaxRipples];
 
-void addRipple(const Vec3 &pos, float time);
+// Height of one ripple at distance r, faded to zero at its influence radius.
+float singleRippleHeight(float r, float age, float radius = kRippleRadius);
+float singleRippleHeight(float r, float age, float radius, float &dhdr); // also d(height)/dr
+// When the pool is full the oldest slot in ring order is reused.
+void addRipple(const Vec3 &pos, float time, float radius = kRippleRadius);
 void pruneRipples(float time);
+void clearRipples();
+int liveRippleCount();
 float rippleFieldHeight(const Vec3 &pos, float time);
-Vec3 rippleFieldGrad(const Vec3 &pos, float time);
+Vec3 rippleFieldGrad(const Vec3 &pos, float time); // analytic (dh/dx, 0, dh/dz)
+// Slots of live ripples whose influence overlaps the XZ rectangle; when more
+// than maxCount qualify, the youngest are kept. Returns the count written.
+int gatherRipples(float minX, float minZ, float maxX, float maxZ, float time,
+                  int *outSlots, int maxCount);
 
 void spawnStone(const Vec3 &cameraPos, const Vec3 &forward, const Vec3 &up,
                 float angleDownDeg, float speed);
+void spawnStoneAt(const Vec3 &pos, const Vec3 &vel);
+void clearStones();
+Vec3 stonePosition(int i);
+// Integrates every live stone, then sweeps each one's path for the frame
+// against the water surface and the colliders. Skips, sinks and hits are
+// reported as GameEvents (Events.hpp). parallel = false keeps everything on
+// the caller.
 void updateStones(float dt, float timef, float waterHeight,
-                  Vec3 &cubePos, Vec3 &cube2Pos, float &cubeVelY, float &cube2VelY,
-                  const Vec3 &boatPos, float boatRadius);
-bool consumeStoneSplash();
-bool consumeWaterSplash();
-bool consumeTinySplash();
-bool consumeCubeHit();
-bool consumeBoatHit();
+                  StoneCollider *colliders, int colliderCount, bool parallel = true);
+const StoneStats &stoneStats();
@@ -0,0 +1,268 @@
+#include "WaterField.hpp"
+#include "Ocean.hpp"
+#include "Parallel.hpp"
+#include "ShallowWater.hpp"
+#include "Stone.hpp"
+#include "Waves.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct WaterFieldGrid {
+    float originX = 0.0f; // world XZ of sample (0, 0)
+    float originZ = 0.0f;
+    float time = 0.0f;
+    bool valid = false;
+    std::vector<float> height;
+    std::vector<float> gradX;
+    std::vector<float> gradZ;
+};
+
+struct ActiveRipple {
+    float x, z, age, radius;
+};
+
+WaterFieldGrid g_field;
+WaterFieldGrid g_prevField; // last frame's build, for queries between the two
+WaterFieldStats g_fieldStats;
+
+float directHeight(float x, float z, float time) {
+    float y = 0.0f;
+    if (g_waterMode == WaterMode::FftOcean) {
+        oceanHeightBatch(&x, &z, 1, &y);
+    } else {
+        evalGerstnerHeight(&x, &z, 1, time, &y);
+    }
+    if (g_rippleMode == RippleMode::ShallowWater) return y + shallowWaterHeight(x, z);
+    return y + rippleFieldHeight(Vec3(x, 0.0f, z), time);
+}
+
+Vec3 directRippleGradient(float x, float z, float time) {
+    return (g_rippleMode == RippleMode::ShallowWater) ? shallowWaterGradient(x, z)
+                                                      : rippleFieldGrad(Vec3(x, 0.0f, z), time);
+}
+
+Vec3 directGradient(float x, float z, float time) {
+    float y, sx, sz;
+    if (g_waterMode == WaterMode::FftOcean) {
+        oceanHeightBatch(&x, &z, 1, &y, &sx, &sz);
+    } else {
+        evalGerstnerHeight(&x, &z, 1, time, &y, &sx, &sz);
+    }
+    const Vec3 ripple = directRippleGradient(x, z, time);
+    return Vec3(sx + ripple.x, 0.0f, sz + ripple.z);
+}
+
+bool cellCoords(const WaterFieldGrid &g, float x, float z, int &i0, int &j0, float &fx, float &fz) {
+    if (!g.valid) return false;
+    const float gx = (x - g.originX) * (1.0f / kWaterFieldCell);
+    const float gz = (z - g.originZ) * (1.0f / kWaterFieldCell);
+    const float maxCoord = static_cast<float>(kWaterFieldRes - 1);
+    if (!(gx >= 0.0f && gz >= 0.0f && gx < maxCoord && gz < maxCoord)) return false;
+    i0 = static_cast<int>(gx);
+    j0 = static_cast<int>(gz);
+    fx = gx - static_cast<float>(i0);
+    fz = gz - static_cast<float>(j0);
+    return true;
+}
+
+float bilinear(const std::vector<float> &v, int i0, int j0, float fx, float fz) {
+    const float *row0 = &v[static_cast<size_t>(j0) * kWaterFieldRes + i0];
+    const float *row1 = row0 + kWaterFieldRes;
+    const float a = row0[0] + (row0[1] - row0[0]) * fx;
+    const float b = row1[0] + (row1[1] - row1[0]) * fx;
+    return a + (b - a) * fz;
+}
+
+// blend < 1 mixes in the previous build, so a point must lie in both grids
+// to be cached; everything else is evaluated directly at time.
+void heightBatch(const float *x, const float *z, int n, float time, float blend, float *outY) {
+    // Points outside the cache are gathered and evaluated together through
+    // the batched (SIMD) wave paths rather than one at a time.
+    thread_local std::vector<int> missIndex;
+    thread_local std::vector<float> missX, missZ, missY;
+    missIndex.clear();
+    missX.clear();
+    missZ.clear();
+    for (int i = 0; i < n; ++i) {
+        int i0, j0;
+        float fx, fz;
+        bool cached = cellCoords(g_field, x[i], z[i], i0, j0, fx, fz);
+        if (cached) {
+            outY[i] = bilinear(g_field.height, i0, j0, fx, fz);
+            if (blend < 1.0f) {
+                cached = cellCoords(g_prevField, x[i], z[i], i0, j0, fx, fz);
+                if (cached) {
+                    const float prev = bilinear(g_prevField.height, i0, j0, fx, fz);
+                    outY[i] = prev + (outY[i] - prev) * blend;
+                }
+            }
+        }
+        if (!cached) {
+            missIndex.push_back(i);
+            missX.push_back(x[i]);
+            missZ.push_back(z[i]);
+        }
+    }
+    if (missIndex.empty()) return;
+
+    const int misses = static_cast<int>(missIndex.size());
+    missY.resize(misses);
+    if (g_waterMode == WaterMode::FftOcean) {
+        oceanHeightBatch(missX.data(), missZ.data(), misses, missY.data());
+    } else {
+        evalGerstnerHeight(missX.data(), missZ.data(), misses, time, missY.data());
+    }
+    for (int k = 0; k < misses; ++k) {
+        const float ripple = g_rippleMode == RippleMode::ShallowWater
+                                 ? shallowWaterHeight(missX[k], missZ[k])
+                                 : rippleFieldHeight(Vec3(missX[k], 0.0f, missZ[k]), time);
+        outY[missIndex[k]] = missY[k] + ripple;
+    }
+}
+
+} // namespace
+
+WaterMode g_waterMode = WaterMode::Gerstner;
+RippleMode g_rippleMode = RippleMode::Rings;
+
+void buildWaterField(const Vec3 &center, float time, bool parallel) {
+    const auto start = std::chrono::steady_clock::now();
+    const int res = kWaterFieldRes;
+    const float cell = kWaterFieldCell;
+    const size_t total = static_cast<size_t>(res) * res;
+    std::swap(g_prevField, g_field);
+    // Snap the origin to the cell lattice so samples don't swim as the camera moves.
+    g_field.originX = std::floor(center.x / cell - 0.5f * (res - 1)) * cell;
+    g_field.originZ = std::floor(center.z / cell - 0.5f * (res - 1)) * cell;
+    g_field.height.resize(total);
+    g_field.gradX.resize(total);
+    g_field.gradZ.resize(total);
+
+    static std::vector<int> slots(kMaxRipples);
+    const float extent = (res - 1) * cell;
+    // The shallow-water grid already carries the impacts; rings are splatted otherwise.
+    const int rippleCount = (g_rippleMode == RippleMode::ShallowWater)
+        ? 0
+        : gatherRipples(g_field.originX, g_field.originZ, g_field.originX + extent,
+                        g_field.originZ + extent, time, slots.data(), kMaxRipples);
+    std::vector<ActiveRipple> ripples;
+    ripples.reserve(rippleCount);
+    for (int k = 0; k < rippleCount; ++k) {
+        const RippleEvent &r = g_ripples[slots[k]];
+        ripples.push_back({r.pos.x, r.pos.z, time - r.startTime, r.radius});
+    }
+
+    std::vector<float> rowX(res);
+    for (int i = 0; i < res; ++i) rowX[i] = g_field.originX + i * cell;
+
+    std::atomic<int> solverIters{0};
+    auto buildRows = [&](int begin, int end) {
+        std::vector<float> rowZ(res);
+        int iters = 0;
+        for (int j = begin; j < end; ++j) {
+            const float z = g_field.originZ + j * cell;
+            std::fill(rowZ.begin(), rowZ.end(), z);
+            const size_t rowStart = static_cast<size_t>(j) * res;
+            float *row = &g_field.height[rowStart];
+            float *gx = &g_field.gradX[rowStart];
+            float *gz = &g_field.gradZ[rowStart];
+            // Slopes come analytically from the same pass as the heights.
+            const int rowIters = (g_waterMode == WaterMode::FftOcean)
+                                     ? oceanHeightBatch(rowX.data(), rowZ.data(), res, row, gx, gz)
+                                     : evalGerstnerHeight(rowX.data(), rowZ.data(), res, time, row, gx, gz);
+            iters = std::max(iters, rowIters);
+
+            if (g_rippleMode == RippleMode::ShallowWater) {
+                for (int i = 0; i < res; ++i) {
+                    float h, sx, sz;
+                    shallowWaterSample(rowX[i], z, h, sx, sz);
+                    row[i] += h;
+                    gx[i] += sx;
+                    gz[i] += sz;
+                }
+            }
+
+            // Splat only the cells each ripple can visibly reach.
+            for (const ActiveRipple &r : ripples) {
+                const float dz = z - r.z;
+                if (std::fabs(dz) > r.radius) continue;
+                const float halfW = std::sqrt(r.radius * r.radius - dz * dz);
+                const int i0 = std::max(0, static_cast<int>(std::ceil((r.x - halfW - g_field.originX) / cell)));
+                const int i1 = std::min(res - 1, static_cast<int>(std::floor((r.x + halfW - g_field.originX) / cell)));
+                for (int i = i0; i <= i1; ++i) {
+                    const float dx = rowX[i] - r.x;
+                    const float dist = std::sqrt(dx * dx + dz * dz);
+                    float dhdr;
+                    row[i] += singleRippleHeight(dist, r.age, r.radius, dhdr);
+                    if (dist > 1e-6f) {
+                        gx[i] += dhdr * dx / dist;
+                        gz[i] += dhdr * dz / dist;
+                    }
+                }
+            }
+        }
+        int seen = solverIters.load(std::memory_order_relaxed);
+        while (iters > seen && !solverIters.compare_exchange_weak(seen, iters, std::memory_order_relaxed)) {
+        }
+    };
+
+    if (parallel) {
+        parallelFor(res, 8, buildRows);
+    } else {
+        buildRows(0, res);
+    }
+    g_field.time = time;
+    g_field.valid = true;
+    g_fieldStats.solverIters = solverIters.load(std::memory_order_relaxed);
+    g_fieldStats.buildMs = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+const WaterFieldStats &waterFieldStats() {
+    return g_fieldStats;
+}
+
+float surfaceHeight(float x, float z) {
+    int i0, j0;
+    float fx, fz;
+    if (cellCoords(g_field, x, z, i0, j0, fx, fz)) {
+        return bilinear(g_field.height, i0, j0, fx, fz);
+    }
+    return directHeight(x, z, g_field.time);
+}
+
+Vec3 surfaceGradient(float x, float z) {
+    int i0, j0;
+    float fx, fz;
+    if (cellCoords(g_field, x, z, i0, j0, fx, fz)) {
+        return Vec3(bilinear(g_field.gradX, i0, j0, fx, fz), 0.0f,
+                    bilinear(g_field.gradZ, i0, j0, fx, fz));
+    }
+    return directGradient(x, z, g_field.time);
+}
+
+Vec3 rippleGradient(float x, float z) {
+    return directRippleGradient(x, z, g_field.time);
+}
+
+void surfaceHeightBatch(const float *x, const float *z, int n, float *outY) {
+    heightBatch(x, z, n, g_field.time, 1.0f, outY);
+}
+
+void surfaceHeightBatchAt(const float *x, const float *z, int n, float time, float *outY) {
+    const float span = g_field.time - g_prevField.time;
+    if (!g_prevField.valid || !(span > 0.0f) || time >= g_field.time) {
+        heightBatch(x, z, n, g_field.time, 1.0f, outY);
+        return;
+    }
+    // Blend the two builds: the waves move little within a frame, and the
+    // shallow-water and FFT states only exist at build times anyway.
+    const float blend = std::max(0.0f, (time - g_prevField.time) / span);
+    heightBatch(x, z, n, g_prevField.time + span * blend, blend, outY);
+}
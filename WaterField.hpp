@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Math.hpp"
+
+// Per-frame CPU cache of the water surface (Gerstner waves + impact ripples)
+// on a regular grid around the camera. Gameplay queries become two bilinear
+// lookups regardless of how many bodies or ripples exist. Heights are the
+// displaced surface directly above each XZ (see evalGerstnerHeight),
+// relative to the rest plane.
+
+constexpr int kWaterFieldRes = 192;     // samples per side
+constexpr float kWaterFieldCell = 0.2f; // metres between samples (~38 m span)
+
+// Surface the cache samples: the analytic Gerstner sum (Waves.*) or the FFT
+// ocean (Ocean.*, which the caller must update before building the field).
+enum class WaterMode { Gerstner, FftOcean };
+extern WaterMode g_waterMode;
+
+// Small-scale disturbances on top: analytic impact rings (Stone.*) or the
+// shallow-water grid (ShallowWater.*, updated by the caller before the build).
+enum class RippleMode { Rings, ShallowWater };
+extern RippleMode g_rippleMode;
+
+struct WaterFieldStats {
+    float buildMs = 0.0f;
+    int solverIters = 0; // worst height-solver iteration count in the last build
+};
+
+// Rebuild once per frame, before any gameplay query. The previous build is
+// kept for surfaceHeightBatchAt.
+void buildWaterField(const Vec3 &center, float time, bool parallel = true);
+
+// Points outside the cached grid fall back to direct evaluation.
+float surfaceHeight(float x, float z);
+Vec3 surfaceGradient(float x, float z); // (dh/dx, 0, dh/dz)
+// Slope of the ripples alone, without the waves, at the last build's time;
+// evaluated directly.
+Vec3 rippleGradient(float x, float z);
+void surfaceHeightBatch(const float *x, const float *z, int n, float *outY);
+// Heights at a time between the last two builds, blended linearly; for fixed
+// physics steps that fall inside the frame. Outside that span it is
+// surfaceHeightBatch.
+void surfaceHeightBatchAt(const float *x, const float *z, int n, float time, float *outY);
+
+const WaterFieldStats &waterFieldStats();
@@ -1,4 +1,7 @@
 #include "Waves.hpp"
+#include "WavesKernel.hpp"
+#include <algorithm>
+#include <cmath>
 
 const WaveParams kWaves[kNumWaves] = {
     {Vec3(1.0f, 0.0f, 0.3f), 0.12f, 6.0f, 0.8f, 1.2f},
@@ -7,22 +10,134 @@ const WaveParams kWaves[kNumWaves] = {
     {Vec3(-0.5f, 0.0f, -0.9f), 0.04f, 2.5f, 0.5f, 1.8f}
 };
 
-Vec3 evalGerstnerXZ(const Vec3 &xz, float time) {
-    Vec3 pos(xz.x, 0.0f, xz.z);
-    for (int i = 0; i < kNumWaves; ++i) {
-        float k = 2.0f * kPi / kWaves[i].length;
-        float c = kWaves[i].speed;
-        Vec3 D = normalize(Vec3(kWaves[i].dir.x, 0.0f, kWaves[i].dir.z));
-        float A = kWaves[i].amp;
-        float Q = kWaves[i].steep;
-
-        float phase = k * (D.x * xz.x + D.z * xz.z) + c * time;
-        float cosP = std::cos(phase);
-        float sinP = std::sin(phase);
-
-        pos.x += (Q * A * D.x) * cosP;
-        pos.z += (Q * A * D.z) * cosP;
-        pos.y += A * sinP;
+static WaveSpectrum makeWaveSpectrum(int count) {
+    count = std::clamp(count, 1, kMaxWaves);
+    WaveSpectrum spec;
+    spec.count = count;
+
+    // Detail waves beyond the authored set: wind-aligned spread around wave 0,
+    // wavelengths shrinking geometrically, deep-water speed ~ sqrt(g*k), and
+    // steepness split so the summed Q*k*A stays well below 1 (no looping).
+    const int numGenerated = std::max(0, count - kNumWaves);
+    const float windAngle = std::atan2(kWaves[0].dir.z, kWaves[0].dir.x);
+    for (int i = 0; i < count; ++i) {
+        WaveParams wp;
+        if (i < kNumWaves) {
+            wp = kWaves[i];
+        } else {
+            const int g = i - kNumWaves;
+            const float u = (numGenerated > 1) ? static_cast<float>(g) / (numGenerated - 1) : 0.0f;
+            const float angle = windAngle + 1.2f * std::sin(static_cast<float>(g) * 2.39996f);
+            wp.dir = Vec3(std::cos(angle), 0.0f, std::sin(angle));
+            wp.length = 2.2f * std::pow(0.3f / 2.2f, u);
+            wp.amp = 0.006f * wp.length;
+            const float kGen = 2.0f * kPi / wp.length;
+            wp.speed = 0.37f * std::sqrt(9.81f * kGen);
+            wp.steep = std::min(0.4f, 0.5f / (kGen * wp.amp * numGenerated));
+        }
+        const float k = 2.0f * kPi / wp.length;
+        const Vec3 D = normalize(Vec3(wp.dir.x, 0.0f, wp.dir.z));
+        spec.kdx[i] = k * D.x;
+        spec.kdz[i] = k * D.z;
+        spec.speed[i] = wp.speed;
+        spec.amp[i] = wp.amp;
+        spec.qaDx[i] = wp.steep * wp.amp * D.x;
+        spec.qaDz[i] = wp.steep * wp.amp * D.z;
+    }
+    return spec;
+}
+
+WaveSpectrum g_waveSpectrum = makeWaveSpectrum(kNumWaves);
+
+void buildWaveSpectrum(int count) {
+    g_waveSpectrum = makeWaveSpectrum(count);
+}
+
+void fillWaveBlock(const WaveSpectrum &spec, WaveBlockStd140 &block) {
+    block = WaveBlockStd140{};
+    block.count = spec.count;
+    for (int i = 0; i < spec.count; ++i) {
+        block.dirK[i][0] = spec.kdx[i];
+        block.dirK[i][1] = spec.kdz[i];
+        block.dirK[i][2] = spec.speed[i];
+        block.dirK[i][3] = spec.amp[i];
+        block.qa[i][0] = spec.qaDx[i];
+        block.qa[i][1] = spec.qaDz[i];
+    }
+}
+
+GerstnerConsts makeGerstnerConsts(const WaveSpectrum &spec, float time) {
+    GerstnerConsts w;
+    w.spec = &spec;
+    for (int i = 0; i < spec.count; ++i) {
+        w.phase[i] = spec.speed[i] * time;
     }
+    return w;
+}
+
+Vec3 evalGerstnerXZ(const Vec3 &xz, float time) {
+    Vec3 pos;
+    evalGerstnerBatch(&xz.x, &xz.z, 1, time, &pos.x, &pos.y, &pos.z);
     return pos;
 }
+
+void evalGerstnerBatch(const float *x, const float *z, int n, float time,
+                       float *outX, float *outY, float *outZ) {
+    evalGerstnerBatchPath(bestSimdPath(), x, z, n, time, outX, outY, outZ);
+}
+
+void evalGerstnerBatchPath(SimdPath path, const float *x, const float *z, int n, float time,
+                           float *outX, float *outY, float *outZ) {
+    if (n <= 0) return;
+    if (!simdPathAvailable(path)) path = SimdPath::Scalar;
+    // Single points are not worth the vector setup; keep them on the exact path.
+    if (n == 1) path = SimdPath::Scalar;
+    const GerstnerConsts w = makeGerstnerConsts(g_waveSpectrum, time);
+    switch (path) {
+    case SimdPath::AVX2:
+        gerstnerBatchAvx2(w, x, z, n, outX, outY, outZ);
+        return;
+#if WATER_HAVE_SSE2
+    case SimdPath::SSE:
+        gerstnerBatchKernel<LaneSse>(w, x, z, n, outX, outY, outZ);
+        return;
+#endif
+#if WATER_HAVE_NEON
+    case SimdPath::NEON:
+        gerstnerBatchKernel<LaneNeon>(w, x, z, n, outX, outY, outZ);
+        return;
+#endif
+    default:
+        gerstnerBatchKernel<LaneScalar>(w, x, z, n, outX, outY, outZ);
+        return;
+    }
+}
+
+int evalGerstnerHeight(const float *x, const float *z, int n, float time, float *outY,
+                       float *outSlopeX, float *outSlopeZ, int maxIters, float tolerance) {
+    return evalGerstnerHeightPath(bestSimdPath(), x, z, n, time, outY, outSlopeX, outSlopeZ,
+                                  maxIters, tolerance);
+}
+
+int evalGerstnerHeightPath(SimdPath path, const float *x, const float *z, int n, float time,
+                           float *outY, float *outSlopeX, float *outSlopeZ,
+                           int maxIters, float tolerance) {
+    if (n <= 0) return 0;
+    if (!simdPathAvailable(path)) path = SimdPath::Scalar;
+    if (n == 1) path = SimdPath::Scalar;
+    const GerstnerConsts w = makeGerstnerConsts(g_waveSpectrum, time);
+    switch (path) {
+    case SimdPath::AVX2:
+        return gerstnerHeightAvx2(w, x, z, n, outY, outSlopeX, outSlopeZ, maxIters, tolerance);
+#if WATER_HAVE_SSE2
+    case SimdPath::SSE:
+        return gerstnerHeightKernel<LaneSse>(w, x, z, n, outY, outSlopeX, outSlopeZ, maxIters, tolerance);
+#endif
+#if WATER_HAVE_NEON
+    case SimdPath::NEON:
+        return gerstnerHeightKernel<LaneNeon>(w, x, z, n, outY, outSlopeX, outSlopeZ, maxIters, tolerance);
+#endif
+    default:
+        return gerstnerHeightKernel<LaneScalar>(w, x, z, n, outY, outSlopeX, outSlopeZ, maxIters, tolerance);
+    }
+}
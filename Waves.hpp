@@ -1,8 +1,10 @@
 #pragma once
 
 #include "Math.hpp"
+#include "Simd.hpp"
 
-constexpr int kNumWaves = 4;
+constexpr int kNumWaves = 4;   // hand-authored base waves
+constexpr int kMaxWaves = 64;  // upper bound for the runtime spectrum
 
 struct WaveParams {
     Vec3 dir; // x,z used
@@ -14,4 +16,58 @@ struct WaveParams {
 
 extern const WaveParams kWaves[kNumWaves];
 
+// Load-time wave table shared by the CPU evaluators and water.vshader.
+// Everything that does not depend on time is folded here once.
+struct WaveSpectrum {
+    int count = 0;
+    float kdx[kMaxWaves];   // k * D.x (D normalized)
+    float kdz[kMaxWaves];   // k * D.z
+    float speed[kMaxWaves]; // phase speed c (phase = k*dot(D, xz) + c*t)
+    float amp[kMaxWaves];   // A
+    float qaDx[kMaxWaves];  // Q * A * D.x
+    float qaDz[kMaxWaves];  // Q * A * D.z
+};
+
+// std140 image of the WaveBlock uniform block in water.vshader.
+struct WaveBlockStd140 {
+    float dirK[kMaxWaves][4]; // xy = k*D, z = c, w = A
+    float qa[kMaxWaves][4];   // xy = Q*A*D
+    int count;
+    int pad[3];
+};
+
+extern WaveSpectrum g_waveSpectrum;
+
+// Rebuilds g_waveSpectrum with count waves (clamped to 1..kMaxWaves): the
+// authored kWaves first, then generated shorter detail waves.
+void buildWaveSpectrum(int count);
+void fillWaveBlock(const WaveSpectrum &spec, WaveBlockStd140 &block);
+
 Vec3 evalGerstnerXZ(const Vec3 &xz, float time);
+
+// Batched Gerstner displacement for n surface points (SoA in, SoA out).
+// outX/outZ may be null when only heights are needed. Dispatches to the
+// widest SIMD path the CPU supports; the Path variant forces one (benchmarks).
+void evalGerstnerBatch(const float *x, const float *z, int n, float time,
+                       float *outX, float *outY, float *outZ);
+void evalGerstnerBatchPath(SimdPath path, const float *x, const float *z, int n, float time,
+                           float *outX, float *outY, float *outZ);
+
+// Height of the displaced surface directly above world (x, z). Gerstner waves
+// move samples sideways, so evalGerstnerXZ(xz).y is the height of some other
+// point near steep crests; this inverts the horizontal displacement by
+// fixed-point iteration (vectorized like the batch above). When both slope
+// outputs are given, dh/dx and dh/dz come from closed-form tangents in the
+// same pass. Returns the most iterations any point needed; 0 means the
+// undisplaced guess was already within tolerance, maxIters means some point
+// did not converge.
+constexpr int kGerstnerHeightIters = 8;
+constexpr float kGerstnerHeightTolerance = 1e-3f; // metres, horizontal
+int evalGerstnerHeight(const float *x, const float *z, int n, float time, float *outY,
+                       float *outSlopeX = nullptr, float *outSlopeZ = nullptr,
+                       int maxIters = kGerstnerHeightIters,
+                       float tolerance = kGerstnerHeightTolerance);
+int evalGerstnerHeightPath(SimdPath path, const float *x, const float *z, int n, float time,
+                           float *outY, float *outSlopeX = nullptr, float *outSlopeZ = nullptr,
+                           int maxIters = kGerstnerHeightIters,
+                           float tolerance = kGerstnerHeightTolerance);
@@ -0,0 +1,22 @@
+// Built with -mavx2 -mfma on x86 (see Makefile). Only reached after
+// simdPathAvailable(SimdPath::AVX2) has checked the CPU at runtime.
+#include "WavesKernel.hpp"
+
+void gerstnerBatchAvx2(const GerstnerConsts &w, const float *x, const float *z, int n,
+                       float *outX, float *outY, float *outZ) {
+#if WATER_HAVE_AVX2
+    gerstnerBatchKernel<LaneAvx2>(w, x, z, n, outX, outY, outZ);
+#else
+    gerstnerBatchKernel<LaneScalar>(w, x, z, n, outX, outY, outZ);
+#endif
+}
+
+int gerstnerHeightAvx2(const GerstnerConsts &w, const float *x, const float *z, int n,
+                       float *outY, float *outSlopeX, float *outSlopeZ,
+                       int maxIters, float tolerance) {
+#if WATER_HAVE_AVX2
+    return gerstnerHeightKernel<LaneAvx2>(w, x, z, n, outY, outSlopeX, outSlopeZ, maxIters, tolerance);
+#else
+    return gerstnerHeightKernel<LaneScalar>(w, x, z, n, outY, outSlopeX, outSlopeZ, maxIters, tolerance);
+#endif
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+// Internal to Waves*.cpp: the Gerstner batch kernel, instantiated once per
+// SIMD lane type. Kept in a header so the AVX2 translation unit (built with
+// its own -m flags) can share it.
+
+#include "Simd.hpp"
+#include "Waves.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Wave table plus the time-dependent phase offsets for one evaluation.
+struct GerstnerConsts {
+    const WaveSpectrum *spec = nullptr;
+    float phase[kMaxWaves]; // c * t
+};
+
+GerstnerConsts makeGerstnerConsts(const WaveSpectrum &spec, float time);
+void gerstnerBatchAvx2(const GerstnerConsts &w, const float *x, const float *z, int n,
+                       float *outX, float *outY, float *outZ);
+int gerstnerHeightAvx2(const GerstnerConsts &w, const float *x, const float *z, int n,
+                       float *outY, float *outSlopeX, float *outSlopeZ,
+                       int maxIters, float tolerance);
+
+// Height slopes of the displaced surface, from the closed-form tangents
+// dP/dx = (1 - sum QAk Dx Dx sin, sum Ak Dx cos, -sum QAk Dx Dz sin) and
+// dP/dz = (-sum QAk Dx Dz sin, sum Ak Dz cos, 1 - sum QAk Dz Dz sin);
+// slope = -N.xz / N.y with N = dP/dz x dP/dx.
+template <class L>
+struct GerstnerSlopeSums {
+    using F = typename L::F;
+    F txx = L::set1(0.0f), txz = L::set1(0.0f), tzz = L::set1(0.0f);
+    F hx = L::set1(0.0f), hz = L::set1(0.0f);
+
+    void resolve(F &slopeX, F &slopeZ) const {
+        const F one = L::set1(1.0f);
+        const F ax = L::sub(one, txx);
+        const F az = L::sub(one, tzz);
+        // N = (-(txz hz + az hx), ax az - txz^2, -(txz hx + ax hz))
+        const F ny = L::sub(L::mul(ax, az), L::mul(txz, txz));
+        slopeX = L::div(L::madd(txz, hz, L::mul(az, hx)), ny);
+        slopeZ = L::div(L::madd(txz, hx, L::mul(ax, hz)), ny);
+    }
+};
+
+// Displaced position of rest point (px, pz); with kSlopes the same pass also
+// accumulates the analytic tangents (no extra sin/cos).
+template <class L, bool kSlopes = false>
+inline void gerstnerEval(const GerstnerConsts &w, typename L::F px, typename L::F pz,
+                         typename L::F &ax, typename L::F &ay, typename L::F &az,
+                         GerstnerSlopeSums<L> *slopes = nullptr) {
+    using F = typename L::F;
+    ax = px;
+    ay = L::set1(0.0f);
+    az = pz;
+    const WaveSpectrum &sp = *w.spec;
+    if (kSlopes) *slopes = GerstnerSlopeSums<L>();
+    for (int j = 0; j < sp.count; ++j) {
+        const F phase = L::madd(L::set1(sp.kdx[j]), px,
+                                L::madd(L::set1(sp.kdz[j]), pz, L::set1(w.phase[j])));
+        F s, c;
+        L::sincos(phase, s, c);
+        ax = L::madd(L::set1(sp.qaDx[j]), c, ax);
+        az = L::madd(L::set1(sp.qaDz[j]), c, az);
+        ay = L::madd(L::set1(sp.amp[j]), s, ay);
+        if (kSlopes) {
+            slopes->txx = L::madd(L::set1(sp.qaDx[j] * sp.kdx[j]), s, slopes->txx);
+            slopes->txz = L::madd(L::set1(sp.qaDx[j] * sp.kdz[j]), s, slopes->txz);
+            slopes->tzz = L::madd(L::set1(sp.qaDz[j] * sp.kdz[j]), s, slopes->tzz);
+            slopes->hx = L::madd(L::set1(sp.amp[j] * sp.kdx[j]), c, slopes->hx);
+            slopes->hz = L::madd(L::set1(sp.amp[j] * sp.kdz[j]), c, slopes->hz);
+        }
+    }
+}
+
+template <class L>
+inline void gerstnerLanes(const GerstnerConsts &w, const float *x, const float *z,
+                          float *outX, float *outY, float *outZ) {
+    using F = typename L::F;
+    F ax, ay, az;
+    gerstnerEval<L>(w, L::load(x), L::load(z), ax, ay, az);
+    if (outX) L::store(outX, ax);
+    L::store(outY, ay);
+    if (outZ) L::store(outZ, az);
+}
+
+// Height of the displaced surface above world (x, z): fixed-point iteration
+// p <- p - (P(p) - target) on the rest-plane sample p. The map contracts by
+// the summed Q*k*A (< 1, see makeWaveSpectrum), so a handful of steps reach
+// tolerance. Slopes (optional) come from the last evaluation. Returns the
+// iterations this vector needed.
+template <class L, bool kSlopes>
+inline int gerstnerHeightLanes(const GerstnerConsts &w, const float *x, const float *z,
+                               float *outY, float *outSlopeX, float *outSlopeZ,
+                               int maxIters, float tolerance) {
+    using F = typename L::F;
+    constexpr int W = L::kWidth;
+    const F tx = L::load(x);
+    const F tz = L::load(z);
+    F px = tx, pz = tz;
+    F ax, ay, az;
+    GerstnerSlopeSums<L> slopes;
+    gerstnerEval<L, kSlopes>(w, px, pz, ax, ay, az, &slopes);
+    int iters = 0;
+    while (iters < maxIters) {
+        const F ex = L::sub(ax, tx);
+        const F ez = L::sub(az, tz);
+        float errX[W], errZ[W];
+        L::store(errX, ex);
+        L::store(errZ, ez);
+        bool converged = true;
+        for (int k = 0; k < W; ++k) {
+            if (std::fabs(errX[k]) > tolerance || std::fabs(errZ[k]) > tolerance) {
+                converged = false;
+                break;
+            }
+        }
+        if (converged) break;
+        px = L::sub(px, ex);
+        pz = L::sub(pz, ez);
+        gerstnerEval<L, kSlopes>(w, px, pz, ax, ay, az, &slopes);
+        ++iters;
+    }
+    L::store(outY, ay);
+    if (kSlopes) {
+        F sx, sz;
+        slopes.resolve(sx, sz);
+        L::store(outSlopeX, sx);
+        L::store(outSlopeZ, sz);
+    }
+    return iters;
+}
+
+template <class L>
+inline void gerstnerBatchKernel(const GerstnerConsts &w, const float *x, const float *z, int n,
+                                float *outX, float *outY, float *outZ) {
+    constexpr int W = L::kWidth;
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        gerstnerLanes<L>(w, x + i, z + i,
+                         outX ? outX + i : nullptr, outY + i, outZ ? outZ + i : nullptr);
+    }
+    if (i < n) {
+        // Pad the tail into one full vector instead of a scalar remainder loop.
+        float tx[W] = {}, tz[W] = {}, ox[W], oy[W], oz[W];
+        const int rem = n - i;
+        for (int k = 0; k < rem; ++k) { tx[k] = x[i + k]; tz[k] = z[i + k]; }
+        gerstnerLanes<L>(w, tx, tz, ox, oy, oz);
+        for (int k = 0; k < rem; ++k) {
+            if (outX) outX[i + k] = ox[k];
+            outY[i + k] = oy[k];
+            if (outZ) outZ[i + k] = oz[k];
+        }
+    }
+}
+
+template <class L, bool kSlopes>
+inline int gerstnerHeightKernelT(const GerstnerConsts &w, const float *x, const float *z, int n,
+                                 float *outY, float *outSlopeX, float *outSlopeZ,
+                                 int maxIters, float tolerance) {
+    constexpr int W = L::kWidth;
+    int maxUsed = 0;
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        const int iters = gerstnerHeightLanes<L, kSlopes>(
+            w, x + i, z + i, outY + i, kSlopes ? outSlopeX + i : nullptr,
+            kSlopes ? outSlopeZ + i : nullptr, maxIters, tolerance);
+        maxUsed = std::max(maxUsed, iters);
+    }
+    if (i < n) {
+        // Tail lanes repeat the last point so padding can't delay convergence.
+        float tx[W], tz[W], oy[W], osx[W], osz[W];
+        const int rem = n - i;
+        for (int k = 0; k < W; ++k) {
+            tx[k] = x[i + std::min(k, rem - 1)];
+            tz[k] = z[i + std::min(k, rem - 1)];
+        }
+        maxUsed = std::max(maxUsed, gerstnerHeightLanes<L, kSlopes>(w, tx, tz, oy, osx, osz,
+                                                                    maxIters, tolerance));
+        for (int k = 0; k < rem; ++k) {
+            outY[i + k] = oy[k];
+            if (kSlopes) {
+                outSlopeX[i + k] = osx[k];
+                outSlopeZ[i + k] = osz[k];
+            }
+        }
+    }
+    return maxUsed;
+}
+
+// Slopes are computed only when both outputs are given.
+template <class L>
+inline int gerstnerHeightKernel(const GerstnerConsts &w, const float *x, const float *z, int n,
+                                float *outY, float *outSlopeX, float *outSlopeZ,
+                                int maxIters, float tolerance) {
+    if (outSlopeX && outSlopeZ) {
+        return gerstnerHeightKernelT<L, true>(w, x, z, n, outY, outSlopeX, outSlopeZ,
+                                              maxIters, tolerance);
+    }
+    return gerstnerHeightKernelT<L, false>(w, x, z, n, outY, nullptr, nullptr,
+                                           maxIters, tolerance);
+}
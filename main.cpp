@@ -18,9 +18,14 @@
 #include "GLHelpers.hpp"
 #include "Mesh.hpp"
 #include "Waves.hpp"
+#include "Ocean.hpp"
+#include "ShallowWater.hpp"
+#include "WaterField.hpp"
 #include "Stone.hpp"
+#include "Events.hpp"
 #include "Input.hpp"
 #include "Boat.hpp"
+#include "Fleet.hpp"
 #include "Fish.hpp"
 #include "Rod.hpp"
 #include "Chest.hpp"
@@ -32,6 +37,20 @@ namespace {
 constexpr float kWaterHeight = 0.0f;
 constexpr float kGroundY = -1.3f;
 
+// Screen-space simplification error allowed when picking model LODs, in
+// pixels. Shadow texels are filtered and the reflection is rippled, so those
+// passes settle for coarser LODs.
+constexpr float kLodPixelError = 1.0f;
+constexpr float kLodShadowPixelError = 2.0f;
+constexpr float kLodReflectionPixelError = 4.0f;
+
+// LOD of one model instance in each pass that draws it.
+struct ModelLods {
+    int shadow = 0;
+    int scene = 0; // refraction prepass and main pass
+    int reflection = 0;
+};
+
 void glfwErrorCallback(int code, const char *desc) {
     std::cerr << "GLFW error " << code << ": " << desc << std::endl;
 }
@@ -48,10 +67,15 @@ MenuResult drawEscMenu(int fbWidth,
                        float &bgmVolume,
                        bool &bgmMuted,
                        int &bgmCueIndex,
-                       const std::vector<double> &bgmCues) {
+                       const std::vector<double> &bgmCues,
+                       int &waveCount,
+                       bool &fftOcean,
+                       int &oceanRes,
+                       bool &shallowWater,
+                       int &waterVertexBudgetK) {
     MenuResult result;
     ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
-    ImGui::SetNextWindowSize(ImVec2(static_cast<float>(fbWidth), 260.0f));
+    ImGui::SetNextWindowSize(ImVec2(static_cast<float>(fbWidth), 360.0f));
     ImGuiWindowFlags flags = ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize |
                              ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoSavedSettings;
     ImGui::Begin("Controls", nullptr, flags);
@@ -107,6 +131,36 @@ MenuResult drawEscMenu(int fbWidth,
         }
     }
 
+    ImGui::Text("Wave count:"); ImGui::SameLine();
+    {
+        float avail = ImGui::GetContentRegionAvail().x;
+        float sliderWidth = std::max(200.0f, avail - 2000.0f);
+        ImGui::PushItemWidth(sliderWidth);
+        ImGui::SliderInt("##wave_count", &waveCount, 1, kMaxWaves);
+        ImGui::PopItemWidth();
+    }
+
+    ImGui::Checkbox("FFT ocean", &fftOcean);
+    ImGui::SameLine(0.0f, 20.0f);
+    ImGui::Text("Grid:"); ImGui::SameLine();
+    for (int res = kOceanMinRes; res <= kOceanMaxRes; res *= 2) {
+        char label[16];
+        std::snprintf(label, sizeof(label), "%d", res);
+        if (ImGui::RadioButton(label, oceanRes == res)) oceanRes = res;
+        if (res < kOceanMaxRes) ImGui::SameLine();
+    }
+
+    ImGui::Checkbox("Shallow-water ripples (reflect off boat and cubes)", &shallowWater);
+
+    ImGui::Text("Water vertices (k):"); ImGui::SameLine();
+    {
+        float avail = ImGui::GetContentRegionAvail().x;
+        float sliderWidth = std::max(200.0f, avail - 2000.0f);
+        ImGui::PushItemWidth(sliderWidth);
+        ImGui::SliderInt("##water_budget", &waterVertexBudgetK, 16, 512);
+        ImGui::PopItemWidth();
+    }
+
     ImGui::Separator();
     if (ImGui::Button("Resume")) {
         if (audioReady) audio.play("click", 0, -1, 96);
@@ -236,6 +290,7 @@ GLuint fsQuadVbo = 0;
         GLint lightVP;
         GLint shadowMap;
         GLint time;
+        GLint instanced;
     } sceneU{
         glGetUniformLocation(sceneProgram, "uViewProj"),
         glGetUniformLocation(sceneProgram, "uModel"),
@@ -256,7 +311,9 @@ GLuint fsQuadVbo = 0;
         glGetUniformLocation(sceneProgram, "uLightVP"),
         glGetUniformLocation(sceneProgram, "uShadowMap"),
         glGetUniformLocation(sceneProgram, "uTime"),
+        glGetUniformLocation(sceneProgram, "uInstanced"),
     };
+    const MeshDecodeUniforms sceneDecode = meshDecodeUniforms(sceneProgram);
 
     // Water shader
     const std::string waterVsSource = readFile("shaders/water.vshader");
@@ -292,8 +349,17 @@ GLuint fsQuadVbo = 0;
         GLint underwater;
         GLint lightVP;
         GLint shadowMap;
-        GLint rippleCount;
-        GLint ripples;
+        GLint waterMode;
+        GLint oceanDisp;
+        GLint oceanNormal;
+        GLint oceanPatch;
+        GLint rippleMap;
+        GLint rippleOrigin;
+        GLint rippleSize;
+        GLint clipEye;
+        GLint clipBaseCell;
+        GLint clipGrid;
+        GLint clipLevels;
     } waterU{
         glGetUniformLocation(waterProgram, "uViewProj"),
         glGetUniformLocation(waterProgram, "uModel"),
@@ -322,9 +388,85 @@ GLuint fsQuadVbo = 0;
         glGetUniformLocation(waterProgram, "uUnderwater"),
         glGetUniformLocation(waterProgram, "uLightVP"),
         glGetUniformLocation(waterProgram, "uShadowMap"),
-        glGetUniformLocation(waterProgram, "uRippleCount"),
-        glGetUniformLocation(waterProgram, "uRipples[0]"),
+        glGetUniformLocation(waterProgram, "uWaterMode"),
+        glGetUniformLocation(waterProgram, "uOceanDisp"),
+        glGetUniformLocation(waterProgram, "uOceanNormal"),
+        glGetUniformLocation(waterProgram, "uOceanPatch"),
+        glGetUniformLocation(waterProgram, "uRippleMap"),
+        glGetUniformLocation(waterProgram, "uRippleOrigin"),
+        glGetUniformLocation(waterProgram, "uRippleSize"),
+        glGetUniformLocation(waterProgram, "uClipEye"),
+        glGetUniformLocation(waterProgram, "uClipBaseCell"),
+        glGetUniformLocation(waterProgram, "uClipGrid"),
+        glGetUniformLocation(waterProgram, "uClipLevels"),
+    };
+
+    // Wave spectrum uniform block: same table the CPU evaluators use
+    constexpr GLuint kWaveBlockBinding = 0;
+    GLuint waveUbo = 0;
+    {
+        GLuint blockIndex = glGetUniformBlockIndex(waterProgram, "WaveBlock");
+        if (blockIndex != GL_INVALID_INDEX) {
+            glUniformBlockBinding(waterProgram, blockIndex, kWaveBlockBinding);
+        }
+        glGenBuffers(1, &waveUbo);
+        glBindBuffer(GL_UNIFORM_BUFFER, waveUbo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(WaveBlockStd140), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, kWaveBlockBinding, waveUbo);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    // Ripple splat: live rings rasterized once per frame into a world-space
+    // (height, dh/dx, dh/dz) map around the camera that the water shaders sample
+    const std::string splatVsSource = readFile("shaders/ripple_splat.vshader");
+    const std::string splatFsSource = readFile("shaders/ripple_splat.fshader");
+    GLuint splatVs = compileShader(GL_VERTEX_SHADER, splatVsSource);
+    GLuint splatFs = compileShader(GL_FRAGMENT_SHADER, splatFsSource);
+    GLuint splatProgram = linkProgram(splatVs, splatFs);
+    struct SplatUniforms {
+        GLint origin;
+        GLint size;
+        GLint res;
+        GLint time;
+    } splatU{
+        glGetUniformLocation(splatProgram, "uRippleOrigin"),
+        glGetUniformLocation(splatProgram, "uRippleSize"),
+        glGetUniformLocation(splatProgram, "uRippleRes"),
+        glGetUniformLocation(splatProgram, "uTime"),
+    };
+    constexpr int kRippleMapRes = 512;
+    constexpr float kRippleMapSize = 40.96f; // metres, 8 cm texels
+    Framebuffer rippleFb = makeRippleBuffer(kRippleMapRes);
+    GLuint splatVao = 0, splatQuadVbo = 0, splatInstanceVbo = 0;
+    {
+        const float corners[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+        glGenVertexArrays(1, &splatVao);
+        glGenBuffers(1, &splatQuadVbo);
+        glGenBuffers(1, &splatInstanceVbo);
+        glBindVertexArray(splatVao);
+        glBindBuffer(GL_ARRAY_BUFFER, splatQuadVbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, splatInstanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, kMaxRipples * 4 * sizeof(float), nullptr, GL_STREAM_DRAW);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    std::vector<int> splatSlots(kMaxRipples);
+    std::vector<float> splatInstances(kMaxRipples * 4);
+
+    auto uploadWaveSpectrum = [&]() {
+        WaveBlockStd140 block;
+        fillWaveBlock(g_waveSpectrum, block);
+        glBindBuffer(GL_UNIFORM_BUFFER, waveUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
     };
+    int waveCount = g_waveSpectrum.count;
+    uploadWaveSpectrum();
 
     // Shadow-only shader
     const std::string shadowVsSource = readFile("shaders/shadow.vshader");
@@ -335,10 +477,15 @@ GLuint fsQuadVbo = 0;
     struct ShadowUniforms {
         GLint lightVP;
         GLint model;
+        GLint instanced;
+        GLint time;
     } shadowU{
         glGetUniformLocation(shadowProgram, "uLightVP"),
         glGetUniformLocation(shadowProgram, "uModel"),
+        glGetUniformLocation(shadowProgram, "uInstanced"),
+        glGetUniformLocation(shadowProgram, "uTime"),
     };
+    const MeshDecodeUniforms shadowDecode = meshDecodeUniforms(shadowProgram);
 
     // Post-process shaders (reuse fullscreen tri VAO)
     const std::string postVsSource = readFile("shaders/post.vshader");
@@ -396,7 +543,12 @@ GLuint fsQuadVbo = 0;
     Mesh ground = makeGroundMesh(halfSize);
     Mesh cube   = makeCubeMesh();
     Mesh cube2  = makeCubeMesh();
-    Mesh waterMesh = makeGroundMesh(halfSize); // big plane at water height
+    // Water surface: one clipmap mesh following the camera out to the far plane
+    constexpr float kWaterBaseCell = 0.1f;
+    constexpr float kWaterCoverage = 180.0f;
+    int waterVertexBudgetK = 64; // thousands of vertices, tunable in the Esc menu
+    ClipmapDesc waterClip = clipmapForBudget(waterVertexBudgetK * 1024, kWaterBaseCell, kWaterCoverage);
+    Mesh waterMesh = makeClipmapMesh(waterClip);
     Mesh boatMesh{};
     GLuint boatTexture = 0;
     Mesh fishMesh{};
@@ -424,6 +576,35 @@ GLuint fsQuadVbo = 0;
     } catch (const std::exception &e) {
         std::cerr << e.what() << " using flat color for fish\n";
     }
+    // Fish are drawn instanced: one draw per pass whatever the count, with the
+    // per-fish pose streamed each frame (see fishInstances / simple.vshader)
+    GLuint fishInstanceVbo = 0;
+    std::vector<float> fishInstanceData;
+    std::vector<float> fishInstanceSorted; // fishInstanceData grouped by LOD
+    std::vector<int> fishInstanceLod;
+    constexpr float kFishModelScale = 0.03f;
+    const Mat4 fishBody =
+        Mat4::rotateX(-kPi * 0.5f) * Mat4::scale(Vec3(kFishModelScale, kFishModelScale, kFishModelScale));
+    // Instance attributes from the first'th fish in the buffer on (GL 3.3 has
+    // no base instance); needs the fish VAO and instance VBO bound
+    auto bindFishInstances = [](int first) {
+        const GLsizei stride = kFishInstanceFloats * sizeof(float);
+        const uintptr_t base = static_cast<uintptr_t>(first) * stride;
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)base);
+        glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, (void*)(base + 4 * sizeof(float)));
+    };
+    {
+        glGenBuffers(1, &fishInstanceVbo);
+        glBindVertexArray(fishMesh.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, fishInstanceVbo);
+        bindFishInstances(0);
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, 1);
+        glEnableVertexAttribArray(4);
+        glVertexAttribDivisor(4, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
     try {
         chestMesh = loadObjMesh("assets/models/chest.obj");
     } catch (const std::exception &e) {
@@ -445,7 +626,10 @@ GLuint fsQuadVbo = 0;
     boat.pos = Vec3(-4.0f, 0.4f, 1.0f);
     boat.yawDeg = 20.0f;
     boat.speed = 0.0f;
-    std::vector<Fish> fish;
+    // AI traffic on rings and patrol lanes around the fishing pond
+    Fleet fleet;
+    initFleet(fleet, 24, 24.0f, 54.0f, kWaterHeight);
+    FishSchool fish;
     initFish(fish, 20, kWaterHeight);
     int fishCaught = 0;
     Rod rod;
@@ -475,8 +659,22 @@ GLuint fsQuadVbo = 0;
     GLuint waterNormalTex = createWaterNormalMap(256, 4.0f);
     GLuint waterDudvTex   = createDudvTexture(256);
 
+    // FFT ocean maps (only simulated and uploaded while the mode is active)
+    initOcean(OceanParams());
+    int oceanRes = oceanResolution();
+    bool fftOcean = g_waterMode == WaterMode::FftOcean;
+    GLuint oceanDispTex   = createSimulationTexture(oceanRes);
+    GLuint oceanNormalTex = createSimulationTexture(oceanRes);
+
+    // Shallow-water ripple grid around the player (same opt-in pattern)
+    initShallowWater(ShallowWaterParams());
+    bool shallowWater = g_rippleMode == RippleMode::ShallowWater;
+    GLuint sweTex = createSimulationTexture(shallowWaterResolution());
+
     bool showMenu = false;
     bool prevEsc = false;
+    bool showStats = false;
+    bool prevStatsKey = false;
 
     // Audio
     Audio audio;
@@ -509,6 +707,9 @@ GLuint fsQuadVbo = 0;
     const double kChestInterval = 300.0; // 5 real minutes between spawns
     double nextChestTime = glfwGetTime() + kChestInterval;
     int splashIndex = 0;
+    int lastFrameEvents = 0;
+    ModelLods lastBoatLods;
+    int lastFishPerLod[kMaxMeshLods] = {};
     float bgmVolume = 0.38f; // normalized 0..1 (~48/128)
     bool bgmMuted = false;
     // BGM cue points (seconds) based on provided timestamps
@@ -560,6 +761,11 @@ GLuint fsQuadVbo = 0;
         }
         prevEsc = escNow;
 
+        // Toggle the stats overlay with F3
+        bool statsKeyNow = (glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS);
+        if (statsKeyNow && !prevStatsKey) showStats = !showStats;
+        prevStatsKey = statsKeyNow;
+
         const double now = glfwGetTime();
         const float dt = static_cast<float>(now - lastTime);
         lastTime = now;
@@ -567,6 +773,23 @@ GLuint fsQuadVbo = 0;
 
         const bool inputEnabled = !showMenu;
 
+        // Cache the water surface around the camera for this frame's queries
+        if (g_waterMode == WaterMode::FftOcean) updateOcean(timef);
+        if (g_rippleMode == RippleMode::ShallowWater) {
+            // Floating bodies from last frame: boat hull as bow and stern disks
+            const Vec3 boatDir = boatForward(boat);
+            const Vec3 boatVel = boatDir * boat.speed;
+            std::array<SweBody, 5> bodies{};
+            int bodyCount = 0;
+            bodies[bodyCount++] = {boat.pos + boatDir * 0.6f, boatVel, 0.7f};
+            bodies[bodyCount++] = {boat.pos - boatDir * 0.6f, boatVel, 0.7f};
+            bodies[bodyCount++] = {cubePos, Vec3(0.0f, cubeVelY, 0.0f), 0.5f};
+            bodies[bodyCount++] = {cube2Pos, Vec3(0.0f, cube2VelY, 0.0f), 0.5f};
+            if (isRodInWater(rod)) bodies[bodyCount++] = {rod.pos, rod.vel, 0.08f};
+            updateShallowWater(cameraPos, dt, bodies.data(), bodyCount);
+        }
+        buildWaterField(cameraPos, timef);
+
         // Update capture flag based on menu
         g_mouseCaptured = !showMenu;
         if (showMenu) {
@@ -730,7 +953,29 @@ GLuint fsQuadVbo = 0;
        // Menu overlay
        if (showMenu) {
             MenuResult menuRes = drawEscMenu(fbWidth, audioReady, audio, g_mouseSensitivity,
-                                             bgmVolume, bgmMuted, bgmCueIndex, bgmCues);
+                                             bgmVolume, bgmMuted, bgmCueIndex, bgmCues, waveCount,
+                                             fftOcean, oceanRes, shallowWater, waterVertexBudgetK);
+            if (waveCount != g_waveSpectrum.count) {
+                buildWaveSpectrum(waveCount);
+                uploadWaveSpectrum();
+            }
+            g_waterMode = fftOcean ? WaterMode::FftOcean : WaterMode::Gerstner;
+            g_rippleMode = shallowWater ? RippleMode::ShallowWater : RippleMode::Rings;
+            const ClipmapDesc clip = clipmapForBudget(waterVertexBudgetK * 1024, kWaterBaseCell, kWaterCoverage);
+            if (clip.gridSize != waterClip.gridSize || clip.levels != waterClip.levels) {
+                destroyMesh(waterMesh);
+                waterClip = clip;
+                waterMesh = makeClipmapMesh(waterClip);
+            }
+            if (oceanRes != oceanResolution()) {
+                OceanParams params = oceanParams();
+                params.resolution = oceanRes;
+                initOcean(params);
+                glDeleteTextures(1, &oceanDispTex);
+                glDeleteTextures(1, &oceanNormalTex);
+                oceanDispTex   = createSimulationTexture(oceanRes);
+                oceanNormalTex = createSimulationTexture(oceanRes);
+            }
             if (menuRes.resume) {
                 showMenu = false;
                 g_mouseCaptured = true;
@@ -779,7 +1024,7 @@ GLuint fsQuadVbo = 0;
 
             const float seatHeight = 1.8f;
             const float seatBackDist = 0.01f;
-            cameraPos = boat.pos - boatDir * seatBackDist + Vec3(0.0f, seatHeight, 0.0f);
+            cameraPos = boat.pose.pos - boatDir * seatBackDist + Vec3(0.0f, seatHeight, 0.0f);
             // Apply view yaw offset and pitch for look-around without moving seat
             float viewYawDeg = boatCamYawDeg + boatViewYawOffset;
             float viewYawRad = viewYawDeg * (kPi / 180.0f);
@@ -811,11 +1056,25 @@ GLuint fsQuadVbo = 0;
                     audio.stopChannel(kBoatChannel);
                 }
             }
+        } else {
+            // Not driven: still rides the waves
+            updateBoat(boat, dt, false, false, false, false, kWaterHeight, timef);
         }
         if (!boatMode && audioReady) {
             audio.stopChannel(kBoatChannel);
         }
 
+        // AI fleet; it shoves the player's boat and the cubes it runs into
+        {
+            const float cubeRadius = 0.9f * std::sqrt(2.0f);
+            FleetContact fleetContacts[3] = {{boat.pos, 1.5f, Vec3()}, {cubePos, cubeRadius, Vec3()},
+                                             {cube2Pos, cubeRadius, Vec3()}};
+            updateFleet(fleet, dt, kWaterHeight, timef, cameraPos, fleetContacts, 3);
+            shoveBoat(boat, fleetContacts[0].push);
+            cubePos += fleetContacts[1].push;
+            cube2Pos += fleetContacts[2].push;
+        }
+
         // Allow going underwater; clamp only far below
         cameraPos.y = std::max(cameraPos.y, -10.0f);
 
@@ -860,8 +1119,7 @@ GLuint fsQuadVbo = 0;
                        16.0f / 9.0f;
         Vec3 viewPos = cameraPos;
         if (!underwater) {
-            Vec3 surf = evalGerstnerXZ(Vec3(cameraPos.x, 0.0f, cameraPos.z), timef);
-            viewPos.y += surf.y * 0.1f;
+            viewPos.y += surfaceHeight(cameraPos.x, cameraPos.z) * 0.1f;
         }
         Mat4 view = Mat4::lookAt(viewPos, viewPos + forward, up);
         Mat4 proj = Mat4::perspective(60.0f * (kPi / 180.0f), aspect, 0.1f, 200.0f);
@@ -888,6 +1146,52 @@ GLuint fsQuadVbo = 0;
             ImGui::Text("Time: %02d:%02d", hours, minutes);
             ImGui::SetWindowFontScale(1.0f);
             ImGui::End();
+
+            if (showStats) {
+                const WaterFieldStats &field = waterFieldStats();
+                ImGui::SetNextWindowPos(ImVec2(static_cast<float>(fbWidth) - padding, padding),
+                                        ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+                ImGui::SetNextWindowBgAlpha(0.7f);
+                ImGui::Begin("StatsHUD", nullptr, hudFlags);
+                ImGui::Text("Frame: %.2f ms", dt * 1000.0f);
+                ImGui::Text("Water mesh: %d tris, %d verts, %d levels, 1 draw",
+                            waterMesh.indexCount / 3, waterMesh.vertexCount, waterClip.levels);
+                ImGui::Text("Water field: %.2f ms, %d solver iters", field.buildMs, field.solverIters);
+                ImGui::Text("Models: boat %.0f KB, fish %.0f KB, chest %.0f KB (%d/%d/%d B per vertex)",
+                            meshBytes(boatMesh) / 1024.0, meshBytes(fishMesh) / 1024.0,
+                            meshBytes(chestMesh) / 1024.0, boatMesh.vertexStride, fishMesh.vertexStride,
+                            chestMesh.vertexStride);
+                ImGui::Text("Model LODs: boat %d/%d/%d of %d (shadow/scene/reflection), fish per LOD %d/%d/%d/%d",
+                            lastBoatLods.shadow, lastBoatLods.scene, lastBoatLods.reflection,
+                            std::max(boatMesh.lodCount, 1), lastFishPerLod[0], lastFishPerLod[1],
+                            lastFishPerLod[2], lastFishPerLod[3]);
+                if (g_waterMode == WaterMode::FftOcean) {
+                    const OceanStats &ocean = oceanStats();
+                    ImGui::Text("Ocean %d^2: %.2f ms (FFT %.2f ms)", oceanResolution(),
+                                ocean.updateMs, ocean.fftMs);
+                }
+                if (g_rippleMode == RippleMode::ShallowWater) {
+                    const ShallowWaterStats &swe = shallowWaterStats();
+                    ImGui::Text("Shallow water %d^2: %.2f ms (%d steps, %.2f ms each)",
+                                shallowWaterResolution(), swe.updateMs, swe.steps, swe.stepMs);
+                }
+                ImGui::Text("Stones: %d live, %.2f ms", stoneStats().live, stoneStats().updateMs);
+                ImGui::Text("Fleet: %d boats, %.2f ms (%d steps, %d contacts, %d wakes)", fleetStats().boats,
+                            fleetStats().updateMs, fleetStats().steps, fleetStats().contacts, fleetStats().wakes);
+                ImGui::Text("Fish: %d swimming, %.2f ms (grid %.2f ms, %.1f neighbours)",
+                            fishStats().swimming, fishStats().updateMs, fishStats().gridMs,
+                            fishStats().avgNeighbours);
+                ImGui::Text("  AI LOD: %d near, %d/%d mid (every %d frames), %d far, radius x%.2f",
+                            fishStats().lodNear, fishStats().lodMidSteered, fishStats().lodMid,
+                            fishStats().lodSlice, fishStats().lodFar, fishStats().lodScale);
+                const GameEventStats events = gameEventStats();
+                uint64_t totalEvents = 0;
+                for (uint64_t n : events.pushed) totalEvents += n;
+                ImGui::Text("Events: %d this frame, %llu total, %llu dropped", lastFrameEvents,
+                            static_cast<unsigned long long>(totalEvents),
+                            static_cast<unsigned long long>(events.dropped));
+                ImGui::End();
+            }
         }
 
         // Light view-projection for shadows
@@ -899,9 +1203,7 @@ GLuint fsQuadVbo = 0;
 
         // Buoyancy update for floating cubes
         auto updateFloat = [&](Vec3 &pos, float &velY) {
-            Vec3 sample(pos.x, 0.0f, pos.z);
-        Vec3 surf = evalGerstnerXZ(sample, timef);
-        float surfaceY = kWaterHeight + surf.y + rippleFieldHeight(sample, timef);
+        float surfaceY = kWaterHeight + surfaceHeight(pos.x, pos.z);
         float targetY = surfaceY + 0.3f;
         float dy = targetY - pos.y;
         float stiffness = 4.0f;
@@ -909,8 +1211,8 @@ GLuint fsQuadVbo = 0;
         velY += stiffness * dy * dt;
         velY *= std::exp(-damping * dt);
         pos.y += velY * dt;
-        // Gentle lateral push from ripple slope
-        Vec3 grad = rippleFieldGrad(sample, timef);
+        // Gentle lateral push from the ripple slope (the waves only bob the cubes)
+        Vec3 grad = rippleGradient(pos.x, pos.z);
         pos.x += grad.x * 0.5f * dt;
         pos.z += grad.z * 0.5f * dt;
     };
@@ -918,30 +1220,53 @@ GLuint fsQuadVbo = 0;
         updateFloat(cube2Pos, cube2VelY);
 
         // Skipping stone motion (stones can hit cubes and add ripples)
-        updateStones(dt, timef, kWaterHeight, cubePos, cube2Pos, cubeVelY, cube2VelY, boat.pos, 1.5f);
-        if (audioReady && !audio.isChannelPlaying(kSplashChannel)) {
-            if (consumeTinySplash()) {
-                audio.play("tiny_splash", 0, kSplashChannel, 128);
-            } else if (consumeWaterSplash()) {
-                if (splashIndex == 0) {
-                    audio.play("drop1", 0, kSplashChannel, 128);
-                } else if (splashIndex == 1) {
-                    audio.play("drop2", 0, kSplashChannel, 128);
-                } else {
-                    audio.play("drop3", 0, kSplashChannel, 128);
-                }
+        StoneCollider stoneTargets[3];
+        stoneTargets[0].pos = cubePos;
+        stoneTargets[0].radius = 0.6f;
+        stoneTargets[0].box = true;
+        stoneTargets[1] = stoneTargets[0];
+        stoneTargets[1].pos = cube2Pos;
+        stoneTargets[2].pos = boat.pos;
+        stoneTargets[2].radius = 1.5f;
+        stoneTargets[2].hitEvent = GameEventType::BoatHit;
+        updateStones(dt, timef, kWaterHeight, stoneTargets, 3);
+        cubeVelY += 2.5f * static_cast<float>(stoneTargets[0].hits);
+        cubePos += stoneTargets[0].push * 0.08f;
+        cube2VelY += 2.5f * static_cast<float>(stoneTargets[1].hits);
+        cube2Pos += stoneTargets[1].push * 0.08f;
+        updateRod(rod, dt, timef, kWaterHeight);
+
+        // Every splash and hit raised this frame, in order. Splashes prefer
+        // the splash channel and spill onto any free one when it is busy.
+        lastFrameEvents = drainGameEvents([&](const GameEvent &e) {
+            if (!audioReady) return;
+            const int volume = static_cast<int>(128.0f * (0.6f + 0.4f * e.intensity));
+            const int channel = audio.isChannelPlaying(kSplashChannel) ? -1 : kSplashChannel;
+            switch (e.type) {
+            case GameEventType::TinySplash:
+                audio.play("tiny_splash", 0, channel, volume);
+                break;
+            case GameEventType::WaterSplash:
+                audio.play(splashIndex == 0 ? "drop1" : (splashIndex == 1 ? "drop2" : "drop3"),
+                           0, channel, volume);
                 splashIndex = std::min(splashIndex + 1, 2);
+                break;
+            case GameEventType::CubeHit:
+            case GameEventType::BoatHit:
+                audio.play("hit_thud", 0, -1, std::min(volume, 110));
+                break;
+            case GameEventType::LureSplash:
+                break;
             }
-        }
-        if (audioReady && (consumeCubeHit() || consumeBoatHit())) {
-            audio.play("hit_thud", 0, -1, 110);
-        }
-        updateRod(rod, dt, timef, kWaterHeight);
+        });
         pruneRipples(timef);
 
         int fishBefore = fishCaught;
         // Fish update
-        updateFish(fish, dt, timef, kWaterHeight, boat, rod, cubePos, cube2Pos, cameraPos, underwater, fishCaught);
+        FishObstacle fishAvoid[4] = {{Vec3(boat.pos.x, 0.0f, boat.pos.z), 2.0f},
+                                     {cubePos, 1.2f}, {cube2Pos, 1.2f}, {cameraPos, 2.5f}};
+        // The player only scares fish when underwater
+        updateFish(fish, dt, timef, kWaterHeight, cameraPos, fishAvoid, underwater ? 4 : 3, rod, fishCaught);
         if (audioReady && fishCaught > fishBefore) {
             audio.play("fish_catch", 0, -1, 128);
         }
@@ -977,17 +1302,28 @@ GLuint fsQuadVbo = 0;
         Mat4 modelCube = Mat4::translate(cubePos);
         Mat4 modelCube2 = Mat4::translate(cube2Pos);
         Mat4 modelChest = Mat4::identity();
+        constexpr float kChestModelScale = 0.25f;
         if (chest.active) {
             modelChest = Mat4::translate(chest.pos) *
                          Mat4::rotateY(timef * 0.5f) *
-                         Mat4::scale(Vec3(0.25f, 0.25f, 0.25f));
+                         Mat4::scale(Vec3(kChestModelScale, kChestModelScale, kChestModelScale));
         }
         // Scale down/imported meshes so they fit the scene/water plane
         constexpr float kBoatModelYawOffsetDeg = 180.0f; // align mesh nose with physics forward
-        Mat4 modelBoat = Mat4::translate(boat.pos) *
-                         Mat4::rotateY((boat.yawDeg + kBoatModelYawOffsetDeg) * (kPi / 180.0f)) *
+        constexpr float kBoatModelScale = 0.016f;
+        Mat4 modelBoat = Mat4::translate(boat.pose.pos) * boatTilt(boat.pose) *
+                         Mat4::rotateY((boat.pose.yawDeg + kBoatModelYawOffsetDeg) * (kPi / 180.0f)) *
                          Mat4::rotateX(-kPi * 0.5f) *
-                         Mat4::scale(Vec3(0.016f, 0.016f, 0.016f));
+                         Mat4::scale(Vec3(kBoatModelScale, kBoatModelScale, kBoatModelScale));
+        std::vector<Mat4> fleetModels;
+        fleetModels.reserve(fleet.count);
+        for (int i = 0; i < fleet.count; ++i) {
+            const BoatPose pose = fleetBoatPose(fleet, i);
+            fleetModels.push_back(Mat4::translate(pose.pos) * boatTilt(pose) *
+                                  Mat4::rotateY((pose.yawDeg + kBoatModelYawOffsetDeg) * (kPi / 180.0f)) *
+                                  Mat4::rotateX(-kPi * 0.5f) *
+                                  Mat4::scale(Vec3(kBoatModelScale, kBoatModelScale, kBoatModelScale)));
+        }
         const float tileSize = halfSize * 2.0f;
         const int tileRadius = 3;
         float baseX = std::floor(cameraPos.x / tileSize) * tileSize;
@@ -1011,6 +1347,127 @@ GLuint fsQuadVbo = 0;
         Mat4 reflProj = proj;
         Mat4 reflViewProj = reflProj * reflView;
 
+        // Model LODs per pass, by projected size: pixels per metre at 1 m for
+        // proj's 60 degree field of view, and per metre across lightProj's
+        // 40 m square
+        const float scenePixels = fbHeight / (2.0f * std::tan(30.0f * (kPi / 180.0f)));
+        const float reflectionPixels = reflectionFb.height / (2.0f * std::tan(30.0f * (kPi / 180.0f)));
+        const float shadowPixels = shadowMap.width / 40.0f;
+        auto perspectiveLod = [](const Mesh &m, float pixels, float scale, float distance, float pixelError) {
+            return selectMeshLod(m, pixels * scale / std::max(distance, 0.1f), pixelError);
+        };
+        auto modelLods = [&](const Mesh &m, float scale, const Vec3 &pos) {
+            ModelLods lods;
+            lods.shadow = selectMeshLod(m, shadowPixels * scale, kLodShadowPixelError);
+            lods.scene = perspectiveLod(m, scenePixels, scale, length(pos - viewPos), kLodPixelError);
+            lods.reflection =
+                perspectiveLod(m, reflectionPixels, scale, length(pos - reflPos), kLodReflectionPixelError);
+            return lods;
+        };
+        const ModelLods boatLods = modelLods(boatMesh, kBoatModelScale, boat.pose.pos);
+        std::vector<ModelLods> fleetLods(fleetModels.size());
+        for (int i = 0; i < static_cast<int>(fleetLods.size()); ++i) {
+            fleetLods[i] = modelLods(boatMesh, kBoatModelScale, fleetBoatPose(fleet, i).pos);
+        }
+        const ModelLods chestLods = modelLods(chestMesh, kChestModelScale, chest.pos);
+        lastBoatLods = boatLods;
+
+        // --------- Ripple splat pass ---------
+        const float rippleTexel = kRippleMapSize / kRippleMapRes;
+        const float rippleOriginX = std::floor(cameraPos.x / rippleTexel - 0.5f * kRippleMapRes) * rippleTexel;
+        const float rippleOriginZ = std::floor(cameraPos.z / rippleTexel - 0.5f * kRippleMapRes) * rippleTexel;
+        if (g_rippleMode == RippleMode::Rings) {
+            const int splatCount = gatherRipples(rippleOriginX, rippleOriginZ,
+                                                 rippleOriginX + kRippleMapSize, rippleOriginZ + kRippleMapSize,
+                                                 timef, splatSlots.data(), kMaxRipples);
+            for (int i = 0; i < splatCount; ++i) {
+                const RippleEvent &r = g_ripples[splatSlots[i]];
+                splatInstances[i * 4 + 0] = r.pos.x;
+                splatInstances[i * 4 + 1] = r.pos.z;
+                splatInstances[i * 4 + 2] = r.startTime;
+                splatInstances[i * 4 + 3] = r.radius;
+            }
+            glBindFramebuffer(GL_FRAMEBUFFER, rippleFb.fbo);
+            glViewport(0, 0, rippleFb.width, rippleFb.height);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            if (splatCount > 0) {
+                glBindBuffer(GL_ARRAY_BUFFER, splatInstanceVbo);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, splatCount * 4 * sizeof(float), splatInstances.data());
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                glDisable(GL_DEPTH_TEST);
+                glDisable(GL_CULL_FACE);
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_ONE, GL_ONE);
+                glUseProgram(splatProgram);
+                glUniform2f(splatU.origin, rippleOriginX, rippleOriginZ);
+                glUniform1f(splatU.size, kRippleMapSize);
+                glUniform1f(splatU.res, static_cast<float>(kRippleMapRes));
+                glUniform1f(splatU.time, timef);
+                glBindVertexArray(splatVao);
+                glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, splatCount);
+                glBindVertexArray(0);
+                glDisable(GL_BLEND);
+                glEnable(GL_CULL_FACE);
+                glEnable(GL_DEPTH_TEST);
+            }
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        // Fish poses for every pass below, grouped by scene LOD so each group
+        // is one instanced draw. Reflected, a group may go coarser still, by
+        // its fish nearest the reflection camera; the shadow map is
+        // orthographic, so one LOD fits every fish.
+        fishInstanceData.resize(static_cast<size_t>(fish.count) * kFishInstanceFloats);
+        const int fishDrawn = fishInstances(fish, fishInstanceData.data());
+        int fishLodFirst[kMaxMeshLods] = {}, fishLodCount[kMaxMeshLods] = {};
+        float fishLodReflDistance[kMaxMeshLods];
+        std::fill(std::begin(fishLodReflDistance), std::end(fishLodReflDistance), 1e30f);
+        fishInstanceLod.resize(fishDrawn);
+        for (int i = 0; i < fishDrawn; ++i) {
+            const float *f = &fishInstanceData[static_cast<size_t>(i) * kFishInstanceFloats];
+            const Vec3 pos(f[0], f[1], f[2]);
+            const int lod =
+                perspectiveLod(fishMesh, scenePixels, kFishModelScale, length(pos - viewPos), kLodPixelError);
+            fishInstanceLod[i] = lod;
+            ++fishLodCount[lod];
+            fishLodReflDistance[lod] = std::min(fishLodReflDistance[lod], length(pos - reflPos));
+        }
+        int fishSceneLods[kMaxMeshLods], fishReflectionLods[kMaxMeshLods];
+        for (int l = 0; l < kMaxMeshLods; ++l) {
+            if (l > 0) fishLodFirst[l] = fishLodFirst[l - 1] + fishLodCount[l - 1];
+            fishSceneLods[l] = l;
+            fishReflectionLods[l] = std::max(l, perspectiveLod(fishMesh, reflectionPixels, kFishModelScale,
+                                                               fishLodReflDistance[l], kLodReflectionPixelError));
+            lastFishPerLod[l] = fishLodCount[l];
+        }
+        const int fishShadowLod = selectMeshLod(fishMesh, shadowPixels * kFishModelScale, kLodShadowPixelError);
+        {
+            int fill[kMaxMeshLods];
+            std::copy(std::begin(fishLodFirst), std::end(fishLodFirst), fill);
+            fishInstanceSorted.resize(static_cast<size_t>(fishDrawn) * kFishInstanceFloats);
+            for (int i = 0; i < fishDrawn; ++i) {
+                std::copy_n(&fishInstanceData[static_cast<size_t>(i) * kFishInstanceFloats], kFishInstanceFloats,
+                            &fishInstanceSorted[static_cast<size_t>(fill[fishInstanceLod[i]]++) * kFishInstanceFloats]);
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, fishInstanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, fishDrawn * kFishInstanceFloats * sizeof(float), fishInstanceSorted.data(),
+                     GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        // One instanced draw per group, group l at LOD lods[l]
+        auto drawFishGroups = [&](const MeshDecodeUniforms &decode, const int *lods) {
+            glBindVertexArray(fishMesh.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, fishInstanceVbo);
+            for (int l = 0; l < kMaxMeshLods; ++l) {
+                if (fishLodCount[l] == 0) continue;
+                bindFishInstances(fishLodFirst[l]);
+                drawMeshInstanced(fishMesh, fishLodCount[l], decode, lods[l]);
+            }
+            bindFishInstances(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        };
+
         // --------- Shadow map pass ---------
         glViewport(0, 0, shadowMap.width, shadowMap.height);
         glBindFramebuffer(GL_FRAMEBUFFER, shadowMap.fbo);
@@ -1020,6 +1477,7 @@ GLuint fsQuadVbo = 0;
 
         glUseProgram(shadowProgram);
         glUniformMatrix4fv(shadowU.lightVP, 1, GL_FALSE, lightVP.m.data());
+        glUniform1f(shadowU.time, timef);
 
         // Ground tiles
         glBindVertexArray(ground.vao);
@@ -1038,22 +1496,21 @@ GLuint fsQuadVbo = 0;
         glBindVertexArray(cube2.vao);
         glDrawArrays(GL_TRIANGLES, 0, cube2.vertexCount);
 
-        // Boat
+        // Boat and fleet
         glUniformMatrix4fv(shadowU.model, 1, GL_FALSE, modelBoat.m.data());
         glBindVertexArray(boatMesh.vao);
-        glDrawArrays(GL_TRIANGLES, 0, boatMesh.vertexCount);
+        drawMesh(boatMesh, shadowDecode, boatLods.shadow);
+        for (size_t i = 0; i < fleetModels.size(); ++i) {
+            glUniformMatrix4fv(shadowU.model, 1, GL_FALSE, fleetModels[i].m.data());
+            drawMesh(boatMesh, shadowDecode, fleetLods[i].shadow);
+        }
 
         // Fish
-        for (const auto &f : fish) {
-            if (!f.active) continue;
-            Mat4 modelFish = Mat4::translate(f.pos) *
-                             Mat4::rotateY((f.yawDeg + 180.0f) * (kPi / 180.0f)) *
-                             Mat4::rotateX(-kPi * 0.5f) *
-                             Mat4::scale(Vec3(0.03f, 0.03f, 0.03f));
-            glUniformMatrix4fv(shadowU.model, 1, GL_FALSE, modelFish.m.data());
-            glBindVertexArray(fishMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, fishMesh.vertexCount);
-        }
+        glUniformMatrix4fv(shadowU.model, 1, GL_FALSE, fishBody.m.data());
+        glUniform1i(shadowU.instanced, 1);
+        glBindVertexArray(fishMesh.vao);
+        drawMeshInstanced(fishMesh, fishDrawn, shadowDecode, fishShadowLod);
+        glUniform1i(shadowU.instanced, 0);
 
         // Rod shadow (small red cube)
         if (rod.active) {
@@ -1064,11 +1521,8 @@ GLuint fsQuadVbo = 0;
         }
 
         // Skipping stones
-        for (int i = 0; i < kMaxStones; ++i) {
-            const Stone &s = g_stones[i];
-            if (!s.active) continue;
-
-            Mat4 modelStone = Mat4::translate(s.pos) * Mat4::scale(Vec3(0.25f, 0.05f, 0.25f));
+        for (int i = 0; i < g_stones.count; ++i) {
+            Mat4 modelStone = Mat4::translate(stonePosition(i)) * Mat4::scale(Vec3(0.25f, 0.05f, 0.25f));
             glUniformMatrix4fv(shadowU.model, 1, GL_FALSE, modelStone.m.data());
             glBindVertexArray(cube.vao);
             glDrawArrays(GL_TRIANGLES, 0, cube.vertexCount);
@@ -1078,7 +1532,7 @@ GLuint fsQuadVbo = 0;
         if (chest.active) {
             glUniformMatrix4fv(shadowU.model, 1, GL_FALSE, modelChest.m.data());
             glBindVertexArray(chestMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, chestMesh.vertexCount);
+            drawMesh(chestMesh, shadowDecode, chestLods.shadow);
         }
 
         glCullFace(GL_BACK);
@@ -1147,40 +1601,33 @@ GLuint fsQuadVbo = 0;
                 glUniform3f(sceneU.color, 0.65f, 0.35f, 0.25f);
             }
             glBindVertexArray(boatMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, boatMesh.vertexCount);
+            drawMesh(boatMesh, sceneDecode, boatLods.scene);
+            for (size_t i = 0; i < fleetModels.size(); ++i) {
+                glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, fleetModels[i].m.data());
+                drawMesh(boatMesh, sceneDecode, fleetLods[i].scene);
+            }
             glUniform1i(sceneU.useTexture, 0);
         }
 
         // Fish
-        for (const auto &f : fish) {
-            if (!f.active) continue;
-            float rollRad = std::clamp(-f.yawVel * 0.005f, -0.4f, 0.4f); // bank with turn
-            Mat4 modelFish = Mat4::translate(f.pos) *
-                             Mat4::rotateY((f.yawDeg + 180.0f) * (kPi / 180.0f)) *
-                             Mat4::rotateX(-kPi * 0.5f) *
-                             Mat4::rotateZ(rollRad) *
-                             Mat4::scale(Vec3(0.03f, 0.03f, 0.03f));
-        glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, modelFish.m.data());
-            glUniform1i(sceneU.useTexture, fishTexture ? 1 : 0);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, fishTexture);
-            if (fishTexture) {
-                glUniform3f(sceneU.color, 1.0f, 1.0f, 1.0f);
-            } else {
-                glUniform3f(sceneU.color, 0.6f, 1.0f, 1.4f);
-            }
-            glBindVertexArray(fishMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, fishMesh.vertexCount);
+        glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, fishBody.m.data());
+        glUniform1i(sceneU.useTexture, fishTexture ? 1 : 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, fishTexture);
+        if (fishTexture) {
+            glUniform3f(sceneU.color, 1.0f, 1.0f, 1.0f);
+        } else {
+            glUniform3f(sceneU.color, 0.6f, 1.0f, 1.4f);
         }
+        glUniform1i(sceneU.instanced, 1);
+        drawFishGroups(sceneDecode, fishSceneLods);
+        glUniform1i(sceneU.instanced, 0);
         glUniform1i(sceneU.useTexture, 0);
         glBindTexture(GL_TEXTURE_2D, 0);
 
         // Stones prepass
-        for (int i = 0; i < kMaxStones; ++i) {
-            const Stone &s = g_stones[i];
-            if (!s.active) continue;
-
-            Mat4 modelStone = Mat4::translate(s.pos) * Mat4::scale(Vec3(0.25f, 0.05f, 0.25f));
+        for (int i = 0; i < g_stones.count; ++i) {
+            Mat4 modelStone = Mat4::translate(stonePosition(i)) * Mat4::scale(Vec3(0.25f, 0.05f, 0.25f));
             glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, modelStone.m.data());
             glUniform3f(sceneU.color, 0.65f, 0.65f, 0.7f);
             glBindVertexArray(cube.vao);
@@ -1192,7 +1639,7 @@ GLuint fsQuadVbo = 0;
             glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, modelChest.m.data());
             glUniform3f(sceneU.color, 0.6f, 0.4f, 0.15f);
             glBindVertexArray(chestMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, chestMesh.vertexCount);
+            drawMesh(chestMesh, sceneDecode, chestLods.scene);
         }
 
         glBindTexture(GL_TEXTURE_2D, sceneFb.colorTex);
@@ -1256,35 +1703,32 @@ GLuint fsQuadVbo = 0;
                 glUniform3f(sceneU.color, 0.65f, 0.35f, 0.25f);
             }
             glBindVertexArray(boatMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, boatMesh.vertexCount);
+            drawMesh(boatMesh, sceneDecode, boatLods.reflection);
+            for (size_t i = 0; i < fleetModels.size(); ++i) {
+                glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, fleetModels[i].m.data());
+                drawMesh(boatMesh, sceneDecode, fleetLods[i].reflection);
+            }
             glUniform1i(sceneU.useTexture, 0);
         }
 
         // Fish
-        for (const auto &f : fish) {
-            if (!f.active) continue;
-            Mat4 modelFish = Mat4::translate(f.pos) *
-                             Mat4::rotateY((f.yawDeg + 180.0f) * (kPi / 180.0f)) *
-                             Mat4::rotateX(-kPi * 0.5f) *
-                             Mat4::scale(Vec3(0.03f, 0.03f, 0.03f));
-            glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, modelFish.m.data());
-            glUniform1i(sceneU.useTexture, fishTexture ? 1 : 0);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, fishTexture);
+        glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, fishBody.m.data());
+        glUniform1i(sceneU.useTexture, fishTexture ? 1 : 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, fishTexture);
+        {
             Vec3 fishBaseColor = fishTexture ? Vec3(1.0f, 1.0f, 1.0f) : Vec3(0.6f, 1.0f, 1.4f);
             glUniform3f(sceneU.color, fishBaseColor.x, fishBaseColor.y, fishBaseColor.z);
-            glBindVertexArray(fishMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, fishMesh.vertexCount);
         }
+        glUniform1i(sceneU.instanced, 1);
+        drawFishGroups(sceneDecode, fishReflectionLods);
+        glUniform1i(sceneU.instanced, 0);
         glUniform1i(sceneU.useTexture, 0);
         glBindTexture(GL_TEXTURE_2D, 0);
 
         // Stones reflected
-        for (int i = 0; i < kMaxStones; ++i) {
-            const Stone &s = g_stones[i];
-            if (!s.active) continue;
-
-            Mat4 modelStone = Mat4::translate(s.pos) * Mat4::scale(Vec3(0.25f, 0.05f, 0.25f));
+        for (int i = 0; i < g_stones.count; ++i) {
+            Mat4 modelStone = Mat4::translate(stonePosition(i)) * Mat4::scale(Vec3(0.25f, 0.05f, 0.25f));
             glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, modelStone.m.data());
             glUniform3f(sceneU.color, 0.65f, 0.65f, 0.7f);
             glBindVertexArray(cube.vao);
@@ -1296,7 +1740,7 @@ GLuint fsQuadVbo = 0;
             glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, modelChest.m.data());
             glUniform3f(sceneU.color, 0.6f, 0.4f, 0.15f);
             glBindVertexArray(chestMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, chestMesh.vertexCount);
+            drawMesh(chestMesh, sceneDecode, chestLods.reflection);
 
             // Glow column (reflective, does not cast shadow)
             Mat4 glowModel = Mat4::translate(chest.pos + Vec3(0.0f, 3.0f, 0.0f)) *
@@ -1435,34 +1879,29 @@ GLuint fsQuadVbo = 0;
                 glUniform3f(sceneU.color, 0.65f, 0.35f, 0.25f);
             }
             glBindVertexArray(boatMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, boatMesh.vertexCount);
+            drawMesh(boatMesh, sceneDecode, boatLods.scene);
+            for (size_t i = 0; i < fleetModels.size(); ++i) {
+                glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, fleetModels[i].m.data());
+                drawMesh(boatMesh, sceneDecode, fleetLods[i].scene);
+            }
             glUniform1i(sceneU.useTexture, 0);
         }
 
         // Fish
-        for (const auto &f : fish) {
-            if (!f.active) continue;
-            Mat4 modelFish = Mat4::translate(f.pos) *
-                             Mat4::rotateY((f.yawDeg + 180.0f) * (kPi / 180.0f)) *
-                             Mat4::rotateX(-kPi * 0.5f) *
-                             Mat4::scale(Vec3(0.03f, 0.03f, 0.03f));
-            glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, modelFish.m.data());
-            glUniform1i(sceneU.useTexture, fishTexture ? 1 : 0);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, fishTexture);
-            glUniform3f(sceneU.color, 0.6f, 1.0f, 1.4f);
-            glBindVertexArray(fishMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, fishMesh.vertexCount);
-        }
+        glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, fishBody.m.data());
+        glUniform1i(sceneU.useTexture, fishTexture ? 1 : 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, fishTexture);
+        glUniform3f(sceneU.color, 0.6f, 1.0f, 1.4f);
+        glUniform1i(sceneU.instanced, 1);
+        drawFishGroups(sceneDecode, fishSceneLods);
+        glUniform1i(sceneU.instanced, 0);
         glUniform1i(sceneU.useTexture, 0);
         glBindTexture(GL_TEXTURE_2D, 0);
 
         // Skipping stones
-        for (int i = 0; i < kMaxStones; ++i) {
-            const Stone &s = g_stones[i];
-            if (!s.active) continue;
-
-            Mat4 modelStone = Mat4::translate(s.pos) * Mat4::scale(Vec3(0.25f, 0.05f, 0.25f));
+        for (int i = 0; i < g_stones.count; ++i) {
+            Mat4 modelStone = Mat4::translate(stonePosition(i)) * Mat4::scale(Vec3(0.25f, 0.05f, 0.25f));
             glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, modelStone.m.data());
             glUniform3f(sceneU.color, 0.65f, 0.65f, 0.7f);
             glBindVertexArray(cube.vao);
@@ -1483,7 +1922,7 @@ GLuint fsQuadVbo = 0;
             glUniformMatrix4fv(sceneU.model, 1, GL_FALSE, modelChest.m.data());
             glUniform3f(sceneU.color, 0.6f, 0.4f, 0.15f);
             glBindVertexArray(chestMesh.vao);
-            glDrawArrays(GL_TRIANGLES, 0, chestMesh.vertexCount);
+            drawMesh(chestMesh, sceneDecode, chestLods.scene);
 
             // Glow column visible above water
             Mat4 glowModel = Mat4::translate(chest.pos + Vec3(0.0f, 3.0f, 0.0f)) *
@@ -1528,24 +1967,6 @@ GLuint fsQuadVbo = 0;
         glUniform1f(waterU.refrDistort, 0.25f);
         glUniform1i(waterU.underwater, underwater ? 1 : 0);
         glUniformMatrix4fv(waterU.lightVP, 1, GL_FALSE, lightVP.m.data());
-        {
-            std::array<float, kMaxRipples * 4> rippleBuf{};
-            int rippleCount = 0;
-            for (int i = 0; i < kMaxRipples; ++i) {
-                if (!g_ripples[i].active) continue;
-                rippleBuf[rippleCount * 4 + 0] = g_ripples[i].pos.x;
-                rippleBuf[rippleCount * 4 + 1] = g_ripples[i].pos.y;
-                rippleBuf[rippleCount * 4 + 2] = g_ripples[i].pos.z;
-                rippleBuf[rippleCount * 4 + 3] = g_ripples[i].startTime;
-                rippleCount++;
-                if (rippleCount >= kMaxRipples) break;
-            }
-            glUniform1i(waterU.rippleCount, rippleCount);
-            if (rippleCount > 0 && waterU.ripples >= 0) {
-                glUniform4fv(waterU.ripples, rippleCount, rippleBuf.data());
-            }
-        }
-
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, reflectionFb.colorTex);
         glUniform1i(waterU.refl, 0);
@@ -1570,20 +1991,47 @@ GLuint fsQuadVbo = 0;
         glBindTexture(GL_TEXTURE_2D, shadowMap.depthTex);
         glUniform1i(waterU.shadowMap, 5);
 
+        glUniform1i(waterU.waterMode, g_waterMode == WaterMode::FftOcean ? 1 : 0);
+        glUniform1f(waterU.oceanPatch, oceanParams().patchSize);
+        if (g_waterMode == WaterMode::FftOcean) {
+            uploadSimulationTexture(oceanDispTex, oceanResolution(), oceanDisplacementMap(), false);
+            uploadSimulationTexture(oceanNormalTex, oceanResolution(), oceanNormalFoamMap(), true);
+        }
+        glActiveTexture(GL_TEXTURE6);
+        glBindTexture(GL_TEXTURE_2D, oceanDispTex);
+        glUniform1i(waterU.oceanDisp, 6);
+
+        glActiveTexture(GL_TEXTURE7);
+        glBindTexture(GL_TEXTURE_2D, oceanNormalTex);
+        glUniform1i(waterU.oceanNormal, 7);
+
+        // Ripple map: the splatted rings, or the shallow-water grid in that mode
+        glActiveTexture(GL_TEXTURE8);
+        if (g_rippleMode == RippleMode::ShallowWater) {
+            uploadSimulationTexture(sweTex, shallowWaterResolution(), shallowWaterMap(), false);
+            float sweX = 0.0f, sweZ = 0.0f;
+            shallowWaterOrigin(sweX, sweZ);
+            glBindTexture(GL_TEXTURE_2D, sweTex);
+            glUniform2f(waterU.rippleOrigin, sweX, sweZ);
+            glUniform1f(waterU.rippleSize, shallowWaterResolution() * shallowWaterParams().cellSize);
+        } else {
+            glBindTexture(GL_TEXTURE_2D, rippleFb.colorTex);
+            glUniform2f(waterU.rippleOrigin, rippleOriginX, rippleOriginZ);
+            glUniform1f(waterU.rippleSize, kRippleMapSize);
+        }
+        glUniform1i(waterU.rippleMap, 8);
+
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         glBindVertexArray(waterMesh.vao);
 
-        for (int dz = -tileRadius; dz <= tileRadius; ++dz) {
-            for (int dx = -tileRadius; dx <= tileRadius; ++dx) {
-                float tileX = baseX + dx * tileSize;
-                float tileZ = baseZ + dz * tileSize;
-
-                Mat4 modelWater = Mat4::translate(Vec3(tileX, kWaterHeight, tileZ));
-                glUniformMatrix4fv(waterU.model, 1, GL_FALSE, modelWater.m.data());
-                glDrawArrays(GL_TRIANGLES, 0, waterMesh.vertexCount);
-            }
-        }
+        Mat4 modelWater = Mat4::translate(Vec3(0.0f, kWaterHeight, 0.0f));
+        glUniformMatrix4fv(waterU.model, 1, GL_FALSE, modelWater.m.data());
+        glUniform3f(waterU.clipEye, cameraPos.x, cameraPos.y, cameraPos.z);
+        glUniform1f(waterU.clipBaseCell, waterClip.baseCell);
+        glUniform1f(waterU.clipGrid, static_cast<float>(waterClip.gridSize));
+        glUniform1i(waterU.clipLevels, waterClip.levels);
+        glDrawElements(GL_TRIANGLES, waterMesh.indexCount, GL_UNSIGNED_INT, nullptr);
 
         glDisable(GL_BLEND);
         glBindVertexArray(0);
@@ -1727,6 +2175,7 @@ GLuint fsQuadVbo = 0;
     glDeleteProgram(blurProgram);
     glDeleteProgram(tonemapProgram);
     glDeleteProgram(fxaaProgram);
+    glDeleteProgram(splatProgram);
 
     glDeleteShader(sceneVs);
     glDeleteShader(sceneFs);
@@ -1741,9 +2190,16 @@ GLuint fsQuadVbo = 0;
     glDeleteShader(blurFs);
     glDeleteShader(tonemapFs);
     glDeleteShader(fxaaFs);
+    glDeleteShader(splatVs);
+    glDeleteShader(splatFs);
 
     glDeleteVertexArrays(1, &fsQuadVao);
     glDeleteBuffers(1, &fsQuadVbo);
+    glDeleteBuffers(1, &waveUbo);
+    glDeleteVertexArrays(1, &splatVao);
+    glDeleteBuffers(1, &fishInstanceVbo);
+    glDeleteBuffers(1, &splatQuadVbo);
+    glDeleteBuffers(1, &splatInstanceVbo);
 
     destroyFramebuffer(reflectionFb);
     destroyFramebuffer(sceneFb);
@@ -1751,10 +2207,14 @@ GLuint fsQuadVbo = 0;
     destroyFramebuffer(bloomFb[0]);
     destroyFramebuffer(bloomFb[1]);
     destroyFramebuffer(ldrFb);
+    destroyFramebuffer(rippleFb);
     destroyShadowMap(shadowMap);
 
     glDeleteTextures(1, &waterNormalTex);
     glDeleteTextures(1, &waterDudvTex);
+    glDeleteTextures(1, &oceanDispTex);
+    glDeleteTextures(1, &oceanNormalTex);
+    glDeleteTextures(1, &sweTex);
 
     if (audioReady) audio.shutdown();
 